@@ -12,6 +12,7 @@
  * This header provides:
  *  - `pow2(n)` : compute 2^n at compile time via bit-shift (returns an unsigned integral).
  *  - `is_power_of_two(x)` : test whether an integer is a (positive) power of two.
+ *  - `log(x)`, `pow(x, a)` : logarithm and real powers, e.g. for entropies of spectra.
  *
  * Both functions are constexpr and noexcept and intended for use in compile-time
  * dimension computations (matrix sizes, state vector lengths) and static assertions.
@@ -99,4 +100,64 @@ namespace ConstexprMath
     {
         return (x < 0.0) ? -x : x;
     };
+
+    /// @brief Natural logarithm ln(2), used for range reduction.
+    static constexpr double Ln2 = 0.693147180559945309417232121458176568;
+
+    /**
+     * @brief Compute the natural logarithm of a floating-point number at compile time.
+     *
+     * @param x  The input value (must be positive).
+     * @return   ln(x), -infinity for 0, or NaN if x is negative.
+     *
+     * @note x is reduced to m · 2^e with m in [1/√2, √2), then
+     *       ln(m) = 2 atanh((m - 1) / (m + 1)) is summed until the terms vanish.
+     */
+    template <std::floating_point FloatType>
+    constexpr FloatType log(FloatType x)
+    {
+        if (x < 0.0 || x != x) return std::numeric_limits<FloatType>::quiet_NaN();
+        if (x == 0.0) return -std::numeric_limits<FloatType>::infinity();
+        if (x == std::numeric_limits<FloatType>::infinity()) return x;
+
+        int Exponent = 0;
+        while (x > 1.4142135623730951) { x *= 0.5; ++Exponent; }
+        while (x < 0.7071067811865476) { x *= 2.0; --Exponent; }
+
+        const FloatType y = (x - 1.0) / (x + 1.0);
+        const FloatType y2 = y * y;
+        FloatType term = y;
+        FloatType sum = 0.0;
+        for (unsigned n = 1; term != 0.0 && n < 200; n += 2)
+        {
+            sum += term / n;
+            term *= y2;
+        }
+        return 2.0 * sum + Exponent * static_cast<FloatType>(Ln2);
+    }
+
+    /**
+     * @brief Compute x^a for a non-negative base at compile time.
+     *
+     * @param x  The base (must be non-negative).
+     * @param a  The exponent.
+     * @return   x^a, with 0^a = 0 for a > 0 and 1 for a == 0.
+     *
+     * @note a · ln(x) is split into k · ln2 + r with |r| <= ln2 / 2, so the Taylor
+     *       series of exp(r) converges in a few terms and 2^k is applied exactly.
+     */
+    template <std::floating_point FloatType>
+    constexpr FloatType pow(FloatType x, FloatType a)
+    {
+        if (a == 0.0) return 1.0;
+        if (x == 0.0) return a > 0.0 ? 0.0 : std::numeric_limits<FloatType>::infinity();
+
+        const FloatType y = a * log(x);
+        const FloatType Ratio = y / static_cast<FloatType>(Ln2);
+        const long long k = static_cast<long long>(Ratio < 0.0 ? Ratio - 0.5 : Ratio + 0.5);
+        FloatType result = exp<24>(y - k * static_cast<FloatType>(Ln2));
+        for (long long i = 0; i < k; ++i) result *= 2.0;
+        for (long long i = 0; i > k; --i) result *= 0.5;
+        return result;
+    }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include <array>
+#include <concepts>
+#include <type_traits>
 #include "constexprmath/constexpr_complex.h"
 #include "constexprmath/constexpr_core_functions.h"
 
@@ -10,7 +12,9 @@ namespace KetCat
 	///
 	/// @details
 	/// - `dimension_t` and `index_t` are the unsigned integral types used for sizes and indices.
-	/// - `cplx_t` is the project's constexpr-capable complex type.
+	/// - `float_t` is the default precision; containers take the precision (`float` or `double`)
+	///   as an optional last parameter, and `accumulator_t` is the type their sums are formed in.
+	/// - `cplx_t` is the project's constexpr-capable complex type (`complex_t<Real>` for other precisions).
 	/// - `state_vector_t<N>` is a std::array of `cplx_t` with N elements representing amplitudes.
 	/// - `matrix_t<R,C>` is a 2D std::array representing a matrix of complex amplitudes.
 	/// - `qbit_list_t<QBitCount>` is a fixed-size array of qubit indices used to specify affected qubits.
@@ -19,15 +23,27 @@ namespace KetCat
 
 	using float_t = double;
 
+	/// @brief Floating-point types amplitudes and matrices can be stored in.
+	template<typename Real>
+	concept precision_type = std::same_as<Real, float> || std::same_as<Real, double>;
+
+	/// @brief Type sums (norms, probabilities) of Real values are accumulated in: never below double.
+	template<precision_type Real>
+	using accumulator_t = std::conditional_t<(sizeof(Real) < sizeof(double)), double, Real>;
+
 	using cplx_t = ConstexprMath::Complex<float_t>;
 
+	/// @brief Complex number of the given precision.
+	template<precision_type Real>
+	using complex_t = ConstexprMath::Complex<Real>;
+
 	/// @brief State vector with compile-time fixed size (array of complex amplitudes).
-	template<dimension_t StateCount>
-	using state_vector_t = std::array<cplx_t, StateCount>;
+	template<dimension_t StateCount, precision_type Real = float_t>
+	using state_vector_t = std::array<complex_t<Real>, StateCount>;
 
 	/// @brief Probability vector with compile-time fixed size (array of doubles).
-	template<dimension_t StateCount>
-	using probability_vector_t = std::array<float_t, StateCount>;
+	template<dimension_t StateCount, precision_type Real = float_t>
+	using probability_vector_t = std::array<Real, StateCount>;
 
 	/// @brief Fixed-size list of qubit indices.
 	/// @tparam QBitCount  Number of qubits in the list.
@@ -36,8 +52,8 @@ namespace KetCat
 
 	/// @brief Square matrix type 
 	/// @tparam Rows  Number of rows and cols
-	template<dimension_t Dim>
-	using matrix_t = std::array<std::array<cplx_t, Dim>, Dim>;
+	template<dimension_t Dim, precision_type Real = float_t>
+	using matrix_t = std::array<std::array<complex_t<Real>, Dim>, Dim>;
 
 	/// @brief Compact storage representation of a tridiagonal matrix for 1D Hamiltonians
 	/// as we have useful information only in the three non-zero diagonals and this way we
@@ -47,8 +63,8 @@ namespace KetCat
 	/// The major index 0 corresponds to the superdiagonal,
 	///           index 1 corresponds to the main diagonal,
 	///       and index 2 corresponds to the subdiagonal.
-	template<dimension_t Dim>
-	using tridiagonal_matrix_t = std::array<std::array<cplx_t, Dim>, 3U>;
+	template<dimension_t Dim, precision_type Real = float_t>
+	using tridiagonal_matrix_t = std::array<std::array<complex_t<Real>, Dim>, 3U>;
 
 	/// @brief Named constant indices for tridiagonal_matrix_t
 	/// for convenience and intuitive usage.
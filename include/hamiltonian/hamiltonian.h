@@ -28,17 +28,18 @@ namespace KetCat
 
 	/// @brief Represents the Hamiltonian operator in 1D discreitized space
 	/// @tparam Dim The dimension of the Hamiltonian matrix
+	/// @tparam Real The precision the matrix is stored in (entries are computed in double)
 	/// @details This class constructs the Hamiltonian matrix for a quantum system
 	/// 		based on the provided constants and potential function.
 	///			Realizes the following equation: 
 	/// ///			H = - (ħ² / 2m·Δx²) · (d²/dx²) + V(x)
-	template<dimension_t Dim>
+	template<dimension_t Dim, precision_type Real = float_t>
 	class Hamiltonian
 	{
-		tridiagonal_matrix_t<Dim> m_hamiltonianMatrix;
+		tridiagonal_matrix_t<Dim, Real> m_hamiltonianMatrix;
 
 	public:
-		constexpr tridiagonal_matrix_t<Dim> getMatrix() const noexcept
+		constexpr tridiagonal_matrix_t<Dim, Real> getMatrix() const noexcept
 		{
 			return m_hamiltonianMatrix;
 		}
@@ -63,19 +64,19 @@ namespace KetCat
 				// Superdiagonal: represents kinetic coupling to the next site (i + 1)
 				if (i + 1 < Dim)
 				{
-					m_hamiltonianMatrix[SuperDiagonal][i] = cplx_t::fromReal(-Alpha);
+					m_hamiltonianMatrix[SuperDiagonal][i] = complex_t<Real>::fromReal(static_cast<Real>(-Alpha));
 				}
 
 				// Main diagonal elements: Kinetic + Potential energy
 				// Kinetic part: 2α (from the central term of the second-order finite difference)
 				// Potential part: V(position)
 				// Total: 2α + V(position)
-				m_hamiltonianMatrix[MainDiagonal][i] = cplx_t::fromReal(2.0 * Alpha + potential(Position));
+				m_hamiltonianMatrix[MainDiagonal][i] = complex_t<Real>::fromReal(static_cast<Real>(2.0 * Alpha + potential(Position)));
 
 				// Subdiagonal: represents kinetic coupling to the previous site (i - 1)
 				if (i > 0)
 				{
-					m_hamiltonianMatrix[SubDiagonal][i] = cplx_t::fromReal(-Alpha);
+					m_hamiltonianMatrix[SubDiagonal][i] = complex_t<Real>::fromReal(static_cast<Real>(-Alpha));
 				}
 			}
 		}
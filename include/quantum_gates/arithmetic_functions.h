@@ -0,0 +1,61 @@
+#pragma once
+#include "core_types.h"
+#include "constexprmath/constexpr_core_functions.h"
+
+
+/// @file
+/// @brief Reversible classical functions on basis indices, for `PermutationGate`.
+///
+/**
+ * @details
+ * Each function object maps the value x of a qubit register (bit q of x is the q-th qubit
+ * the gate is bound to) to f(x). They are structural types, so they can be passed as
+ * template arguments: `PermutationGate<5, Gates::ModularMultiplication<2, 21>{}, 1>()`.
+ * `PermutationGate` checks at compile time that the function is a bijection of the
+ * register's basis states.
+ */
+namespace KetCat::QCC::Gates
+{
+    /// @brief |x> -> |a·x mod N> for x < N, identity on the unused values x >= N.
+    /// @note  A bijection only if gcd(a, N) = 1.
+    template<dimension_t Multiplier, dimension_t Modulus>
+    struct ModularMultiplication
+    {
+        constexpr dimension_t operator()(dimension_t x) const noexcept
+        {
+            return (x < Modulus) ? (x * Multiplier) % Modulus : x;
+        }
+    };
+
+    /// @brief |x> -> |x + a mod N> for x < N, identity on the unused values x >= N.
+    template<dimension_t Addend, dimension_t Modulus>
+    struct ModularAddition
+    {
+        constexpr dimension_t operator()(dimension_t x) const noexcept
+        {
+            return (x < Modulus) ? (x + Addend) % Modulus : x;
+        }
+    };
+
+    /// @brief |x> -> |x + a mod 2^QBitCount>, the adder of a constant on a QBitCount-qubit register.
+    template<dimension_t QBitCount, dimension_t Addend>
+    struct Addition
+    {
+        constexpr dimension_t operator()(dimension_t x) const noexcept
+        {
+            return (x + Addend) & (ConstexprMath::pow2(QBitCount) - 1);
+        }
+    };
+
+    /// @brief |x, b> -> |x, b ⊕ (x < c)> on QBitCount + 1 qubits: the value x on the low
+    ///        QBitCount qubits, the flag b on the last one.
+    template<dimension_t QBitCount, dimension_t Bound>
+    struct LessThan
+    {
+        constexpr dimension_t operator()(dimension_t x) const noexcept
+        {
+            constexpr dimension_t Flag = ConstexprMath::pow2(QBitCount);
+            return ((x & (Flag - 1)) < Bound) ? (x ^ Flag) : x;
+        }
+    };
+}
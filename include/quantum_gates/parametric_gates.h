@@ -0,0 +1,172 @@
+#pragma once
+#include "core_types.h"
+#include "constexprmath/constexpr_trigon.h"
+#include "common_gates.h"
+
+
+/// @file
+/// @brief Gate kinds whose matrices depend on runtime angles.
+///
+/**
+ * @details
+ * Unlike the constant matrices in common_gates.h, these kinds describe a family of gates:
+ * each one exposes its qubit and parameter count and builds its matrix in closed form from
+ * the angles (cos/sin evaluated once per gate). Diagonal kinds are flagged so the solver can
+ * apply them as a per-amplitude phase instead of a dense matrix-vector product.
+ * Every kind also provides `derivative(angles, p)`, the matrix ∂U/∂angles[p], which the
+ * adjoint differentiation in solvers/adjoint_gradient.h applies to obtain gradients.
+ * Use them through `ParametricGate<Kind>(angles...).toBits(...)`.
+ */
+namespace KetCat::QCC::Gates
+{
+    namespace Detail
+    {
+        /// @brief e^{iφ} from the constexpr trigonometric helpers
+        constexpr cplx_t expI(float_t phi) noexcept
+        {
+            return cplx_t(ConstexprMath::cos(phi), ConstexprMath::sin(phi));
+        }
+    }
+
+    // @brief Rotation around the X axis: R_x(θ) = cos(θ/2) I - i sin(θ/2) X
+    struct RX
+    {
+        static constexpr dimension_t QBitCount = 1;
+        static constexpr dimension_t ParameterCount = 1;
+        static constexpr bool IsDiagonal = false;
+
+        static constexpr matrix_t<2> matrix(const std::array<float_t, ParameterCount>& angles) noexcept
+        {
+            const float_t c = ConstexprMath::cos(angles[0] / 2.0);
+            const float_t s = ConstexprMath::sin(angles[0] / 2.0);
+            return { {
+                { cplx_t(c, 0.0), cplx_t(0.0, -s) },
+                { cplx_t(0.0, -s), cplx_t(c, 0.0) }
+            } };
+        }
+
+        static constexpr matrix_t<2> derivative(const std::array<float_t, ParameterCount>& angles, dimension_t) noexcept
+        {
+            const float_t c = ConstexprMath::cos(angles[0] / 2.0) / 2.0;
+            const float_t s = ConstexprMath::sin(angles[0] / 2.0) / 2.0;
+            return { {
+                { cplx_t(-s, 0.0), cplx_t(0.0, -c) },
+                { cplx_t(0.0, -c), cplx_t(-s, 0.0) }
+            } };
+        }
+    };
+
+    // @brief Rotation around the Y axis: R_y(θ) = cos(θ/2) I - i sin(θ/2) Y
+    struct RY
+    {
+        static constexpr dimension_t QBitCount = 1;
+        static constexpr dimension_t ParameterCount = 1;
+        static constexpr bool IsDiagonal = false;
+
+        static constexpr matrix_t<2> matrix(const std::array<float_t, ParameterCount>& angles) noexcept
+        {
+            return RotationY(angles[0]);
+        }
+
+        static constexpr matrix_t<2> derivative(const std::array<float_t, ParameterCount>& angles, dimension_t) noexcept
+        {
+            // d/dθ R_y(θ) = R_y(θ + π) / 2
+            matrix_t<2> Result = RotationY(angles[0] + ConstexprMath::Pi);
+            for (auto& Row : Result)
+                for (cplx_t& Element : Row)
+                    Element = Element * 0.5;
+            return Result;
+        }
+    };
+
+    // @brief Rotation around the Z axis: R_z(θ) = diag(e^{-iθ/2}, e^{iθ/2})
+    struct RZ
+    {
+        static constexpr dimension_t QBitCount = 1;
+        static constexpr dimension_t ParameterCount = 1;
+        static constexpr bool IsDiagonal = true;
+
+        static constexpr matrix_t<2> matrix(const std::array<float_t, ParameterCount>& angles) noexcept
+        {
+            return { {
+                { Detail::expI(-angles[0] / 2.0), cplx_t::zero() },
+                { cplx_t::zero(), Detail::expI(angles[0] / 2.0) }
+            } };
+        }
+
+        static constexpr matrix_t<2> derivative(const std::array<float_t, ParameterCount>& angles, dimension_t) noexcept
+        {
+            return { {
+                { cplx_t(0.0, -0.5) * Detail::expI(-angles[0] / 2.0), cplx_t::zero() },
+                { cplx_t::zero(), cplx_t(0.0, 0.5) * Detail::expI(angles[0] / 2.0) }
+            } };
+        }
+    };
+
+    // @brief General single-qubit rotation
+    //        U3(θ, φ, λ) = [[cos(θ/2), -e^{iλ} sin(θ/2)], [e^{iφ} sin(θ/2), e^{i(φ+λ)} cos(θ/2)]]
+    struct U3
+    {
+        static constexpr dimension_t QBitCount = 1;
+        static constexpr dimension_t ParameterCount = 3;
+        static constexpr bool IsDiagonal = false;
+
+        static constexpr matrix_t<2> matrix(const std::array<float_t, ParameterCount>& angles) noexcept
+        {
+            const float_t c = ConstexprMath::cos(angles[0] / 2.0);
+            const float_t s = ConstexprMath::sin(angles[0] / 2.0);
+            return { {
+                { cplx_t(c, 0.0), -Detail::expI(angles[2]) * s },
+                { Detail::expI(angles[1]) * s, Detail::expI(angles[1] + angles[2]) * c }
+            } };
+        }
+
+        static constexpr matrix_t<2> derivative(const std::array<float_t, ParameterCount>& angles, dimension_t parameter) noexcept
+        {
+            const float_t c = ConstexprMath::cos(angles[0] / 2.0);
+            const float_t s = ConstexprMath::sin(angles[0] / 2.0);
+            const cplx_t i = cplx_t::plus_i();
+
+            switch (parameter)
+            {
+            case 0: // ∂/∂θ
+                return { {
+                    { cplx_t(-s / 2.0, 0.0), -Detail::expI(angles[2]) * (c / 2.0) },
+                    { Detail::expI(angles[1]) * (c / 2.0), -Detail::expI(angles[1] + angles[2]) * (s / 2.0) }
+                } };
+            case 1: // ∂/∂φ
+                return { {
+                    { cplx_t::zero(), cplx_t::zero() },
+                    { i * Detail::expI(angles[1]) * s, i * Detail::expI(angles[1] + angles[2]) * c }
+                } };
+            default: // ∂/∂λ
+                return { {
+                    { cplx_t::zero(), -i * Detail::expI(angles[2]) * s },
+                    { cplx_t::zero(), i * Detail::expI(angles[1] + angles[2]) * c }
+                } };
+            }
+        }
+    };
+
+    // @brief Controlled phase: CPhase(φ) = diag(1, 1, 1, e^{iφ}), symmetric in its two qubits
+    struct CPhase
+    {
+        static constexpr dimension_t QBitCount = 2;
+        static constexpr dimension_t ParameterCount = 1;
+        static constexpr bool IsDiagonal = true;
+
+        static constexpr matrix_t<4> matrix(const std::array<float_t, ParameterCount>& angles) noexcept
+        {
+            matrix_t<4> Result = identityMatrix<2U>();
+            Result[3][3] = Detail::expI(angles[0]);
+            return Result;
+        }
+
+        static constexpr matrix_t<4> derivative(const std::array<float_t, ParameterCount>& angles, dimension_t) noexcept
+        {
+            matrix_t<4> Result{};
+            Result[3][3] = cplx_t::plus_i() * Detail::expI(angles[0]);
+            return Result;
+        }
+    };
+}
@@ -0,0 +1,491 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <string_view>
+
+#include "core_types.h"
+#include "circuit_record.h"
+#include "gate_scheduler.h"
+#include "layer_scheduler.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Cost model choosing how a circuit is executed.
+    ///
+    /**
+     * @details
+     * A circuit can be run in several ways, and which one is cheapest depends on the circuit:
+     *  - `BasisStateTracking`: if every gate maps basis states to basis states (X, CX,
+     *    Toffoli, SWAP, phases), |0...0> stays a single basis state; it is tracked with one
+     *    amplitude and the state vector is only written once at the end;
+     *  - `CacheBlocked`: the gates are applied one by one through the cache-blocked scheduler
+     *    (see gate_scheduler.h);
+     *  - `Layered`: gates on disjoint qubits are first packed into layers, each applied in one
+     *    fused sweep (see layer_scheduler.h); this saves sweeps when layers reach outside the
+     *    cache tile, but pays a gather / scatter per block.
+     *
+     * The model only needs the width, support and matrix class of every gate, so it works on
+     * a `CircuitSummary` (see circuit_record.h) rather than on gate records: `withGates`
+     * summarises its pack in a few words per gate and never copies a matrix unless the
+     * layered backend, whose layers are views into records, is chosen.
+     *
+     * `selectBackend` layers the circuit once; `profileCircuit` inspects the gates (widths,
+     * diagonal and phase-permutation gates, layers), `estimateBackends` derives a runtime and
+     * a peak memory estimate for every backend from the same layering, and `selectBackend`
+     * picks the cheapest applicable one. The resulting
+     * `BackendDecision` keeps the profile, all estimates and the reason for the choice, so
+     * the selection can be inspected (see `QuantumCircuit::inspectBackend`).
+     *
+     * Runtimes are counted in complex multiply-adds; streaming the state through memory once
+     * costs `SweepCostPerAmplitude` per amplitude. Everything is constexpr: for a constexpr
+     * circuit the decision is taken at compile time.
+     */
+
+    /// @brief Cost of streaming one amplitude through main memory, relative to one complex multiply-add.
+    constexpr float_t SweepCostPerAmplitude = 4.0;
+
+    /// @brief Cost of gathering and scattering one amplitude of an in-cache block, relative to one multiply-add.
+    constexpr float_t GatherCostPerAmplitude = 1.0;
+
+    /// @brief Bytes per stored amplitude.
+    constexpr dimension_t AmplitudeBytes = sizeof(cplx_t);
+
+    /// @brief The ways a recorded circuit can be executed.
+    enum class SimulationBackend
+    {
+        BasisStateTracking,
+        CacheBlocked,
+        Layered
+    };
+
+    /// @brief Number of backends the cost model compares.
+    constexpr dimension_t SimulationBackendCount = 3;
+
+    /// @brief Readable name of a backend.
+    constexpr std::string_view backendName(SimulationBackend backend) noexcept
+    {
+        switch (backend)
+        {
+        case SimulationBackend::BasisStateTracking:
+            return "basis-state tracking";
+        case SimulationBackend::CacheBlocked:
+            return "cache-blocked";
+        case SimulationBackend::Layered:
+            return "layered";
+        }
+        return {};
+    }
+
+    /// @brief What the cost model knows about a circuit.
+    struct CircuitProfile
+    {
+        dimension_t QBitCount = 0;
+        dimension_t GateCount = 0;
+
+        /// Width of the widest gate.
+        dimension_t MaxGateQBitCount = 0;
+
+        dimension_t DiagonalGateCount = 0;
+        dimension_t PhasePermutationGateCount = 0;
+
+        /// Number of Clifford gates. The check costs k·8^k per k-qubit gate and no backend
+        /// depends on it, so it is only counted by `QuantumCircuit::inspectBackend`.
+        dimension_t CliffordGateCount = 0;
+
+        /// Number of layers of disjoint gates (see buildLayers).
+        dimension_t LayerCount = 0;
+
+        /// @brief True if every gate maps basis states to basis states.
+        constexpr bool isPhasePermutation() const noexcept
+        {
+            return PhasePermutationGateCount == GateCount;
+        }
+
+        /// @brief True if every gate is a Clifford gate (the circuit is a stabilizer circuit).
+        constexpr bool isClifford() const noexcept
+        {
+            return CliffordGateCount == GateCount;
+        }
+    };
+
+    /// @brief Estimated cost of one backend on a circuit.
+    struct BackendEstimate
+    {
+        SimulationBackend Backend = SimulationBackend::CacheBlocked;
+
+        /// False if the backend cannot execute the circuit.
+        bool Applicable = false;
+
+        /// Estimated runtime, in complex multiply-adds.
+        float_t Runtime = 0.0;
+
+        /// Number of passes over the full state vector.
+        dimension_t SweepCount = 0;
+
+        /// Estimated peak memory, in bytes (the final state vector included).
+        dimension_t MemoryBytes = 0;
+    };
+
+    /// @brief The backend chosen for a circuit, and why.
+    struct BackendDecision
+    {
+        CircuitProfile Profile{};
+
+        /// Estimates of all backends, indexed by `SimulationBackend`.
+        std::array<BackendEstimate, SimulationBackendCount> Estimates{};
+
+        SimulationBackend Backend = SimulationBackend::CacheBlocked;
+
+        /// Why `Backend` was chosen.
+        std::string_view Reason;
+
+        /// @brief Estimate of the given backend.
+        constexpr const BackendEstimate& estimate(SimulationBackend backend) const noexcept
+        {
+            return Estimates[static_cast<dimension_t>(backend)];
+        }
+
+        /// @brief Estimate of the chosen backend.
+        constexpr const BackendEstimate& chosen() const noexcept
+        {
+            return estimate(Backend);
+        }
+    };
+
+    namespace Detail
+    {
+        /**
+         * @brief     True if the dim × dim matrix is a Pauli string up to a phase in {±1, ±i}.
+         *
+         * A Pauli string X^x Z^z maps column j to row j ^ x with the sign (-1)^popcount(z & j),
+         * so the row offset x must be the same for all columns and the signs must be a
+         * character of j, fixed by the single-bit columns.
+         */
+        template<dimension_t MaxDim>
+        constexpr bool isPauliString(const matrix_t<MaxDim>& m, dimension_t dim) noexcept
+        {
+            dimension_t FlipMask = 0;
+            while (FlipMask < dim && isNegligible(m[FlipMask][0]))
+                ++FlipMask;
+            if (FlipMask == dim)
+                return false;
+
+            const cplx_t Phase = m[FlipMask][0];
+            const bool IsPauliPhase =
+                (isNegligible(Phase - cplx_t::fromReal(1.0)) || isNegligible(Phase + cplx_t::fromReal(1.0)) ||
+                 isNegligible(Phase - cplx_t::plus_i()) || isNegligible(Phase + cplx_t::plus_i()));
+            if (!IsPauliPhase)
+                return false;
+
+            // Sign of the single-bit columns gives the Z part
+            dimension_t PhaseMask = 0;
+            for (dimension_t Bit = 1; Bit < dim; Bit <<= 1)
+            {
+                if (isNegligible(m[Bit ^ FlipMask][Bit] + Phase))
+                    PhaseMask |= Bit;
+            }
+
+            for (dimension_t j = 0; j < dim; ++j)
+                for (dimension_t i = 0; i < dim; ++i)
+                {
+                    const bool Negative = (std::popcount(PhaseMask & j) & 1) != 0;
+                    const cplx_t Expected = (i == (j ^ FlipMask)) ? (Negative ? -Phase : Phase) : cplx_t::zero();
+                    if (!isNegligible(m[i][j] - Expected))
+                        return false;
+                }
+            return true;
+        }
+    }
+
+    /**
+     * @brief     True if a recorded gate is a Clifford gate.
+     *
+     * A unitary U is Clifford if it maps Pauli strings to Pauli strings under conjugation;
+     * checking U X_q U† and U Z_q U† for every local qubit q suffices, as these generate
+     * all Pauli strings. Global phases do not matter.
+     */
+    template<dimension_t MaxQBitCount>
+    constexpr bool isCliffordGate(const GateRecord<MaxQBitCount>& gate) noexcept
+    {
+        constexpr dimension_t MaxDim = GateRecord<MaxQBitCount>::MaxDim;
+        const dimension_t Dim = gate.dim();
+
+        for (dimension_t q = 0; q < gate.QBitCount; ++q)
+        {
+            const dimension_t Bit = dimension_t(1) << q;
+            for (const bool IsX : { true, false })
+            {
+                // U P, with P = X_q (column permutation) or Z_q (column signs)
+                matrix_t<MaxDim> UP{};
+                for (dimension_t i = 0; i < Dim; ++i)
+                    for (dimension_t j = 0; j < Dim; ++j)
+                    {
+                        if (IsX)
+                            UP[i][j] = gate.Matrix[i][j ^ Bit];
+                        else
+                            UP[i][j] = (j & Bit) ? -gate.Matrix[i][j] : gate.Matrix[i][j];
+                    }
+
+                // U P U†
+                matrix_t<MaxDim> Conjugated{};
+                for (dimension_t i = 0; i < Dim; ++i)
+                    for (dimension_t k = 0; k < Dim; ++k)
+                    {
+                        cplx_t Sum{};
+                        for (dimension_t j = 0; j < Dim; ++j)
+                            Sum += UP[i][j] * gate.Matrix[k][j].conj();
+                        Conjugated[i][k] = Sum;
+                    }
+
+                if (!Detail::isPauliString(Conjugated, Dim))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Number of Clifford gates of a recorded circuit (see `isCliffordGate`).
+    template<dimension_t MaxQBitCount, dimension_t Capacity>
+    constexpr dimension_t countCliffordGates(const CircuitRecord<MaxQBitCount, Capacity>& circuit) noexcept
+    {
+        dimension_t Count = 0;
+        for (dimension_t g = 0; g < circuit.GateCount; ++g)
+            Count += isCliffordGate(circuit.Gates[g]) ? 1 : 0;
+        return Count;
+    }
+
+    /// @brief Profile a circuit running on QBitCount qubits, given its layering.
+    template<dimension_t QBitCount, dimension_t Capacity>
+    constexpr CircuitProfile profileCircuit(const CircuitSummary<Capacity>& circuit,
+        const LayeredCircuit<Capacity>& layered) noexcept
+    {
+        CircuitProfile Profile{};
+        Profile.QBitCount = QBitCount;
+        Profile.GateCount = circuit.GateCount;
+        for (dimension_t g = 0; g < circuit.GateCount; ++g)
+        {
+            const GateSummary& Gate = circuit.Gates[g];
+            Profile.MaxGateQBitCount = std::max(Profile.MaxGateQBitCount, Gate.QBitCount);
+            Profile.DiagonalGateCount += Gate.IsDiagonal ? 1 : 0;
+            Profile.PhasePermutationGateCount += Gate.IsPhasePermutation ? 1 : 0;
+        }
+        Profile.LayerCount = layered.LayerCount;
+        return Profile;
+    }
+
+    /// @brief Estimate the runtime and memory of every backend on a circuit, given its layering.
+    template<dimension_t QBitCount, dimension_t TileQBitCount = CacheTileQBitCount, dimension_t Capacity>
+    constexpr std::array<BackendEstimate, SimulationBackendCount> estimateBackends(
+        const CircuitSummary<Capacity>& circuit, const LayeredCircuit<Capacity>& layered) noexcept
+    {
+        constexpr dimension_t StateCount = ConstexprMath::pow2(QBitCount);
+        constexpr float_t Amplitudes = static_cast<float_t>(StateCount);
+        constexpr dimension_t StateBytes = StateCount * AmplitudeBytes;
+
+        // Arithmetic shared by both sweeping backends: a diagonal gate scales every amplitude once,
+        // a dense k-qubit gate costs 2^k multiply-adds per amplitude
+        float_t Arithmetic = 0.0;
+        for (dimension_t g = 0; g < circuit.GateCount; ++g)
+        {
+            const GateSummary& Gate = circuit.Gates[g];
+            Arithmetic += Amplitudes * static_cast<float_t>(Gate.IsDiagonal ? 1 : Gate.dim());
+        }
+
+        std::array<BackendEstimate, SimulationBackendCount> Estimates{};
+
+        // One amplitude walks through the circuit; the state vector is only written at the end
+        BackendEstimate& Tracking = Estimates[static_cast<dimension_t>(SimulationBackend::BasisStateTracking)];
+        Tracking.Backend = SimulationBackend::BasisStateTracking;
+        Tracking.Applicable = true;
+        for (dimension_t g = 0; g < circuit.GateCount; ++g)
+        {
+            Tracking.Applicable = Tracking.Applicable && circuit.Gates[g].IsPhasePermutation;
+            Tracking.Runtime += static_cast<float_t>(circuit.Gates[g].dim());
+        }
+        Tracking.Runtime += Amplitudes * SweepCostPerAmplitude;
+        Tracking.SweepCount = 1;
+        Tracking.MemoryBytes = StateBytes;
+
+        // Gates one by one; a layout change permutes the state in place
+        std::array<dimension_t, Capacity> GateMasks{};
+        for (dimension_t g = 0; g < circuit.GateCount; ++g)
+            GateMasks[g] = circuit.Gates[g].getAffectedMask();
+        const CacheBlockSchedule<QBitCount, Capacity> GateSchedule =
+            buildCacheBlockSchedule<TileQBitCount, StateCount>(GateMasks, 0, circuit.GateCount);
+
+        BackendEstimate& Blocked = Estimates[static_cast<dimension_t>(SimulationBackend::CacheBlocked)];
+        Blocked.Backend = SimulationBackend::CacheBlocked;
+        Blocked.Applicable = true;
+        Blocked.SweepCount = GateSchedule.sweepCount();
+        Blocked.Runtime = Arithmetic + static_cast<float_t>(Blocked.SweepCount) * Amplitudes * SweepCostPerAmplitude;
+        Blocked.MemoryBytes = StateBytes;
+
+        // Layers as gates; every layer of several gates gathers and scatters each block once
+        std::array<dimension_t, Capacity> LayerMasks{};
+        dimension_t FusedLayerCount = 0;
+        for (dimension_t l = 0; l < layered.LayerCount; ++l)
+        {
+            for (dimension_t g = layered.LayerStart[l]; g < layered.LayerStart[l + 1]; ++g)
+                LayerMasks[l] |= circuit.Gates[layered.GateOrder[g]].getAffectedMask();
+            FusedLayerCount += (layered.LayerStart[l + 1] - layered.LayerStart[l] > 1) ? 1 : 0;
+        }
+        const CacheBlockSchedule<QBitCount, Capacity> LayerSchedule =
+            buildCacheBlockSchedule<TileQBitCount, StateCount>(LayerMasks, 0, layered.LayerCount);
+
+        BackendEstimate& Layers = Estimates[static_cast<dimension_t>(SimulationBackend::Layered)];
+        Layers.Backend = SimulationBackend::Layered;
+        Layers.Applicable = true;
+        Layers.SweepCount = LayerSchedule.sweepCount();
+        Layers.Runtime = Arithmetic
+            + static_cast<float_t>(Layers.SweepCount) * Amplitudes * SweepCostPerAmplitude
+            + static_cast<float_t>(2 * FusedLayerCount) * Amplitudes * GatherCostPerAmplitude;
+        Layers.MemoryBytes = StateBytes
+            + ConstexprMath::pow2(LayerMaxQBitCount) * (AmplitudeBytes + sizeof(dimension_t));
+
+        return Estimates;
+    }
+
+    /**
+     * @brief     Choose the cheapest applicable backend for a circuit.
+     *
+     * @return    The decision, with the profile and the estimates it is based on.
+     *
+     * Ties go to the simpler backend: basis-state tracking, then cache-blocked execution.
+     */
+    template<dimension_t QBitCount, dimension_t TileQBitCount = CacheTileQBitCount, dimension_t Capacity>
+    constexpr BackendDecision selectBackend(const CircuitSummary<Capacity>& circuit) noexcept
+    {
+        const LayeredCircuit<Capacity> Layered = buildLayers(circuit.Gates, 0, circuit.GateCount);
+
+        BackendDecision Decision{};
+        Decision.Profile = profileCircuit<QBitCount>(circuit, Layered);
+        Decision.Estimates = estimateBackends<QBitCount, TileQBitCount>(circuit, Layered);
+
+        const BackendEstimate* Best = nullptr;
+        for (const BackendEstimate& Estimate : Decision.Estimates)
+        {
+            if (Estimate.Applicable && (Best == nullptr || Estimate.Runtime < Best->Runtime))
+                Best = &Estimate;
+        }
+        Decision.Backend = Best->Backend;
+
+        switch (Decision.Backend)
+        {
+        case SimulationBackend::BasisStateTracking:
+            Decision.Reason = "every gate maps basis states to basis states: one amplitude is tracked instead of sweeping the state";
+            break;
+        case SimulationBackend::Layered:
+            Decision.Reason = "packing gates on disjoint qubits into layers saves more sweeps than the gathering costs";
+            break;
+        case SimulationBackend::CacheBlocked:
+            Decision.Reason = Decision.estimate(SimulationBackend::Layered).SweepCount < Decision.chosen().SweepCount
+                ? "layering saves sweeps, but not enough to pay for gathering the layers"
+                : "layering saves no sweep over the state: gates run one by one within cache tiles";
+            break;
+        }
+        return Decision;
+    }
+
+    /// @brief Choose the cheapest applicable backend for a recorded circuit.
+    template<dimension_t QBitCount, dimension_t TileQBitCount = CacheTileQBitCount, dimension_t MaxQBitCount, dimension_t Capacity>
+    constexpr BackendDecision selectBackend(const CircuitRecord<MaxQBitCount, Capacity>& circuit) noexcept
+    {
+        return selectBackend<QBitCount, TileQBitCount>(CircuitSummary<Capacity>::fromRecord(circuit));
+    }
+
+    /// @brief Decision reported for gate packs that cannot be recorded and always run cache-blocked.
+    constexpr BackendDecision unrecordedCircuitDecision() noexcept
+    {
+        BackendDecision Decision{};
+        Decision.Backend = SimulationBackend::CacheBlocked;
+        Decision.Reason = "some gates do not expose their matrix: the pack runs as given, cache-blocked";
+        return Decision;
+    }
+
+    namespace Detail
+    {
+        /// @brief Index of the only non-negligible amplitude of a state, or StateCount if it is not a basis state.
+        template<dimension_t StateCount>
+        constexpr dimension_t basisStateIndex(const StateVector<StateCount>& state) noexcept
+        {
+            dimension_t Index = StateCount;
+            for (dimension_t i = 0; i < StateCount; ++i)
+            {
+                if (!isNegligible(state.m_StateVector[i]))
+                {
+                    if (Index != StateCount)
+                        return StateCount;
+                    Index = i;
+                }
+            }
+            return Index;
+        }
+    }
+
+    /**
+     * @brief     Track a basis state through a pack of phase-permutation gates.
+     *
+     * @param state  The state vector, updated in place; it must hold a single basis state.
+     * @param gates  The gates, in order; gates that do not expose their matrix (such as
+     *               barriers) are skipped.
+     * @return       False, leaving the state untouched, if the state is not a single basis state.
+     *
+     * Applies the gate matrices directly, without recording the pack.
+     */
+    template<dimension_t StateCount, typename... Gates>
+    constexpr bool trackBasisState(StateVector<StateCount>& state, const Gates&... gates) noexcept
+    {
+        dimension_t Index = Detail::basisStateIndex(state);
+        if (Index == StateCount)
+            return false;
+
+        cplx_t Amplitude = state.m_StateVector[Index];
+        state.m_StateVector[Index] = cplx_t::zero();
+        ([&]
+            {
+                if constexpr (RecordableGate<Gates>)
+                    applyToBasisState(gates.getGateMatrix(), gates.getAffectedBits(), recorded_qbit_count_v<Gates>, Index, Amplitude);
+            }(), ...);
+        state.m_StateVector[Index] = Amplitude;
+        return true;
+    }
+
+    /**
+     * @brief     Execute a recorded circuit on a state with the given backend.
+     *
+     * @param state    The state vector, updated in place.
+     * @param circuit  The recorded circuit.
+     * @param backend  The backend, usually `selectBackend(circuit).Backend`.
+     *
+     * Basis-state tracking needs a basis state on entry; a superposition is run layered instead.
+     */
+    template<dimension_t TileQBitCount = CacheTileQBitCount, dimension_t StateCount, dimension_t MaxQBitCount, dimension_t Capacity>
+    constexpr void executeWithBackend(StateVector<StateCount>& state,
+        const CircuitRecord<MaxQBitCount, Capacity>& circuit, SimulationBackend backend)
+    {
+        switch (backend)
+        {
+        case SimulationBackend::BasisStateTracking:
+        {
+            dimension_t Index = Detail::basisStateIndex(state);
+            if (Index == StateCount)
+                return executeLayered<TileQBitCount>(state, circuit, 0, circuit.GateCount);
+
+            cplx_t Amplitude = state.m_StateVector[Index];
+            state.m_StateVector[Index] = cplx_t::zero();
+            for (dimension_t g = 0; g < circuit.GateCount; ++g)
+                circuit.Gates[g].applyToBasisState(Index, Amplitude);
+            state.m_StateVector[Index] = Amplitude;
+            break;
+        }
+        case SimulationBackend::Layered:
+            executeLayered<TileQBitCount>(state, circuit, 0, circuit.GateCount);
+            break;
+        case SimulationBackend::CacheBlocked:
+            executeCacheBlockedSequence<TileQBitCount>(state, circuit.Gates, 0, circuit.GateCount);
+            break;
+        }
+    }
+}
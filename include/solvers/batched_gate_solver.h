@@ -0,0 +1,225 @@
+#pragma once
+#include <concepts>
+
+#include "core_types.h"
+#include "quantum_gate_solver.h"
+#include "wavefunction/batched_state_vector.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Gate kernels for batch-interleaved state vectors and gates swept over a parameter.
+	///
+	/**
+	 * @details
+	 * Gate matrices are template arguments of `QuantumGate`, so a parameter such as the angle
+	 * of `Gates::RotationY` has to be a constant expression. Sweeping it means one circuit
+	 * instantiation per value. This header lets one circuit structure run over a whole batch
+	 * of parameter sets at once instead:
+	 *  - `applyBatchedGateMatrix` : apply the same matrix to every member of a batch.
+	 *  - `applyBatchedGateMatrices` : apply a different matrix to every member of a batch.
+	 *  - `SweptGate` / `SweptGateOp` : a gate whose matrix is generated from one parameter of
+	 *    the current parameter set, e.g. `SweptGate<1, Gates::RotationY>(0).toBits(2)`.
+	 *
+	 * Both kernels keep the batch index innermost, so every matrix element is loaded once
+	 * and applied to BatchSize contiguous amplitudes. The loops are plain constexpr code
+	 * and are left to the compiler's auto-vectorizer.
+	 */
+
+	/// @brief Per-batch gate matrices stored element-major: [row][col][batch].
+	template<dimension_t Dim, dimension_t BatchSize>
+	using batched_matrix_t = std::array<std::array<state_vector_t<BatchSize>, Dim>, Dim>;
+
+	/// @brief A batch of parameter sets, one row of ParameterCount values per batch member.
+	template<dimension_t BatchSize, dimension_t ParameterCount>
+	using parameter_sets_t = std::array<std::array<float_t, ParameterCount>, BatchSize>;
+
+	/**
+	 * @brief     Apply the same k-qubit matrix in place to every member of a batch.
+	 *
+	 * @tparam QBitCount   Number of qubits the matrix acts on.
+	 * @param state        The batch of global state vectors, updated in place.
+	 * @param U            The 2^QBitCount × 2^QBitCount matrix to apply.
+	 * @param affectedBits The global qubit indices; local bit q maps to affectedBits[q].
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount, dimension_t BatchSize>
+	constexpr void applyBatchedGateMatrix(BatchedStateVector<StateCount, BatchSize>& state,
+		const matrix_t<ConstexprMath::pow2(QBitCount)>& U,
+		const qbit_list_t<QBitCount>& affectedBits) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		const GateBlockIndexer<QBitCount> Indexer(affectedBits);
+
+		for (dimension_t block = 0; block < StateCount / Dim; ++block)
+		{
+			const dimension_t Base = Indexer.base(block);
+
+			// Gather the local rows of the batch
+			std::array<state_vector_t<BatchSize>, Dim> LocalIn{};
+			for (dimension_t j = 0; j < Dim; ++j)
+			{
+				LocalIn[j] = state.m_Amplitudes[Base + Indexer.Offsets[j]];
+			}
+
+			// LocalOut[i][b] = sum_j U[i][j] * LocalIn[j][b], batch index innermost
+			for (dimension_t i = 0; i < Dim; ++i)
+			{
+				state_vector_t<BatchSize> Row{};
+				for (dimension_t j = 0; j < Dim; ++j)
+				{
+					const cplx_t Uij = U[i][j];
+					for (dimension_t b = 0; b < BatchSize; ++b)
+					{
+						Row[b] += Uij * LocalIn[j][b];
+					}
+				}
+				state.m_Amplitudes[Base + Indexer.Offsets[i]] = Row;
+			}
+		}
+	}
+
+	/**
+	 * @brief     Apply a different k-qubit matrix in place to every member of a batch.
+	 *
+	 * @tparam QBitCount   Number of qubits the matrices act on.
+	 * @param state        The batch of global state vectors, updated in place.
+	 * @param U            Per-batch matrices, U[i][j][b] being element (i, j) of member b.
+	 * @param affectedBits The global qubit indices; local bit q maps to affectedBits[q].
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount, dimension_t BatchSize>
+	constexpr void applyBatchedGateMatrices(BatchedStateVector<StateCount, BatchSize>& state,
+		const batched_matrix_t<ConstexprMath::pow2(QBitCount), BatchSize>& U,
+		const qbit_list_t<QBitCount>& affectedBits) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		const GateBlockIndexer<QBitCount> Indexer(affectedBits);
+
+		for (dimension_t block = 0; block < StateCount / Dim; ++block)
+		{
+			const dimension_t Base = Indexer.base(block);
+
+			// Gather the local rows of the batch
+			std::array<state_vector_t<BatchSize>, Dim> LocalIn{};
+			for (dimension_t j = 0; j < Dim; ++j)
+			{
+				LocalIn[j] = state.m_Amplitudes[Base + Indexer.Offsets[j]];
+			}
+
+			// LocalOut[i][b] = sum_j U[i][j][b] * LocalIn[j][b], batch index innermost
+			for (dimension_t i = 0; i < Dim; ++i)
+			{
+				state_vector_t<BatchSize> Row{};
+				for (dimension_t j = 0; j < Dim; ++j)
+				{
+					for (dimension_t b = 0; b < BatchSize; ++b)
+					{
+						Row[b] += U[i][j][b] * LocalIn[j][b];
+					}
+				}
+				state.m_Amplitudes[Base + Indexer.Offsets[i]] = Row;
+			}
+		}
+	}
+
+	/// @brief Concept for constexpr callables producing a gate matrix from a single parameter.
+	template<auto MatrixGenerator, dimension_t QBitCount>
+	concept gate_matrix_generator =
+		requires(float_t parameter)
+	{
+		{ MatrixGenerator(parameter) } -> std::convertible_to<matrix_t<ConstexprMath::pow2(QBitCount)>>;
+	};
+
+	/**
+	 * @brief     A gate bound to qubits whose matrix depends on one parameter of a parameter set.
+	 *
+	 * @tparam QBitCount        Number of qubits the gate acts on.
+	 * @tparam MatrixGenerator  Callable mapping the parameter to the gate matrix (e.g. `Gates::RotationY`).
+	 */
+	template<dimension_t QBitCount, auto MatrixGenerator>
+		requires gate_matrix_generator<MatrixGenerator, QBitCount>
+	class SweptGateOp
+	{
+		/// @brief Position of the gate parameter within each parameter set.
+		const dimension_t ParameterIndex;
+
+		/// @brief Fixed-size list of qubit indices affected by this gate.
+		const qbit_list_t<QBitCount> AffectedBits;
+
+	public:
+		constexpr SweptGateOp(dimension_t parameterIndex, const qbit_list_t<QBitCount>& affectedBits) noexcept
+			: ParameterIndex(parameterIndex), AffectedBits(affectedBits)
+		{
+		}
+
+		/// @brief Get the gate matrix for a concrete parameter value.
+		constexpr matrix_t<ConstexprMath::pow2(QBitCount)> getGateMatrix(float_t parameter) const noexcept
+		{
+			return MatrixGenerator(parameter);
+		}
+
+		/// @brief Get the list of qubit indices the gate acts on.
+		constexpr const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Apply the gate to every member of the batch with that member's parameter.
+		/// @param state          The batch of global state vectors, updated in place.
+		/// @param parameterSets  One parameter set per batch member.
+		///
+		/// The BatchSize small matrices are generated once per call (cos/sin evaluated
+		/// once per member, not once per amplitude) and transposed into element-major
+		/// order for the batched kernel.
+		template<dimension_t StateCount, dimension_t BatchSize, dimension_t ParameterCount>
+		constexpr void applyBatched(BatchedStateVector<StateCount, BatchSize>& state,
+			const parameter_sets_t<BatchSize, ParameterCount>& parameterSets) const noexcept
+		{
+			constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+			batched_matrix_t<Dim, BatchSize> Matrices{};
+			for (dimension_t b = 0; b < BatchSize; ++b)
+			{
+				const matrix_t<Dim> U = MatrixGenerator(parameterSets[b][ParameterIndex]);
+				for (dimension_t i = 0; i < Dim; ++i)
+					for (dimension_t j = 0; j < Dim; ++j)
+						Matrices[i][j][b] = U[i][j];
+			}
+
+			applyBatchedGateMatrices<QBitCount>(state, Matrices, AffectedBits);
+		}
+	};
+
+	/**
+	 * @brief     Factory for creating `SweptGateOp` objects.
+	 *
+	 * @tparam QBitCount        Number of qubits the gate acts on.
+	 * @tparam MatrixGenerator  Callable mapping the parameter to the gate matrix.
+	 *
+	 * Example:
+	 *   auto ry = SweptGate<1, Gates::RotationY>(0).toBits(2);  // angle = parameter 0 of each set
+	 */
+	template<dimension_t QBitCount, auto MatrixGenerator>
+		requires gate_matrix_generator<MatrixGenerator, QBitCount>
+	struct SweptGate
+	{
+		/// @brief Position of the gate parameter within each parameter set.
+		dimension_t ParameterIndex;
+
+		/// @brief Construct a swept gate reading the given parameter of each set.
+		constexpr explicit SweptGate(dimension_t parameterIndex) noexcept
+			: ParameterIndex(parameterIndex)
+		{
+		}
+
+		/// @brief Bind this gate to a list of qubit indices and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr SweptGateOp<QBitCount, MatrixGenerator> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == QBitCount);
+			return SweptGateOp<QBitCount, MatrixGenerator>(
+				ParameterIndex, qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+}
@@ -0,0 +1,406 @@
+#pragma once
+#include <vector>
+
+#include "core_types.h"
+#include "circuit_record.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Rewriting passes over a `CircuitRecord`: gate fusion, cancellation and light-cone pruning.
+	///
+	/**
+	 * @details
+	 * Every gate removed from a circuit saves a full sweep over the state vector. The passes
+	 * here only use rewrites that are exact for any input state:
+	 *  - a gate may move backwards past gates it commutes with: gates on disjoint qubits,
+	 *    two diagonal gates, a diagonal gate and a gate that only uses the shared qubits as
+	 *    controls (RZ or CPhase through the control of CX / Toffoli), and otherwise any pair
+	 *    whose embedded matrices commute numerically;
+	 *  - a gate whose qubits are a subset of (or equal to) those of the gate it meets is fused
+	 *    into it, so fusion never widens a gate and never makes a sweep more expensive;
+	 *    consecutive rotations on a qubit merge this way;
+	 *  - a fused gate equal to the identity is dropped (H·H, X·X, CX·CX, R(θ)·R(-θ), ...),
+	 *    which is preferred over a plain fusion when a gate could reach either partner.
+	 *
+	 * `lightConeRecord` keeps only the gates that can influence a given set of qubits: walking
+	 * backwards, a gate is kept if it touches the qubits needed so far, which then grow by its
+	 * support. Measuring a few qubits thus skips trailing gates on the others.
+	 *
+	 * The passes write into a caller-provided record, so that records of wide circuits
+	 * (megabytes next to a 5-qubit gate) can be kept on the heap throughout.
+	 */
+
+	/// @brief Counters describing what an optimisation removed from a circuit.
+	struct CircuitOptimizationReport
+	{
+		/// @brief Number of gates before optimisation.
+		dimension_t OriginalGateCount = 0;
+
+		/// @brief Gates absorbed into a neighbouring gate on a superset of their qubits.
+		dimension_t FusedGates = 0;
+
+		/// @brief Gates dropped because they (or the result of a fusion) are the identity.
+		dimension_t CancelledGates = 0;
+
+		/// @brief Gates dropped because they cannot influence the queried qubits.
+		dimension_t PrunedGates = 0;
+
+		/// @brief Gates moved past at least one overlapping gate they commute with before being fused.
+		dimension_t CommutedGates = 0;
+
+		/// @brief Total number of gates removed, i.e. of state sweeps saved.
+		constexpr dimension_t removedGateCount() const noexcept
+		{
+			return FusedGates + CancelledGates + PrunedGates;
+		}
+	};
+
+	/// @brief A rewritten circuit together with the report of what was changed.
+	template<dimension_t MaxQBitCount, dimension_t Capacity>
+	struct OptimizedCircuit
+	{
+		CircuitRecord<MaxQBitCount, Capacity> Record{};
+		CircuitOptimizationReport Report{};
+	};
+
+	/**
+	 * @brief     Express a gate on the qubits of a wider gate.
+	 *
+	 * @param gate        The gate to embed; its qubits must all appear in `targetBits`.
+	 * @param targetBits  The qubits of the result; local bit q maps to targetBits[q].
+	 * @param targetCount Number of used entries of `targetBits`.
+	 * @return            A record acting as `gate` on its qubits and as the identity on the others.
+	 */
+	template<dimension_t MaxQBitCount>
+	constexpr GateRecord<MaxQBitCount> embedGateRecord(const GateRecord<MaxQBitCount>& gate,
+		const qbit_list_t<MaxQBitCount>& targetBits, dimension_t targetCount) noexcept
+	{
+		// Position of every qubit of the gate within the target qubits
+		qbit_list_t<MaxQBitCount> Position{};
+		dimension_t GateMask = 0;
+		for (dimension_t q = 0; q < gate.QBitCount; ++q)
+		{
+			for (dimension_t t = 0; t < targetCount; ++t)
+			{
+				if (targetBits[t] == gate.AffectedBits[q])
+					Position[q] = t;
+			}
+			GateMask |= dimension_t(1) << Position[q];
+		}
+
+		GateRecord<MaxQBitCount> Result{};
+		Result.QBitCount = targetCount;
+		Result.AffectedBits = targetBits;
+
+		const dimension_t Dim = Result.dim();
+		for (dimension_t i = 0; i < Dim; ++i)
+		{
+			for (dimension_t j = 0; j < Dim; ++j)
+			{
+				// The other qubits are untouched: they must agree between row and column
+				if ((i & ~GateMask) != (j & ~GateMask))
+					continue;
+
+				dimension_t LocalI = 0;
+				dimension_t LocalJ = 0;
+				for (dimension_t q = 0; q < gate.QBitCount; ++q)
+				{
+					LocalI |= ((i >> Position[q]) & 1) << q;
+					LocalJ |= ((j >> Position[q]) & 1) << q;
+				}
+				Result.Matrix[i][j] = gate.Matrix[LocalI][LocalJ];
+			}
+		}
+
+		Result.classify();
+		return Result;
+	}
+
+	/// @brief True if the support of `inner` is contained in the support of `outer`.
+	template<dimension_t MaxQBitCount>
+	constexpr bool supportContains(const GateRecord<MaxQBitCount>& outer, const GateRecord<MaxQBitCount>& inner) noexcept
+	{
+		return (inner.getAffectedMask() & ~outer.getAffectedMask()) == 0;
+	}
+
+	/**
+	 * @brief     Fuse two gates whose supports are nested into one gate.
+	 *
+	 * @param first   The gate applied first.
+	 * @param second  The gate applied second.
+	 * @return        A record equal to `second · first`, on the qubits of the wider of the two.
+	 */
+	template<dimension_t MaxQBitCount>
+	constexpr GateRecord<MaxQBitCount> fuseGateRecords(const GateRecord<MaxQBitCount>& first,
+		const GateRecord<MaxQBitCount>& second) noexcept
+	{
+		const GateRecord<MaxQBitCount>& Outer = supportContains(first, second) ? first : second;
+
+		const GateRecord<MaxQBitCount> A = embedGateRecord(first, Outer.AffectedBits, Outer.QBitCount);
+		const GateRecord<MaxQBitCount> B = embedGateRecord(second, Outer.AffectedBits, Outer.QBitCount);
+
+		GateRecord<MaxQBitCount> Result{};
+		Result.QBitCount = Outer.QBitCount;
+		Result.AffectedBits = Outer.AffectedBits;
+
+		const dimension_t Dim = Result.dim();
+		for (dimension_t i = 0; i < Dim; ++i)
+			for (dimension_t k = 0; k < Dim; ++k)
+				for (dimension_t j = 0; j < Dim; ++j)
+					Result.Matrix[i][j] += B.Matrix[i][k] * A.Matrix[k][j];
+
+		Result.classify();
+		return Result;
+	}
+
+	/// @brief True if the gate never changes the computational value of the given local qubit (it is a control).
+	template<dimension_t MaxQBitCount>
+	constexpr bool preservesLocalQBit(const GateRecord<MaxQBitCount>& gate, dimension_t localQBit) noexcept
+	{
+		const dimension_t Bit = dimension_t(1) << localQBit;
+		for (dimension_t i = 0; i < gate.dim(); ++i)
+			for (dimension_t j = 0; j < gate.dim(); ++j)
+			{
+				if (((i ^ j) & Bit) != 0 && !isNegligible(gate.Matrix[i][j]))
+					return false;
+			}
+		return true;
+	}
+
+	/// @brief True if a diagonal gate commutes with `other` because `other` only controls on their shared qubits.
+	template<dimension_t MaxQBitCount>
+	constexpr bool diagonalCommutesThroughControls(const GateRecord<MaxQBitCount>& diagonal,
+		const GateRecord<MaxQBitCount>& other) noexcept
+	{
+		const dimension_t Shared = diagonal.getAffectedMask() & other.getAffectedMask();
+		for (dimension_t q = 0; q < other.QBitCount; ++q)
+		{
+			if ((Shared >> other.AffectedBits[q]) & 1)
+			{
+				if (!preservesLocalQBit(other, q))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief     Check whether two gates commute.
+	 *
+	 * Structural rules are tried first; pairs they do not decide are embedded on the union
+	 * of their qubits and compared as A·B == B·A, provided that union fits a record.
+	 */
+	template<dimension_t MaxQBitCount>
+	constexpr bool gatesCommute(const GateRecord<MaxQBitCount>& a, const GateRecord<MaxQBitCount>& b) noexcept
+	{
+		if ((a.getAffectedMask() & b.getAffectedMask()) == 0)
+			return true;
+		if (a.IsDiagonal && b.IsDiagonal)
+			return true;
+		if (a.IsDiagonal && diagonalCommutesThroughControls(a, b))
+			return true;
+		if (b.IsDiagonal && diagonalCommutesThroughControls(b, a))
+			return true;
+
+		// Union of the qubits, a's first
+		qbit_list_t<MaxQBitCount> UnionBits = a.AffectedBits;
+		dimension_t UnionCount = a.QBitCount;
+		for (dimension_t q = 0; q < b.QBitCount; ++q)
+		{
+			if ((a.getAffectedMask() >> b.AffectedBits[q]) & 1)
+				continue;
+			if (UnionCount == MaxQBitCount)
+				return false;
+			UnionBits[UnionCount++] = b.AffectedBits[q];
+		}
+
+		const GateRecord<MaxQBitCount> A = embedGateRecord(a, UnionBits, UnionCount);
+		const GateRecord<MaxQBitCount> B = embedGateRecord(b, UnionBits, UnionCount);
+		const dimension_t Dim = A.dim();
+		for (dimension_t i = 0; i < Dim; ++i)
+			for (dimension_t j = 0; j < Dim; ++j)
+			{
+				cplx_t AB{};
+				cplx_t BA{};
+				for (dimension_t k = 0; k < Dim; ++k)
+				{
+					AB += A.Matrix[i][k] * B.Matrix[k][j];
+					BA += B.Matrix[i][k] * A.Matrix[k][j];
+				}
+				if (!isNegligible(AB - BA))
+					return false;
+			}
+		return true;
+	}
+
+	/**
+	 * @brief     Fuse gates into earlier gates on nested qubits, commuting them backwards, and drop identities.
+	 *
+	 * @param circuit  The recorded circuit.
+	 * @param report   Updated with the number of fused, cancelled and commuted gates.
+	 * @param result   Overwritten with the rewritten circuit; must not be `circuit`.
+	 *
+	 * Each gate looks back over the already emitted gates as long as it commutes with them.
+	 * Among the gates met on the way whose support is nested with its own, the first one it
+	 * cancels with is taken, otherwise the nearest one; the gate is then fused into it.
+	 */
+	template<dimension_t MaxQBitCount, dimension_t Capacity>
+	constexpr void fuseAndCancelGates(const CircuitRecord<MaxQBitCount, Capacity>& circuit,
+		CircuitOptimizationReport& report, CircuitRecord<MaxQBitCount, Capacity>& result) noexcept
+	{
+		result.GateCount = 0;
+
+		for (dimension_t g = 0; g < circuit.GateCount; ++g)
+		{
+			const GateRecord<MaxQBitCount>& Gate = circuit.Gates[g];
+
+			if (Gate.isIdentity())
+			{
+				++report.CancelledGates;
+				continue;
+			}
+
+			// Walk back over the emitted gates this one commutes with
+			dimension_t Partner = result.GateCount;
+			GateRecord<MaxQBitCount> Fused{};
+			bool Cancels = false;
+			bool Commuted = false;
+			bool Overlapped = false;
+			for (dimension_t k = result.GateCount; k > 0; --k)
+			{
+				const GateRecord<MaxQBitCount>& Earlier = result.Gates[k - 1];
+				if ((Earlier.getAffectedMask() & Gate.getAffectedMask()) == 0)
+					continue;
+
+				if (supportContains(Earlier, Gate) || supportContains(Gate, Earlier))
+				{
+					const GateRecord<MaxQBitCount> Candidate = fuseGateRecords(Earlier, Gate);
+					if (Candidate.isIdentity() || Partner == result.GateCount)
+					{
+						Partner = k - 1;
+						Fused = Candidate;
+						Commuted = Overlapped;
+						Cancels = Candidate.isIdentity();
+					}
+					if (Cancels)
+						break;
+				}
+
+				if (!gatesCommute(Earlier, Gate))
+					break;
+				Overlapped = true;
+			}
+
+			if (Partner == result.GateCount)
+			{
+				result.push(Gate);
+				continue;
+			}
+
+			++report.FusedGates;
+			report.CommutedGates += Commuted ? 1 : 0;
+
+			if (!Cancels)
+			{
+				result.Gates[Partner] = Fused;
+				continue;
+			}
+
+			// The pair cancels: remove the partner as well
+			++report.CancelledGates;
+			for (dimension_t k = Partner + 1; k < result.GateCount; ++k)
+				result.Gates[k - 1] = result.Gates[k];
+			--result.GateCount;
+		}
+	}
+
+	/**
+	 * @brief     Keep only the gates inside the backward light cone of a set of qubits.
+	 *
+	 * @param circuit    The recorded circuit.
+	 * @param qbitMask   The qubits whose reduced state must be preserved.
+	 * @param report     Updated with the number of pruned gates.
+	 * @param result     Overwritten with the circuit without the gates that cannot influence
+	 *                   those qubits; must not be `circuit`.
+	 */
+	template<dimension_t MaxQBitCount, dimension_t Capacity>
+	constexpr void lightConeRecord(const CircuitRecord<MaxQBitCount, Capacity>& circuit, dimension_t qbitMask,
+		CircuitOptimizationReport& report, CircuitRecord<MaxQBitCount, Capacity>& result) noexcept
+	{
+		std::array<bool, Capacity> Keep{};
+		dimension_t Cone = qbitMask;
+		for (dimension_t g = circuit.GateCount; g > 0; --g)
+		{
+			const dimension_t Support = circuit.Gates[g - 1].getAffectedMask();
+			if ((Support & Cone) != 0)
+			{
+				Keep[g - 1] = true;
+				Cone |= Support;
+			}
+		}
+
+		result.GateCount = 0;
+		for (dimension_t g = 0; g < circuit.GateCount; ++g)
+		{
+			if (Keep[g])
+				result.push(circuit.Gates[g]);
+			else
+				++report.PrunedGates;
+		}
+	}
+
+	/**
+	 * @brief     Run all optimisation passes on a recorded circuit, into a caller-provided result.
+	 *
+	 * @param circuit   The recorded circuit.
+	 * @param qbitMask  Qubits whose reduced state must be preserved (all ones: the full state).
+	 * @param result    Overwritten with the optimised circuit and the report of the removed gates.
+	 *
+	 * The intermediate record between the passes is heap-allocated.
+	 */
+	template<dimension_t MaxQBitCount, dimension_t Capacity>
+	constexpr void optimizeCircuit(const CircuitRecord<MaxQBitCount, Capacity>& circuit, dimension_t qbitMask,
+		OptimizedCircuit<MaxQBitCount, Capacity>& result)
+	{
+		result.Report = CircuitOptimizationReport{};
+		result.Report.OriginalGateCount = circuit.GateCount;
+
+		std::vector<CircuitRecord<MaxQBitCount, Capacity>> LightCone(1);
+		lightConeRecord(circuit, qbitMask, result.Report, LightCone[0]);
+		fuseAndCancelGates(LightCone[0], result.Report, result.Record);
+	}
+
+	/**
+	 * @brief     Run all optimisation passes on a recorded circuit.
+	 *
+	 * @param circuit   The recorded circuit.
+	 * @param qbitMask  Qubits whose reduced state must be preserved (all ones: the full state).
+	 * @return          The optimised circuit and the report of the removed gates.
+	 */
+	template<dimension_t MaxQBitCount, dimension_t Capacity>
+	constexpr OptimizedCircuit<MaxQBitCount, Capacity> optimizeCircuit(
+		const CircuitRecord<MaxQBitCount, Capacity>& circuit, dimension_t qbitMask = ~dimension_t(0))
+	{
+		OptimizedCircuit<MaxQBitCount, Capacity> Result{};
+		optimizeCircuit(circuit, qbitMask, Result);
+		return Result;
+	}
+
+	/**
+	 * @brief     Record a gate pack and optimise it for the full state.
+	 *
+	 * @param gates  The gates (matrices and qubits are copied).
+	 * @return       The optimised record, runnable with `CircuitRecord::execute`, and the report.
+	 *
+	 * Example:
+	 *   constexpr auto Optimized = optimizeGates(QuantumGate<1, Gates::H>().toBits(0), QuantumGate<1, Gates::H>().toBits(0));
+	 *   static_assert(Optimized.Report.removedGateCount() == 2);
+	 */
+	template<RecordableGate... Gates>
+	constexpr OptimizedCircuit<recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>
+		optimizeGates(const Gates&... gates)
+	{
+		return optimizeCircuit(CircuitRecord<recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>::fromGates(gates...));
+	}
+}
@@ -0,0 +1,442 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "core_types.h"
+#include "gate_scheduler.h"
+#include "quantum_gate_solver.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Recorded form of a circuit: a flat, copyable list of gate matrices and their qubits.
+	///
+	/**
+	 * @details
+	 * Gate operations are distinct types (one per qubit count and factory), which is what
+	 * keeps immediate execution free of any dispatch, but it also means a gate pack cannot be
+	 * rewritten: nothing can be reordered, fused or dropped. A `CircuitRecord` copies the
+	 * matrix and qubits of every gate into a homogeneous array of `GateRecord`s, each sized
+	 * for the widest gate of the circuit. Optimisation passes (see circuit_optimizer.h) work
+	 * on that array, and the records themselves are blockable gates, so an optimised record
+	 * still runs through the cache-blocked scheduler.
+	 *
+	 * Records are plain aggregates of std::array, so they can be built, optimised and
+	 * executed in constant expressions.
+	 */
+
+	/// @brief Absolute tolerance used when classifying recorded matrices (identity, diagonal, permutation).
+	constexpr float_t RecordTolerance = 1E-12;
+
+	/// @brief Concept for gates that can be recorded: they expose their matrix and affected qubits.
+	template<typename GateType>
+	concept RecordableGate =
+		requires(const GateType g)
+	{
+		g.getGateMatrix();
+		g.getAffectedBits();
+	};
+
+	/// @brief Number of qubits a recordable gate type acts on.
+	template<RecordableGate GateType>
+	constexpr dimension_t recorded_qbit_count_v =
+		std::tuple_size_v<std::remove_cvref_t<decltype(std::declval<const GateType&>().getAffectedBits())>>;
+
+	/// @brief Width of the widest gate of a pack, i.e. the record width needed to hold all of them.
+	template<RecordableGate... Gates>
+	constexpr dimension_t recorded_max_qbit_count_v = std::max({ dimension_t{ 1 }, recorded_qbit_count_v<Gates>... });
+
+	/// @brief True if |z| is below the record tolerance.
+	constexpr bool isNegligible(const cplx_t& z) noexcept
+	{
+		return z.normSquared() <= RecordTolerance * RecordTolerance;
+	}
+
+	/// @brief True if every column of the leading dim × dim block holds exactly one non-zero entry, each in a distinct row.
+	template<typename Matrix>
+	constexpr bool isPhasePermutationMatrix(const Matrix& matrix, dimension_t dim) noexcept
+	{
+		// One non-zero per column is not enough: the rows must also be distinct, or
+		// several basis states would be moved onto the same one.
+		std::array<bool, std::tuple_size_v<Matrix>> RowUsed{};
+		for (dimension_t j = 0; j < dim; ++j)
+		{
+			dimension_t NonZeroCount = 0;
+			dimension_t Row = 0;
+			for (dimension_t i = 0; i < dim; ++i)
+			{
+				if (!isNegligible(matrix[i][j]))
+				{
+					++NonZeroCount;
+					Row = i;
+				}
+			}
+			if (NonZeroCount != 1 || RowUsed[Row])
+				return false;
+			RowUsed[Row] = true;
+		}
+		return true;
+	}
+
+	/// @brief True if the leading dim × dim block is diagonal.
+	template<typename Matrix>
+	constexpr bool isDiagonalMatrix(const Matrix& matrix, dimension_t dim) noexcept
+	{
+		for (dimension_t i = 0; i < dim; ++i)
+			for (dimension_t j = 0; j < dim; ++j)
+			{
+				if (i != j && !isNegligible(matrix[i][j]))
+					return false;
+			}
+		return true;
+	}
+
+	/**
+	 * @brief     Apply a phase-permutation matrix to a single basis state.
+	 *
+	 * @param matrix        The gate matrix; its leading 2^qbitCount block is used.
+	 * @param affectedBits  The qubits the gate acts on; local basis bit q maps to affectedBits[q].
+	 * @param qbitCount     Number of qubits the gate acts on.
+	 * @param index         The global basis state index, replaced by the index of the image.
+	 * @param amplitude     The amplitude of the basis state, multiplied by the phase picked up.
+	 */
+	template<typename Matrix, typename QBitList>
+	constexpr void applyToBasisState(const Matrix& matrix, const QBitList& affectedBits, dimension_t qbitCount,
+		dimension_t& index, cplx_t& amplitude) noexcept
+	{
+		dimension_t Local = 0;
+		for (dimension_t q = 0; q < qbitCount; ++q)
+			Local |= ((index >> affectedBits[q]) & 1) << q;
+
+		for (dimension_t Row = 0; Row < ConstexprMath::pow2(qbitCount); ++Row)
+		{
+			if (isNegligible(matrix[Row][Local]))
+				continue;
+
+			amplitude = matrix[Row][Local] * amplitude;
+			for (dimension_t q = 0; q < qbitCount; ++q)
+			{
+				index &= ~(dimension_t(1) << affectedBits[q]);
+				index |= ((Row >> q) & 1) << affectedBits[q];
+			}
+			return;
+		}
+	}
+
+	/**
+	 * @brief     One recorded gate: a matrix on up to MaxQBitCount qubits and the qubits it acts on.
+	 *
+	 * @tparam MaxQBitCount  Width of the widest gate the record can hold.
+	 *
+	 * A gate on k < MaxQBitCount qubits uses the leading 2^k × 2^k block of `Matrix` and
+	 * the first k entries of `AffectedBits`. Local basis bit q maps to AffectedBits[q], as
+	 * for `QuantumGateOp`.
+	 */
+	template<dimension_t MaxQBitCount>
+	struct GateRecord
+	{
+		static constexpr dimension_t MaxDim = ConstexprMath::pow2(MaxQBitCount);
+
+		matrix_t<MaxDim> Matrix{};
+		qbit_list_t<MaxQBitCount> AffectedBits{};
+
+		/// Number of qubits the gate acts on.
+		dimension_t QBitCount = 0;
+
+		/// True if the matrix is diagonal; it is then applied as a per-amplitude phase.
+		bool IsDiagonal = false;
+
+		/// True if every column holds exactly one non-zero entry, each in a distinct row (X, CX,
+		/// Toffoli, SWAP, phases): the gate maps basis states one-to-one onto basis states, and
+		/// is applied by moving amplitudes.
+		bool IsPhasePermutation = false;
+
+		/// @brief Dimension 2^QBitCount of the used matrix block.
+		constexpr dimension_t dim() const noexcept
+		{
+			return ConstexprMath::pow2(QBitCount);
+		}
+
+		/// @brief Get the bit mask of the qubits the gate acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			dimension_t Mask = 0;
+			for (dimension_t q = 0; q < QBitCount; ++q)
+				Mask |= dimension_t(1) << AffectedBits[q];
+			return Mask;
+		}
+
+		/// @brief True if the used matrix block is the identity.
+		constexpr bool isIdentity() const noexcept
+		{
+			for (dimension_t i = 0; i < dim(); ++i)
+				for (dimension_t j = 0; j < dim(); ++j)
+				{
+					if (!isNegligible(Matrix[i][j] - cplx_t::fromReal(i == j ? 1.0 : 0.0)))
+						return false;
+				}
+			return true;
+		}
+
+		/// @brief Re-evaluate the matrix flags, and clean the off-diagonal entries of diagonal matrices.
+		constexpr void classify() noexcept
+		{
+			IsPhasePermutation = isPhasePermutationMatrix(Matrix, dim());
+			IsDiagonal = isDiagonalMatrix(Matrix, dim());
+
+			if (IsDiagonal)
+			{
+				for (dimension_t i = 0; i < dim(); ++i)
+					for (dimension_t j = 0; j < dim(); ++j)
+						if (i != j)
+							Matrix[i][j] = cplx_t::zero();
+			}
+		}
+
+		/**
+		 * @brief     Apply a phase-permutation gate to a single basis state.
+		 *
+		 * @param index      The global basis state index, replaced by the index of the image.
+		 * @param amplitude  The amplitude of the basis state, multiplied by the phase picked up.
+		 *
+		 * Requires `IsPhasePermutation`; lets a circuit prefix made of such gates be tracked
+		 * on one basis state instead of sweeping the whole vector.
+		 */
+		constexpr void applyToBasisState(dimension_t& index, cplx_t& amplitude) const noexcept
+		{
+			QCC::applyToBasisState(Matrix, AffectedBits, QBitCount, index, amplitude);
+		}
+
+		/// @brief Apply the gate in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			applyWithWidth<1>(state, layout, firstIndex, lastIndex);
+		}
+
+		/// @brief Apply the gate in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyInPlace(state, QubitLayout<QBitCountOf<StateCount>>{}, 0, StateCount);
+		}
+
+		/// @brief Apply the gate to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount> operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+
+	private:
+		/// @brief Dispatch the runtime width to the fixed-width kernels.
+		template<dimension_t Width, dimension_t StateCount>
+		constexpr void applyWithWidth(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			if constexpr (Width <= MaxQBitCount)
+			{
+				if (QBitCount != Width)
+					return applyWithWidth<Width + 1>(state, layout, firstIndex, lastIndex);
+
+				constexpr dimension_t Dim = ConstexprMath::pow2(Width);
+
+				qbit_list_t<Width> Bits{};
+				for (dimension_t q = 0; q < Width; ++q)
+					Bits[q] = AffectedBits[q];
+
+				if (IsDiagonal)
+				{
+					state_vector_t<Dim> Diagonal{};
+					for (dimension_t i = 0; i < Dim; ++i)
+						Diagonal[i] = Matrix[i][i];
+					applyDiagonalMatrix<Width>(state, Diagonal, layout.map(Bits), firstIndex, lastIndex);
+				}
+				else
+				{
+					matrix_t<Dim> U{};
+					for (dimension_t i = 0; i < Dim; ++i)
+						for (dimension_t j = 0; j < Dim; ++j)
+							U[i][j] = Matrix[i][j];
+
+					if (IsPhasePermutation)
+						applyPhasePermutationMatrix<Width>(state, U, layout.map(Bits), firstIndex, lastIndex);
+					else
+						applyGateMatrix<Width>(state, U, layout.map(Bits), firstIndex, lastIndex);
+				}
+			}
+		}
+	};
+
+	/// @brief Copy the matrix and qubits of a gate into a record of the given width.
+	template<dimension_t MaxQBitCount, RecordableGate GateType>
+		requires (recorded_qbit_count_v<GateType> <= MaxQBitCount)
+	constexpr GateRecord<MaxQBitCount> recordGate(const GateType& gate) noexcept
+	{
+		constexpr dimension_t QBitCount = recorded_qbit_count_v<GateType>;
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		GateRecord<MaxQBitCount> Record{};
+		Record.QBitCount = QBitCount;
+		for (dimension_t q = 0; q < QBitCount; ++q)
+			Record.AffectedBits[q] = gate.getAffectedBits()[q];
+		for (dimension_t i = 0; i < Dim; ++i)
+			for (dimension_t j = 0; j < Dim; ++j)
+				Record.Matrix[i][j] = gate.getGateMatrix()[i][j];
+		Record.classify();
+		return Record;
+	}
+
+	/**
+	 * @brief     A recorded circuit: up to Capacity gate records, executed in order.
+	 *
+	 * @tparam MaxQBitCount  Width of the widest recorded gate.
+	 * @tparam Capacity      Maximum number of records (the length of the original gate pack).
+	 */
+	template<dimension_t MaxQBitCount, dimension_t Capacity>
+	struct CircuitRecord
+	{
+		std::array<GateRecord<MaxQBitCount>, Capacity> Gates{};
+		dimension_t GateCount = 0;
+
+		/// @brief Record a gate pack.
+		template<RecordableGate... GateTypes>
+			requires (sizeof...(GateTypes) <= Capacity)
+		static constexpr CircuitRecord fromGates(const GateTypes&... gates) noexcept
+		{
+			CircuitRecord Record{};
+			Record.append(gates...);
+			return Record;
+		}
+
+		/// @brief Record a gate pack in place, after the gates already recorded (for records kept on the heap).
+		template<RecordableGate... GateTypes>
+			requires (sizeof...(GateTypes) <= Capacity)
+		constexpr void append(const GateTypes&... gates) noexcept
+		{
+			(push(recordGate<MaxQBitCount>(gates)), ...);
+		}
+
+		/// @brief Append a record (the capacity must not be exceeded).
+		constexpr void push(const GateRecord<MaxQBitCount>& gate) noexcept
+		{
+			Gates[GateCount++] = gate;
+		}
+
+		/// @brief Union of the supports of all recorded gates.
+		constexpr dimension_t getSupportMask() const noexcept
+		{
+			dimension_t Mask = 0;
+			for (dimension_t g = 0; g < GateCount; ++g)
+				Mask |= Gates[g].getAffectedMask();
+			return Mask;
+		}
+
+		/// @brief Execute the recorded gates [firstGate, lastGate) in place with the cache-blocked scheduler.
+		template<dimension_t StateCount>
+		constexpr void execute(StateVector<StateCount>& state, dimension_t firstGate, dimension_t lastGate) const
+		{
+			executeCacheBlockedSequence(state, Gates, firstGate, lastGate);
+		}
+
+		/// @brief Execute the recorded gates [firstGate, GateCount) in place with the cache-blocked scheduler.
+		template<dimension_t StateCount>
+		constexpr void execute(StateVector<StateCount>& state, dimension_t firstGate = 0) const
+		{
+			execute(state, firstGate, GateCount);
+		}
+	};
+
+	/**
+	 * @brief     What the schedulers and the cost model need of a gate: its width, its support and
+	 *            the class of its matrix, but not the matrix itself.
+	 *
+	 * A summary takes three words where a record takes a full-width matrix (64 KiB at 6 qubits),
+	 * so a circuit can be profiled without recording it.
+	 */
+	struct GateSummary
+	{
+		dimension_t QBitCount = 0;
+		dimension_t AffectedMask = 0;
+		bool IsDiagonal = false;
+		bool IsPhasePermutation = false;
+
+		/// @brief Dimension 2^QBitCount of the gate matrix.
+		constexpr dimension_t dim() const noexcept
+		{
+			return ConstexprMath::pow2(QBitCount);
+		}
+
+		/// @brief Get the bit mask of the qubits the gate acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return AffectedMask;
+		}
+	};
+
+	/// @brief Summarise a gate exposing its matrix, classifying the matrix in place.
+	template<RecordableGate GateType>
+	constexpr GateSummary summarizeGate(const GateType& gate) noexcept
+	{
+		constexpr dimension_t QBitCount = recorded_qbit_count_v<GateType>;
+
+		GateSummary Summary{};
+		Summary.QBitCount = QBitCount;
+		for (dimension_t q = 0; q < QBitCount; ++q)
+			Summary.AffectedMask |= dimension_t(1) << gate.getAffectedBits()[q];
+		Summary.IsDiagonal = isDiagonalMatrix(gate.getGateMatrix(), Summary.dim());
+		Summary.IsPhasePermutation = isPhasePermutationMatrix(gate.getGateMatrix(), Summary.dim());
+		return Summary;
+	}
+
+	/// @brief Summarise a recorded gate.
+	template<dimension_t MaxQBitCount>
+	constexpr GateSummary summarizeGate(const GateRecord<MaxQBitCount>& gate) noexcept
+	{
+		return GateSummary{ gate.QBitCount, gate.getAffectedMask(), gate.IsDiagonal, gate.IsPhasePermutation };
+	}
+
+	/**
+	 * @brief     The summaries of up to Capacity gates, in order.
+	 *
+	 * @tparam Capacity  Maximum number of summaries (the length of the original gate pack).
+	 */
+	template<dimension_t Capacity>
+	struct CircuitSummary
+	{
+		std::array<GateSummary, Capacity> Gates{};
+		dimension_t GateCount = 0;
+
+		/// @brief Summarise a gate pack; gates that do not expose their matrix (such as barriers) are skipped.
+		template<typename... GateTypes>
+			requires (sizeof...(GateTypes) <= Capacity)
+		static constexpr CircuitSummary fromGates(const GateTypes&... gates) noexcept
+		{
+			CircuitSummary Summary{};
+			([&]
+				{
+					if constexpr (RecordableGate<GateTypes>)
+						Summary.Gates[Summary.GateCount++] = summarizeGate(gates);
+				}(), ...);
+			return Summary;
+		}
+
+		/// @brief Summarise a recorded circuit.
+		template<dimension_t MaxQBitCount>
+		static constexpr CircuitSummary fromRecord(const CircuitRecord<MaxQBitCount, Capacity>& circuit) noexcept
+		{
+			CircuitSummary Summary{};
+			for (dimension_t g = 0; g < circuit.GateCount; ++g)
+				Summary.Gates[Summary.GateCount++] = summarizeGate(circuit.Gates[g]);
+			return Summary;
+		}
+	};
+}
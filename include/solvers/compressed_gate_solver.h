@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include "core_types.h"
+#include "circuit_record.h"
+#include "wavefunction/compressed_state_vector.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Gate application on block-compressed states, one decoded tile at a time.
+	///
+	/**
+	 * @details
+	 * The state is split into chunks of 2^CompressedChunkQBitCount amplitudes. A gate whose
+	 * qubits all lie inside a chunk is applied chunk by chunk: decode the chunk into a small
+	 * ordinary state vector (the "registers" of the kernel), run the usual gate kernel on it,
+	 * encode it back. A gate touching h qubits above the chunk needs the 2^h chunks that
+	 * differ only in those qubits: they are decoded side by side into one tile, in which the
+	 * high qubits become tile qubits CompressedChunkQBitCount, ..., and the gate runs on the
+	 * tile with its qubits remapped accordingly.
+	 *
+	 * Every pass re-encodes the whole state once, so it updates the stored norm and adds its
+	 * rounding error to the state's error bound (see compressed_state_vector.h). Gates go
+	 * through their recorded form (see circuit_record.h), so every gate exposing its matrix
+	 * runs unchanged.
+	 */
+
+	/// @brief Chunk size in qubits: 2^10 amplitudes × 16 bytes = 16 KiB decoded, an L1-sized tile.
+	constexpr dimension_t CompressedChunkQBitCount = 10;
+
+	/**
+	 * @brief     Apply one recorded gate in place to a compressed state.
+	 *
+	 * @tparam QBitCount     Number of qubits of the state.
+	 * @tparam MaxQBitCount  Width of the record.
+	 * @param state          The compressed state.
+	 * @param gate           The gate record.
+	 */
+	template<dimension_t QBitCount, dimension_t MaxQBitCount, AmplitudeFormat Format>
+	constexpr void applyCompressedGate(CompressedStateVector<ConstexprMath::pow2(QBitCount), Format>& state,
+		const GateRecord<MaxQBitCount>& gate)
+	{
+		constexpr dimension_t ChunkQBitCount = std::min(QBitCount, CompressedChunkQBitCount);
+		constexpr dimension_t ChunkSize = ConstexprMath::pow2(ChunkQBitCount);
+		constexpr dimension_t ChunkCount = ConstexprMath::pow2(QBitCount - ChunkQBitCount);
+		constexpr dimension_t TileQBitCount = std::min(QBitCount, ChunkQBitCount + MaxQBitCount);
+
+		// Qubits above the chunk become tile qubits ChunkQBitCount, ChunkQBitCount + 1, ...
+		GateRecord<MaxQBitCount> TileGate = gate;
+		dimension_t HighMask = 0;
+		for (dimension_t q = 0; q < gate.QBitCount; ++q)
+		{
+			if (gate.AffectedBits[q] >= ChunkQBitCount)
+				HighMask |= dimension_t(1) << (gate.AffectedBits[q] - ChunkQBitCount);
+		}
+		for (dimension_t q = 0; q < gate.QBitCount; ++q)
+		{
+			const dimension_t Bit = gate.AffectedBits[q];
+			if (Bit >= ChunkQBitCount)
+				TileGate.AffectedBits[q] = ChunkQBitCount + std::popcount(HighMask & ((dimension_t(1) << (Bit - ChunkQBitCount)) - 1));
+		}
+
+		const dimension_t HighCount = static_cast<dimension_t>(std::popcount(HighMask));
+		const dimension_t TileChunkCount = ConstexprMath::pow2(HighCount);
+
+		// The tile holds 2^(chunk + gate) qubits uncompressed (512 KiB next to a 5-qubit gate): heap
+		std::vector<StateVector<ConstexprMath::pow2(TileQBitCount)>> Tiles(1);
+		StateVector<ConstexprMath::pow2(TileQBitCount)>& Tile = Tiles[0];
+		float_t NormSquared = 0.0, ErrorSquared = 0.0;
+		for (dimension_t Group = 0; Group < ChunkCount / TileChunkCount; ++Group)
+		{
+			// Spread the group index over the chunk-index bits outside HighMask
+			dimension_t Base = 0;
+			for (dimension_t Bit = 0, Source = 0; Source < QBitCount - ChunkQBitCount - HighCount; ++Bit)
+			{
+				if (!((HighMask >> Bit) & 1))
+					Base |= ((Group >> Source++) & 1) << Bit;
+			}
+
+			// Tile chunk t is the chunk with the high qubits set to the bits of t
+			const auto chunkOf = [&](dimension_t t)
+				{
+					dimension_t Chunk = Base;
+					for (dimension_t Bit = 0, Source = 0; Source < HighCount; ++Bit)
+					{
+						if ((HighMask >> Bit) & 1)
+							Chunk |= ((t >> Source++) & 1) << Bit;
+					}
+					return Chunk;
+				};
+
+			for (dimension_t t = 0; t < TileChunkCount; ++t)
+				state.decode(chunkOf(t) * ChunkSize, ChunkSize, Tile.m_StateVector.data() + t * ChunkSize);
+
+			TileGate.applyInPlace(Tile, QubitLayout<TileQBitCount>{}, 0, TileChunkCount * ChunkSize);
+
+			for (dimension_t t = 0; t < TileChunkCount; ++t)
+				state.encode(chunkOf(t) * ChunkSize, ChunkSize, Tile.m_StateVector.data() + t * ChunkSize, NormSquared, ErrorSquared);
+		}
+		state.recordPass(NormSquared, ErrorSquared);
+	}
+
+	/// @brief Apply a gate sequence in place to a compressed state, one pass per gate.
+	template<dimension_t QBitCount, AmplitudeFormat Format, RecordableGate... GateTypes>
+	constexpr void applyCompressedGates(CompressedStateVector<ConstexprMath::pow2(QBitCount), Format>& state,
+		const GateTypes&... gates)
+	{
+		constexpr dimension_t MaxQBitCount = recorded_max_qbit_count_v<GateTypes...>;
+		(applyCompressedGate<QBitCount>(state, recordGate<MaxQBitCount>(gates)), ...);
+	}
+}
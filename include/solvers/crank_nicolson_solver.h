@@ -46,6 +46,7 @@ namespace KetCat
 
 	/// @brief  Helper function to construct the Crank–Nicolson system matrices A and B.
 	/// @tparam Dim     Dimension of the Hilbert space.
+	/// @tparam Real    Precision of the matrices.
 	/// @param  hamiltonian  Hamiltonian operator of the system.
 	/// @param  dt           Time step size.
 	/// @param  A            Output matrix A = I + i·dt/(2ħ)·H.
@@ -58,20 +59,20 @@ namespace KetCat
 	///
 	/// If the Hamiltonian matrix is tridiagonal, both A and B remain
 	/// tridiagonal, enabling efficient O(N) time stepping.
-	template<dimension_t Dim>
-	static constexpr void buildCrankNicolsonMatrices(const Hamiltonian<Dim>& hamiltonian, float_t dt,
-		tridiagonal_matrix_t<Dim>& A, tridiagonal_matrix_t<Dim>& B) noexcept
+	template<dimension_t Dim, precision_type Real>
+	static constexpr void buildCrankNicolsonMatrices(const Hamiltonian<Dim, Real>& hamiltonian, float_t dt,
+		tridiagonal_matrix_t<Dim, Real>& A, tridiagonal_matrix_t<Dim, Real>& B) noexcept
 	{
-		const tridiagonal_matrix_t<Dim>& H = hamiltonian.getMatrix();
+		const tridiagonal_matrix_t<Dim, Real>& H = hamiltonian.getMatrix();
 
 		// i * dt / (2ħ)
-		const cplx_t Factor(0.0, dt / (2.0 * hBar));
+		const complex_t<Real> Factor(0.0, static_cast<Real>(dt / (2.0 * hBar)));
 
 		for (dimension_t i = 0; i < Dim; ++i)
 		{
 			// Build main diagonal
-			A[MainDiagonal][i] = cplx_t::fromReal(1.0) + Factor * H[MainDiagonal][i];
-			B[MainDiagonal][i] = cplx_t::fromReal(1.0) - Factor * H[MainDiagonal][i];
+			A[MainDiagonal][i] = complex_t<Real>::fromReal(1.0) + Factor * H[MainDiagonal][i];
+			B[MainDiagonal][i] = complex_t<Real>::fromReal(1.0) - Factor * H[MainDiagonal][i];
 
 			//  Build lower diagonal
 			if (i > 0)
@@ -100,11 +101,11 @@ namespace KetCat
 	/// This routine performs an efficient matrix–vector multiplication
 	/// exploiting the tridiagonal structure of the matrix. It is primarily
 	/// used to construct the right-hand side of the Crank–Nicolson system.
-	template<dimension_t Dim>
-	static constexpr StateVector<Dim>
-		multiplyTrigiagonal(const tridiagonal_matrix_t<Dim>& M, const StateVector<Dim>& x) noexcept
+	template<dimension_t Dim, precision_type Real>
+	static constexpr StateVector<Dim, Real>
+		multiplyTrigiagonal(const tridiagonal_matrix_t<Dim, Real>& M, const StateVector<Dim, Real>& x) noexcept
 	{
-		StateVector<Dim> Result{ cplx_t::zero() };
+		StateVector<Dim, Real> Result{};
 
 		for (dimension_t i = 0; i < Dim; ++i)
 		{
@@ -140,14 +141,14 @@ namespace KetCat
 	/// tridiagonal structure of the system.
 	///
 	/// The matrix is passed by value and modified internally.
-	template<dimension_t Dim>
-	constexpr StateVector<Dim> solveTridiagonal(tridiagonal_matrix_t<Dim> M, StateVector<Dim> psi) noexcept
+	template<dimension_t Dim, precision_type Real>
+	constexpr StateVector<Dim, Real> solveTridiagonal(tridiagonal_matrix_t<Dim, Real> M, StateVector<Dim, Real> psi) noexcept
 	{
 		// --- FORWARD ELIMINATION ---
 		for (dimension_t i = 1; i < Dim; ++i)
 		{
 			// Elimination multiplier
-			const cplx_t w = M[SubDiagonal][i] / M[MainDiagonal][i - 1];
+			const complex_t<Real> w = M[SubDiagonal][i] / M[MainDiagonal][i - 1];
 
 			// Update main diagonal
 			M[MainDiagonal][i] = M[MainDiagonal][i] - w * M[SuperDiagonal][i - 1];
@@ -157,7 +158,7 @@ namespace KetCat
 		}
 
 		// --- BACK SUBSTITUTION ---
-		StateVector<Dim> Result{};
+		StateVector<Dim, Real> Result{};
 
 		Result[Dim - 1] = psi[Dim - 1] / M[MainDiagonal][Dim - 1];
 
@@ -180,12 +181,14 @@ namespace KetCat
 	///
 	///   CrankNicolsonTimeEvolutionOperator<Dim> evol(hamiltonian, dt);
 	///   psi = evol(psi);
-	template<dimension_t Dim>
+	///
+	/// The precision of the matrices and states follows the Hamiltonian's (`Real`).
+	template<dimension_t Dim, precision_type Real = float_t>
 	class CrankNicolsonSolver
 	{
 		// Precomputed matrices
-		tridiagonal_matrix_t<Dim> m_A;
-		tridiagonal_matrix_t<Dim> m_B;
+		tridiagonal_matrix_t<Dim, Real> m_A;
+		tridiagonal_matrix_t<Dim, Real> m_B;
 
 	public:
 		/// @brief  Constructs the time evolution operator.
@@ -195,7 +198,7 @@ namespace KetCat
 		/// @details
 		/// The constructor precomputes the Crank–Nicolson matrices A and B,
 		/// which are reused for each time step.
-		constexpr CrankNicolsonSolver(const Hamiltonian<Dim>& hamiltonian, float_t dt) noexcept
+		constexpr CrankNicolsonSolver(const Hamiltonian<Dim, Real>& hamiltonian, float_t dt) noexcept
 		{
 			buildCrankNicolsonMatrices(hamiltonian, dt, m_A, m_B);
 		}
@@ -207,8 +210,8 @@ namespace KetCat
 		/// @details
 		/// The function computes the right-hand side B · ψⁿ and then solves
 		/// the linear system A · ψⁿ⁺¹ = RHS, resulting in unitary time evolution.
-		constexpr StateVector<Dim>
-			operator()(const StateVector<Dim>& psi) const noexcept
+		constexpr StateVector<Dim, Real>
+			operator()(const StateVector<Dim, Real>& psi) const noexcept
 		{
 			// RHS = B · ψⁿ
 			auto rhs = multiplyTrigiagonal(m_B, psi);
@@ -0,0 +1,196 @@
+#pragma once
+#include <concepts>
+
+#include "core_types.h"
+#include "constexprmath/constexpr_trigon.h"
+#include "quantum_gate_solver.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Quantum Fourier transforms applied with a radix-2 FFT instead of a dense matrix.
+	///
+	/**
+	 * @details
+	 * `QuantumGate<K, Gates::make_IQFT_matrix<K>()>` applies the inverse QFT as a dense
+	 * 2^K × 2^K matrix: 4^K multiply-adds per block. The QFT of a register is the discrete
+	 * Fourier transform of its amplitudes (for every assignment of the other qubits), so it
+	 * can be computed with an FFT in K · 2^(K-1) butterflies per block instead.
+	 *
+	 * `InverseQFT<K>` and `QFT<K>` use the conventions of iqft_gate.h: bit q of the register
+	 * value is the q-th qubit given to `toBits`, and the inverse transform is
+	 * U[j][k] = exp(-2πi jk / 2^K) / sqrt(2^K). The twiddle factors are tabulated at
+	 * compile time, together with the bit-reversal permutation of the gather.
+	 */
+
+	/// @brief Twiddle factors exp(-2πi m / 2^QBitCount) for m < 2^(QBitCount-1) and the bit-reversal permutation.
+	template<dimension_t QBitCount>
+	struct FourierTwiddles
+	{
+		static constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		static constexpr std::array<cplx_t, (Dim > 1 ? Dim / 2 : 1)> Table = []
+		{
+			std::array<cplx_t, (Dim > 1 ? Dim / 2 : 1)> Twiddles{};
+			for (dimension_t m = 0; m < Twiddles.size(); ++m)
+			{
+				const float_t Angle = 2.0 * ConstexprMath::Pi * static_cast<float_t>(m) / static_cast<float_t>(Dim);
+				Twiddles[m] = cplx_t(ConstexprMath::cos(Angle), -ConstexprMath::sin(Angle));
+			}
+			return Twiddles;
+		}();
+
+		/// Bit-reversal permutation of the register value; gathering position i into slot
+		/// BitReversed[i] leaves the FFT output in natural order.
+		static constexpr std::array<dimension_t, Dim> BitReversed = []
+		{
+			std::array<dimension_t, Dim> Reversed{};
+			for (dimension_t i = 0; i < Dim; ++i)
+				for (dimension_t q = 0; q < QBitCount; ++q)
+					Reversed[i] |= ((i >> q) & 1) << (QBitCount - 1 - q);
+			return Reversed;
+		}();
+	};
+
+	/**
+	 * @brief     Apply the (inverse) quantum Fourier transform of a register in place to a range of a state.
+	 *
+	 * @tparam QBitCount   Number of qubits of the register.
+	 * @param state        The global state vector, updated in place.
+	 * @param affectedBits The global qubit indices; bit q of the register value is affectedBits[q].
+	 * @param inverse      True for the inverse QFT (exp(-2πi jk/N)), false for the QFT (exp(+2πi jk/N)).
+	 * @param firstIndex   First amplitude index of the processed range.
+	 * @param lastIndex    One past the last amplitude index of the processed range.
+	 *
+	 * Every block is gathered in bit-reversed order, transformed with an iterative radix-2
+	 * FFT and scattered back.
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount>
+	constexpr void applyFourierTransform(StateVector<StateCount>& state,
+		const qbit_list_t<QBitCount>& affectedBits, bool inverse,
+		dimension_t firstIndex = 0, dimension_t lastIndex = StateCount) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+		constexpr float_t Normalization = 1.0 / ConstexprMath::sqrt(static_cast<float_t>(Dim));
+		const auto& Twiddles = FourierTwiddles<QBitCount>::Table;
+		const auto& BitReversed = FourierTwiddles<QBitCount>::BitReversed;
+
+		const GateBlockIndexer<QBitCount> Indexer(affectedBits);
+		const dimension_t BlockCount = (lastIndex - firstIndex) / Dim;
+
+		// One scratch block for the whole range, reused by every block
+		state_vector_t<Dim> Local{};
+		for (dimension_t block = 0; block < BlockCount; ++block)
+		{
+			const dimension_t Base = firstIndex + Indexer.base(block);
+
+			for (dimension_t i = 0; i < Dim; ++i)
+				Local[BitReversed[i]] = state.m_StateVector[Base + Indexer.Offsets[i]];
+
+			for (dimension_t Half = 1; Half < Dim; Half *= 2)
+			{
+				const dimension_t Stride = Dim / (2 * Half);
+				for (dimension_t Start = 0; Start < Dim; Start += 2 * Half)
+					for (dimension_t m = 0; m < Half; ++m)
+					{
+						const cplx_t Twiddle = inverse ? Twiddles[m * Stride] : Twiddles[m * Stride].conj();
+						const cplx_t Even = Local[Start + m];
+						const cplx_t Odd = Twiddle * Local[Start + m + Half];
+						Local[Start + m] = Even + Odd;
+						Local[Start + m + Half] = Even - Odd;
+					}
+			}
+
+			for (dimension_t i = 0; i < Dim; ++i)
+				state.m_StateVector[Base + Indexer.Offsets[i]] = Local[i] * Normalization;
+		}
+	}
+
+	/**
+	 * @brief     Application of the (inverse) quantum Fourier transform to a specific register.
+	 *
+	 * @tparam QBitCount  Number of qubits of the register.
+	 * @tparam Inverse    True for the inverse QFT.
+	 */
+	template<dimension_t QBitCount, bool Inverse>
+	class FourierTransformOp
+	{
+		/// @brief Fixed-size list of qubit indices of the register.
+		const qbit_list_t<QBitCount> AffectedBits;
+
+	public:
+		/// @brief Construct an operation on the given register.
+		constexpr explicit FourierTransformOp(const qbit_list_t<QBitCount>& affectedBits) noexcept
+			: AffectedBits(affectedBits)
+		{
+		}
+
+		/// @brief Get the list of qubit indices of the register.
+		constexpr const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Get the bit mask of the qubits the transform acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return qbitMask(AffectedBits);
+		}
+
+		/// @brief Apply the transform in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			applyFourierTransform<QBitCount>(state, layout.map(AffectedBits), Inverse, firstIndex, lastIndex);
+		}
+
+		/// @brief Apply the transform in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyFourierTransform<QBitCount>(state, AffectedBits, Inverse);
+		}
+
+		/// @brief Apply the opposite transform in place to a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyFourierTransform<QBitCount>(state, AffectedBits, !Inverse);
+		}
+
+		/// @brief Apply the transform to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount>
+			operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+	};
+
+	/// @brief Factory for FFT-based quantum Fourier transforms.
+	/// @tparam QBitCount  Number of qubits of the register.
+	/// @tparam Inverse    True for the inverse QFT.
+	template<dimension_t QBitCount, bool Inverse>
+	struct FourierTransform
+	{
+		/// @brief Bind the transform to a register and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr FourierTransformOp<QBitCount, Inverse> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == QBitCount);
+			return FourierTransformOp<QBitCount, Inverse>(qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+
+	/// @brief FFT-based QFT; e.g. `QFT<3>().toBits(0, 1, 2)`.
+	template<dimension_t QBitCount>
+	using QFT = FourierTransform<QBitCount, false>;
+
+	/// @brief FFT-based inverse QFT, same as `QuantumGate<K, Gates::make_IQFT_matrix<K>()>`; e.g. `InverseQFT<3>().toBits(0, 1, 2)`.
+	template<dimension_t QBitCount>
+	using InverseQFT = FourierTransform<QBitCount, true>;
+}
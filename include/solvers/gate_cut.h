@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "core_types.h"
+#include "circuit_record.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Operator Schmidt decomposition of gates across a cut of the register.
+	///
+	/**
+	 * @details
+	 * Cut the register into a low half (qubits below `cut`) and a high half. A gate acting
+	 * on both halves is written as a sum of products U = Σ_s L_s ⊗ H_s, with L_s acting on
+	 * its low qubits only and H_s on its high qubits only. Each term is one branch of the
+	 * Schrödinger–Feynman path sum (see systems/schrodinger_feynman_executor.h).
+	 *
+	 * The decomposition expands U in matrix units of the low side, U = Σ_ij |i><j| ⊗ B_ij,
+	 * and orthonormalises the blocks B_ij (Gram–Schmidt in the Frobenius inner product):
+	 * the number of terms is then the operator Schmidt rank of U, e.g. 2 for CX, CZ and
+	 * ZZ/XX rotations, 4 for SWAP and iSWAP. Blocks below the record tolerance are dropped.
+	 *
+	 * Gates on one half only are a single term whose other factor is the empty record
+	 * (QBitCount 0), which applies as the identity.
+	 *
+	 * Records are as wide as the widest gate of the circuit (16 KiB each for 5 qubits), so
+	 * the terms and the scratch blocks of the decomposition are heap-allocated and sized to
+	 * the gate at hand: a 1-qubit gate keeps one record, not MaxCutTermCount pairs.
+	 */
+
+	/// @brief Maximum number of product terms of a gate on MaxQBitCount qubits: 4^floor(MaxQBitCount / 2).
+	template<dimension_t MaxQBitCount>
+	constexpr dimension_t MaxCutTermCount = ConstexprMath::pow2(2 * (MaxQBitCount / 2));
+
+	/// @brief A gate written as a sum of products of low-half and high-half factors.
+	/// @tparam MaxQBitCount  Width of the widest gate.
+	template<dimension_t MaxQBitCount>
+	struct CutGate
+	{
+		/// Low-half factors, on qubits below the cut (one per term).
+		std::vector<GateRecord<MaxQBitCount>> LowTerms = std::vector<GateRecord<MaxQBitCount>>(1);
+
+		/// High-half factors, on qubits counted from the cut (qubit cut + q is high qubit q).
+		std::vector<GateRecord<MaxQBitCount>> HighTerms = std::vector<GateRecord<MaxQBitCount>>(1);
+
+		/// Number of terms.
+		dimension_t TermCount = 1;
+	};
+
+	/**
+	 * @brief     Decompose a recorded gate across the cut.
+	 *
+	 * @tparam MaxQBitCount  Width of the record.
+	 * @param gate           The gate record.
+	 * @param cut            Number of qubits in the low half.
+	 * @return               The gate as Σ_s LowTerms[s] ⊗ HighTerms[s].
+	 */
+	template<dimension_t MaxQBitCount>
+	constexpr CutGate<MaxQBitCount> cutGate(const GateRecord<MaxQBitCount>& gate, dimension_t cut)
+	{
+		CutGate<MaxQBitCount> Cut{};
+		GateRecord<MaxQBitCount>& Low = Cut.LowTerms[0];
+		GateRecord<MaxQBitCount>& High = Cut.HighTerms[0];
+
+		// Local bits of each side, in the gate's local order
+		std::array<dimension_t, MaxQBitCount> LowLocal{}, HighLocal{};
+		for (dimension_t q = 0; q < gate.QBitCount; ++q)
+		{
+			if (gate.AffectedBits[q] < cut)
+			{
+				LowLocal[Low.QBitCount] = q;
+				Low.AffectedBits[Low.QBitCount++] = gate.AffectedBits[q];
+			}
+			else
+			{
+				HighLocal[High.QBitCount] = q;
+				High.AffectedBits[High.QBitCount++] = gate.AffectedBits[q] - cut;
+			}
+		}
+
+		if (Low.QBitCount == 0 || High.QBitCount == 0)
+		{
+			GateRecord<MaxQBitCount>& Side = (Low.QBitCount == 0) ? High : Low;
+			Side.Matrix = gate.Matrix;
+			Side.classify();
+			return Cut;
+		}
+
+		// Local index of the gate from a low-side and a high-side index
+		const auto compose = [&](dimension_t low, dimension_t high)
+			{
+				dimension_t Local = 0;
+				for (dimension_t q = 0; q < Low.QBitCount; ++q)
+					Local |= ((low >> q) & 1) << LowLocal[q];
+				for (dimension_t q = 0; q < High.QBitCount; ++q)
+					Local |= ((high >> q) & 1) << HighLocal[q];
+				return Local;
+			};
+
+		const dimension_t LowDim = Low.dim();
+		const dimension_t HighDim = High.dim();
+		const qbit_list_t<MaxQBitCount> LowBits = Low.AffectedBits;
+		const qbit_list_t<MaxQBitCount> HighBits = High.AffectedBits;
+		const dimension_t LowQBitCount = Low.QBitCount;
+		const dimension_t HighQBitCount = High.QBitCount;
+
+		// Orthonormal basis Q_s of the blocks B_ij, and the coefficients ⟨Q_s, B_ij⟩ as low factors;
+		// the rank is at most min(LowDim², HighDim²), blocks are HighDim × HighDim, row-major
+		const dimension_t BlockSize = HighDim * HighDim;
+		const dimension_t TermBound = std::min({ LowDim * LowDim, BlockSize, MaxCutTermCount<MaxQBitCount> });
+		std::vector<cplx_t> Basis(TermBound * BlockSize);
+		std::vector<cplx_t> Coefficients(TermBound * LowDim * LowDim);
+		std::vector<cplx_t> Block(BlockSize);
+		dimension_t Rank = 0;
+		for (dimension_t i = 0; i < LowDim; ++i)
+			for (dimension_t j = 0; j < LowDim; ++j)
+			{
+				for (dimension_t k = 0; k < HighDim; ++k)
+					for (dimension_t l = 0; l < HighDim; ++l)
+						Block[k * HighDim + l] = gate.Matrix[compose(i, k)][compose(j, l)];
+
+				for (dimension_t s = 0; s < Rank; ++s)
+				{
+					const cplx_t* Q = Basis.data() + s * BlockSize;
+
+					cplx_t Projection{};
+					for (dimension_t e = 0; e < BlockSize; ++e)
+						Projection += Q[e].conj() * Block[e];
+
+					Coefficients[(s * LowDim + i) * LowDim + j] = Projection;
+					for (dimension_t e = 0; e < BlockSize; ++e)
+						Block[e] = Block[e] - Projection * Q[e];
+				}
+
+				float_t NormSquared = 0.0;
+				for (dimension_t e = 0; e < BlockSize; ++e)
+					NormSquared += Block[e].normSquared();
+				if (NormSquared <= RecordTolerance * RecordTolerance || Rank == TermBound)
+					continue;
+
+				const float_t Norm = ConstexprMath::sqrt(NormSquared);
+				for (dimension_t e = 0; e < BlockSize; ++e)
+					Basis[Rank * BlockSize + e] = Block[e] / Norm;
+				Coefficients[(Rank * LowDim + i) * LowDim + j] = cplx_t::fromReal(Norm);
+				++Rank;
+			}
+
+		Cut.TermCount = Rank;
+		Cut.LowTerms.assign(Rank, GateRecord<MaxQBitCount>{});
+		Cut.HighTerms.assign(Rank, GateRecord<MaxQBitCount>{});
+		for (dimension_t s = 0; s < Rank; ++s)
+		{
+			GateRecord<MaxQBitCount>& LowTerm = Cut.LowTerms[s];
+			LowTerm.QBitCount = LowQBitCount;
+			LowTerm.AffectedBits = LowBits;
+			for (dimension_t i = 0; i < LowDim; ++i)
+				for (dimension_t j = 0; j < LowDim; ++j)
+					LowTerm.Matrix[i][j] = Coefficients[(s * LowDim + i) * LowDim + j];
+			LowTerm.classify();
+
+			GateRecord<MaxQBitCount>& HighTerm = Cut.HighTerms[s];
+			HighTerm.QBitCount = HighQBitCount;
+			HighTerm.AffectedBits = HighBits;
+			for (dimension_t k = 0; k < HighDim; ++k)
+				for (dimension_t l = 0; l < HighDim; ++l)
+					HighTerm.Matrix[k][l] = Basis[s * BlockSize + k * HighDim + l];
+			HighTerm.classify();
+
+			// The Schmidt factors are not unitary: keep them off the amplitude-moving kernel
+			LowTerm.IsPhasePermutation = false;
+			HighTerm.IsPhasePermutation = false;
+		}
+		return Cut;
+	}
+}
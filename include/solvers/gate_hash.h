@@ -0,0 +1,192 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+
+#include "core_types.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Structural hashing of gate sequences, used to recognise previously executed circuit prefixes.
+	///
+	/**
+	 * @details
+	 * The hash of a gate covers what determines its action on a state: the number of qubits it
+	 * acts on, the qubit indices in order, and the exact bit pattern of every matrix entry
+	 * (negative zero is folded into zero). Two gates built by different factories but with the
+	 * same matrix and qubits therefore hash identically, which is the desired behaviour for a
+	 * result cache. Prefix hashes are chained, so the hash of the first g gates is available for
+	 * every g in a single pass.
+	 *
+	 * Every prefix also gets a second, independent 64-bit hash of the same data (a
+	 * multiply-xorshift mix instead of FNV-1a, from a different seed). The first hash is the
+	 * lookup key; the second is stored with the cached state and compared on every hit, so a
+	 * wrong state is only returned if both hashes collide at once.
+	 *
+	 * Gates that do not expose their matrix (arbitrary callables) cannot be hashed; the hashable
+	 * prefix of a sequence ends at the first such gate.
+	 */
+
+	/// @brief 64-bit structural hash value.
+	using gate_hash_t = std::uint64_t;
+
+	/// @brief Concept for gates whose structure is fully described by their matrix and affected qubits.
+	template<typename GateType>
+	concept HashableGate =
+		requires(const GateType g)
+	{
+		g.getGateMatrix();
+		g.getAffectedBits();
+	};
+
+	namespace Detail
+	{
+		/// @brief FNV-1a offset basis and prime (64 bit).
+		constexpr gate_hash_t FnvOffsetBasis = 14695981039346656037ULL;
+		constexpr gate_hash_t FnvPrime = 1099511628211ULL;
+
+		/// @brief Mix the eight bytes of a 64-bit word into an FNV-1a hash.
+		constexpr gate_hash_t hashCombine(gate_hash_t hash, std::uint64_t word) noexcept
+		{
+			for (dimension_t i = 0; i < 8; ++i)
+			{
+				hash ^= (word >> (8 * i)) & 0xFF;
+				hash *= FnvPrime;
+			}
+			return hash;
+		}
+
+		/// @brief Mix the bit pattern of a floating-point value (with -0.0 folded into 0.0).
+		constexpr gate_hash_t hashCombine(gate_hash_t hash, float_t value) noexcept
+		{
+			return hashCombine(hash, std::bit_cast<std::uint64_t>(value + 0.0));
+		}
+
+		/// @brief Seed of the verification hash.
+		constexpr gate_hash_t CheckSeed = 0x9E3779B97F4A7C15ULL;
+
+		/// @brief Mix a 64-bit word into the verification hash (the MurmurHash3 finaliser over a rotated sum).
+		constexpr gate_hash_t checkCombine(gate_hash_t hash, std::uint64_t word) noexcept
+		{
+			hash = std::rotl(hash, 27) + word * 0x87C37B91114253D5ULL;
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDULL;
+			hash ^= hash >> 33;
+			hash *= 0xC4CEB9FE1A85EC53ULL;
+			hash ^= hash >> 33;
+			return hash;
+		}
+
+		/// @brief Mix the bit pattern of a floating-point value into the verification hash.
+		constexpr gate_hash_t checkCombine(gate_hash_t hash, float_t value) noexcept
+		{
+			return checkCombine(hash, std::bit_cast<std::uint64_t>(value + 0.0));
+		}
+
+		/// @brief Mix the structure of a gate into a hash with the given combine function.
+		template<HashableGate GateType, typename Combine>
+		constexpr gate_hash_t combineGate(gate_hash_t hash, const GateType& gate, const Combine& combine) noexcept
+		{
+			const auto& AffectedBits = gate.getAffectedBits();
+
+			hash = combine(hash, std::uint64_t{ AffectedBits.size() });
+			for (dimension_t q : AffectedBits)
+				hash = combine(hash, std::uint64_t{ q });
+
+			for (const auto& Row : gate.getGateMatrix())
+			{
+				for (const cplx_t& Element : Row)
+				{
+					hash = combine(hash, Element.re);
+					hash = combine(hash, Element.im);
+				}
+			}
+			return hash;
+		}
+	}
+
+	/// @brief Hash of the empty gate sequence on a register of the given size.
+	template<dimension_t QBitCount>
+	constexpr gate_hash_t emptyCircuitHash() noexcept
+	{
+		return Detail::hashCombine(Detail::FnvOffsetBasis, std::uint64_t{ QBitCount });
+	}
+
+	/// @brief Verification hash of the empty gate sequence on a register of the given size.
+	template<dimension_t QBitCount>
+	constexpr gate_hash_t emptyCircuitCheck() noexcept
+	{
+		return Detail::checkCombine(Detail::CheckSeed, std::uint64_t{ QBitCount });
+	}
+
+	/**
+	 * @brief     Extend the hash of a gate sequence by one gate.
+	 *
+	 * @param prefixHash  Hash of the sequence preceding the gate.
+	 * @param gate        The appended gate.
+	 * @return            Hash of the extended sequence.
+	 */
+	template<HashableGate GateType>
+	constexpr gate_hash_t appendGateHash(gate_hash_t prefixHash, const GateType& gate) noexcept
+	{
+		return Detail::combineGate(prefixHash, gate, [](gate_hash_t hash, auto word) { return Detail::hashCombine(hash, word); });
+	}
+
+	/// @brief Extend the verification hash of a gate sequence by one gate.
+	template<HashableGate GateType>
+	constexpr gate_hash_t appendGateCheck(gate_hash_t prefixCheck, const GateType& gate) noexcept
+	{
+		return Detail::combineGate(prefixCheck, gate, [](gate_hash_t hash, auto word) { return Detail::checkCombine(hash, word); });
+	}
+
+	/// @brief Prefix hashes of a gate sequence and the length of its hashable prefix.
+	/// @tparam GateCount  Number of gates in the sequence.
+	template<dimension_t GateCount>
+	struct CircuitPrefixHashes
+	{
+		/// @brief Hashes[g] is the hash of the first g gates (valid for g <= HashableLength).
+		std::array<gate_hash_t, GateCount + 1> Hashes{};
+
+		/// @brief Checks[g] is the independent verification hash of the first g gates.
+		std::array<gate_hash_t, GateCount + 1> Checks{};
+
+		/// @brief Number of leading gates that could be hashed.
+		dimension_t HashableLength = 0;
+	};
+
+	/**
+	 * @brief     Compute the chained hashes of every prefix of a gate sequence.
+	 *
+	 * @tparam QBitCount  Number of qubits of the register the circuit runs on.
+	 * @param gates       The gates, in order.
+	 * @return            The prefix hashes and verification hashes; hashing stops at the first
+	 *                    gate that is not `HashableGate`.
+	 */
+	template<dimension_t QBitCount, typename... Gates>
+	constexpr CircuitPrefixHashes<sizeof...(Gates)> circuitPrefixHashes(const Gates&... gates) noexcept
+	{
+		CircuitPrefixHashes<sizeof...(Gates)> Result{};
+		Result.Hashes[0] = emptyCircuitHash<QBitCount>();
+		Result.Checks[0] = emptyCircuitCheck<QBitCount>();
+
+		bool Hashable = true;
+		([&]
+			{
+				if constexpr (HashableGate<Gates>)
+				{
+					if (Hashable)
+					{
+						Result.Hashes[Result.HashableLength + 1] = appendGateHash(Result.Hashes[Result.HashableLength], gates);
+						Result.Checks[Result.HashableLength + 1] = appendGateCheck(Result.Checks[Result.HashableLength], gates);
+						++Result.HashableLength;
+					}
+				}
+				else
+				{
+					Hashable = false;
+				}
+			}(), ...);
+
+		return Result;
+	}
+}
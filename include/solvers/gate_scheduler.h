@@ -0,0 +1,428 @@
+#pragma once
+#include <concepts>
+#include <bit>
+#include <cstddef>
+
+#include "core_types.h"
+#include "wavefunction/state_vector.h"
+#include "qubit_layout.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Scheduling stage that decides how a gate sequence is streamed through memory.
+    ///
+    /**
+     * @details
+     * Applying a gate one after another means streaming the whole state vector through
+     * the memory hierarchy once per gate. Gates whose support lies entirely below qubit
+     * `TileQBitCount` never mix amplitudes of different 2^TileQBitCount-sized chunks,
+     * so a run of such gates can be applied chunk by chunk: every gate of the run is
+     * applied to one cache-resident tile before moving on to the next one.
+     *
+     * Gates on high qubits are brought into the tile by qubit remapping: when a run of
+     * upcoming gates keeps hitting high qubits, the scheduler plans a global bit-permutation
+     * pass (see `QubitLayout`) that moves the hot qubits into the low physical positions,
+     * as long as the sweeps saved outweigh the cost of the permutation.
+     *
+     * This header provides:
+     *  - `BlockableGate` : concept for gates that expose their support and an in-place range kernel.
+     *  - `buildCacheBlockSchedule` : partition a gate sequence (given by support masks) into blocks
+     *    and choose the qubit layout every block runs in.
+     *  - `executeCacheBlocked` : execute a gate pack in place following that schedule.
+     *  - `executeCacheBlockedRange` : the same for a contiguous sub-range of the pack.
+     *  - `executeCacheBlockedSequence` : the same for a runtime range of an array of gates of one type.
+     */
+
+    /// @brief Default tile size in qubits: 2^14 amplitudes × 16 bytes = 256 KiB, an L2-sized chunk.
+    constexpr dimension_t CacheTileQBitCount = 14;
+
+    /// @brief Number of upcoming gates inspected when deciding on a qubit remapping.
+    constexpr dimension_t RemapLookaheadWindow = 64;
+
+    /// @brief Cost of a remapping in state sweeps: the permutation pass and the later restore.
+    constexpr dimension_t RemapSweepCost = 2;
+
+    /// @brief Concept for gates that can be applied in place to a contiguous, closed range of the state.
+    ///
+    /// Every gate type providing this range kernel (`QuantumGateOp`, recorded gates, permutation,
+    /// phase-oracle, Pauli-rotation, QFT and phase-estimation ops, sub-circuits) takes part in
+    /// cache-blocked scheduling and follows qubit remapping through the layout it is given.
+    /// @tparam GateType    Type to test.
+    /// @tparam StateCount  Dimension of the global state vector.
+    template<typename GateType, dimension_t StateCount>
+    concept BlockableGate =
+        requires(const GateType g, StateVector<StateCount>& state)
+    {
+        { g.getAffectedMask() } -> std::convertible_to<dimension_t>;
+        g.applyInPlace(state, QubitLayout<QBitCountOf<StateCount>>{}, dimension_t{}, dimension_t{});
+    };
+
+    /// @brief Support mask of a gate; gates not exposing one are treated as touching every qubit.
+    template<dimension_t StateCount, typename GateType>
+    constexpr dimension_t gateSupportMask(const GateType& gate) noexcept
+    {
+        if constexpr (BlockableGate<GateType, StateCount>)
+            return gate.getAffectedMask();
+        else
+            return ~dimension_t(0);
+    }
+
+    /// @brief Apply a gate in place to the range [firstIndex, lastIndex) of the state.
+    ///
+    /// Gates that are not blockable are only ever scheduled on the full range with the
+    /// identity layout and are applied through their functional-style call operator.
+    template<dimension_t StateCount, typename GateType>
+    constexpr void applyGateToRange(StateVector<StateCount>& state, const GateType& gate,
+        const QubitLayout<QBitCountOf<StateCount>>& layout,
+        dimension_t firstIndex, dimension_t lastIndex)
+    {
+        if constexpr (BlockableGate<GateType, StateCount>)
+            gate.applyInPlace(state, layout, firstIndex, lastIndex);
+        else
+            state = gate(state);
+    }
+
+    /// @brief Invoke `fn` on every gate of the pack whose position lies in [begin, end).
+    template<typename Fn, typename... Gates>
+    constexpr void forEachGateInRange(dimension_t begin, dimension_t end, Fn&& fn, const Gates&... gates)
+    {
+        dimension_t Index = 0;
+        ((Index >= begin && Index < end ? fn(gates) : void(), ++Index), ...);
+    }
+
+    /// @brief A run of consecutive gates [FirstGate, LastGate) executed together.
+    struct GateBlock
+    {
+        dimension_t FirstGate = 0;
+        dimension_t LastGate = 0;
+
+        /// True if the block is applied tile by tile, false if its single gate sweeps the whole state.
+        bool CacheBlocked = false;
+    };
+
+    /// @brief Partition of a gate sequence into blocks, together with the layout of every block.
+    /// @tparam QBitCount  Number of qubits of the state the schedule runs on.
+    /// @tparam GateCount  Number of gates in the scheduled sequence (upper bound of the block count).
+    template<dimension_t QBitCount, dimension_t GateCount>
+    struct CacheBlockSchedule
+    {
+        std::array<GateBlock, GateCount> Blocks{};
+        std::array<QubitLayout<QBitCount>, GateCount> Layouts{};
+        dimension_t BlockCount = 0;
+
+        /// @brief Number of global bit-permutation passes, including the final restore of logical order.
+        constexpr dimension_t permutationCount() const noexcept
+        {
+            dimension_t Count = 0;
+            QubitLayout<QBitCount> Current{};
+            for (dimension_t b = 0; b < BlockCount; ++b)
+            {
+                if (Layouts[b] != Current)
+                    ++Count;
+                Current = Layouts[b];
+            }
+            return Count + (Current.isIdentity() ? 0 : 1);
+        }
+
+        /// @brief Number of full passes over the state vector the schedule needs.
+        /// A bit-permutation pass takes up to two sweeps of amplitude swaps (see `permuteQubits`).
+        constexpr dimension_t sweepCount() const noexcept
+        {
+            return BlockCount + 2 * permutationCount();
+        }
+    };
+
+    namespace Detail
+    {
+        /// @brief Effective tile size for a state of the given dimension.
+        template<dimension_t TileQBitCount, dimension_t StateCount>
+        constexpr dimension_t TileSize =
+            (ConstexprMath::pow2(TileQBitCount) < StateCount) ? ConstexprMath::pow2(TileQBitCount) : StateCount;
+
+        /// @brief True if the gate can never be blocked (opaque gates report an all-ones mask).
+        template<dimension_t StateCount>
+        constexpr bool isOpaqueMask(dimension_t mask) noexcept
+        {
+            return mask >= StateCount;
+        }
+
+        /// @brief Number of blocks the greedy partition needs for gates [first, last) in a fixed layout.
+        template<dimension_t TileQBitCount, dimension_t StateCount, dimension_t GateCount>
+        constexpr dimension_t countBlocks(const std::array<dimension_t, GateCount>& supportMasks,
+            const QubitLayout<QBitCountOf<StateCount>>& layout, dimension_t first, dimension_t last) noexcept
+        {
+            constexpr dimension_t Tile = TileSize<TileQBitCount, StateCount>;
+
+            dimension_t Count = 0;
+            bool InBlock = false;
+            for (dimension_t g = first; g < last; ++g)
+            {
+                const bool Fits = layout.mapMask(supportMasks[g]) < Tile;
+                if (!Fits || !InBlock)
+                    ++Count;
+                InBlock = Fits;
+            }
+            return Count;
+        }
+
+        /**
+         * @brief Choose a layout that moves the qubits used most by the upcoming gates into the tile.
+         *
+         * The qubits of gate `first` are always included; the remaining tile slots are filled
+         * by usage count within the look-ahead window. Hot qubits that already sit inside the
+         * tile keep their position, the others swap places with cold qubits of the tile, so
+         * the permutation moves as few bits as possible.
+         */
+        template<dimension_t TileQBitCount, dimension_t StateCount, dimension_t GateCount>
+        constexpr QubitLayout<QBitCountOf<StateCount>> hotLayout(const std::array<dimension_t, GateCount>& supportMasks,
+            const QubitLayout<QBitCountOf<StateCount>>& current, dimension_t first, dimension_t last) noexcept
+        {
+            constexpr dimension_t QBitCount = QBitCountOf<StateCount>;
+            constexpr dimension_t TileQBits = (TileQBitCount < QBitCount) ? TileQBitCount : QBitCount;
+
+            // Usage count of every logical qubit in the window
+            std::array<dimension_t, QBitCount> Usage{};
+            for (dimension_t g = first; g < last; ++g)
+            {
+                for (dimension_t q = 0; q < QBitCount; ++q)
+                {
+                    if (supportMasks[g] & (dimension_t(1) << q))
+                        ++Usage[q];
+                }
+            }
+
+            // Select the hot set: the current gate first, then by decreasing usage
+            dimension_t HotMask = supportMasks[first];
+            dimension_t HotCount = static_cast<dimension_t>(std::popcount(HotMask));
+            while (HotCount < TileQBits)
+            {
+                dimension_t Best = QBitCount;
+                for (dimension_t q = 0; q < QBitCount; ++q)
+                {
+                    if ((HotMask & (dimension_t(1) << q)) || Usage[q] == 0)
+                        continue;
+                    if (Best == QBitCount || Usage[q] > Usage[Best])
+                        Best = q;
+                }
+                if (Best == QBitCount)
+                    break;
+                HotMask |= (dimension_t(1) << Best);
+                ++HotCount;
+            }
+
+            // Swap hot qubits outside the tile with cold qubits inside the tile
+            QubitLayout<QBitCountOf<StateCount>> Layout = current;
+            for (dimension_t hot = 0; hot < QBitCount; ++hot)
+            {
+                if (!(HotMask & (dimension_t(1) << hot)) || Layout.LogicalToPhysical[hot] < TileQBits)
+                    continue;
+
+                for (dimension_t cold = 0; cold < QBitCount; ++cold)
+                {
+                    if ((HotMask & (dimension_t(1) << cold)) || Layout.LogicalToPhysical[cold] >= TileQBits)
+                        continue;
+
+                    const dimension_t Tmp = Layout.LogicalToPhysical[hot];
+                    Layout.LogicalToPhysical[hot] = Layout.LogicalToPhysical[cold];
+                    Layout.LogicalToPhysical[cold] = Tmp;
+                    break;
+                }
+            }
+
+            return Layout;
+        }
+    }
+
+    /**
+     * @brief     Partition a gate sequence into cache blocks and plan qubit remappings.
+     *
+     * @tparam TileQBitCount  Number of low qubits spanned by one cache tile.
+     * @tparam StateCount     Dimension of the global state vector.
+     * @tparam GateCount      Number of gates.
+     * @param supportMasks    Logical support mask of every gate, in execution order
+     *                        (all-ones for gates that cannot be blocked).
+     * @param firstGate       First gate to schedule.
+     * @param lastGate        One past the last gate to schedule.
+     * @return                The schedule: maximal runs of gates supported inside one tile
+     *                        are grouped into a single blocked pass; any other gate gets a
+     *                        pass of its own. Each block records the layout it runs in.
+     *
+     * When a gate falls outside the tile, the scheduler evaluates a layout that brings the
+     * hot qubits of the next `RemapLookaheadWindow` gates into the tile, and switches to it
+     * if the sweeps it saves in that window exceed `RemapSweepCost`. Opaque gates always run
+     * in the identity layout. If the whole state fits into one tile, every gate is "low",
+     * no remapping happens and the whole sequence forms a single in-place block.
+     */
+    template<dimension_t TileQBitCount, dimension_t StateCount, dimension_t GateCount>
+    constexpr CacheBlockSchedule<QBitCountOf<StateCount>, GateCount>
+        buildCacheBlockSchedule(const std::array<dimension_t, GateCount>& supportMasks,
+            dimension_t firstGate = 0, dimension_t lastGate = GateCount) noexcept
+    {
+        constexpr dimension_t Tile = Detail::TileSize<TileQBitCount, StateCount>;
+        constexpr dimension_t TileQBits = static_cast<dimension_t>(std::bit_width(Tile) - 1);
+
+        CacheBlockSchedule<QBitCountOf<StateCount>, GateCount> Schedule{};
+        QubitLayout<QBitCountOf<StateCount>> Layout{};
+
+        dimension_t Gate = firstGate;
+        while (Gate < lastGate)
+        {
+            const dimension_t Mask = supportMasks[Gate];
+
+            if (Detail::isOpaqueMask<StateCount>(Mask))
+            {
+                // Opaque gates only understand logical order
+                Layout = QubitLayout<QBitCountOf<StateCount>>{};
+            }
+            else if (Layout.mapMask(Mask) >= Tile && static_cast<dimension_t>(std::popcount(Mask)) <= TileQBits)
+            {
+                // Look ahead until the window ends or an opaque gate forces logical order again
+                dimension_t WindowEnd = Gate;
+                while (WindowEnd < lastGate && WindowEnd - Gate < RemapLookaheadWindow
+                    && !Detail::isOpaqueMask<StateCount>(supportMasks[WindowEnd]))
+                    ++WindowEnd;
+
+                const QubitLayout<QBitCountOf<StateCount>> Candidate =
+                    Detail::hotLayout<TileQBitCount, StateCount>(supportMasks, Layout, Gate, WindowEnd);
+
+                const dimension_t SweepsKept =
+                    Detail::countBlocks<TileQBitCount, StateCount>(supportMasks, Layout, Gate, WindowEnd);
+                const dimension_t SweepsRemapped = RemapSweepCost +
+                    Detail::countBlocks<TileQBitCount, StateCount>(supportMasks, Candidate, Gate, WindowEnd);
+
+                if (SweepsRemapped < SweepsKept)
+                    Layout = Candidate;
+            }
+
+            GateBlock Block{ Gate, Gate + 1, false };
+
+            // Extend the block as long as every gate stays inside one tile
+            if (Layout.mapMask(Mask) < Tile)
+            {
+                Block.CacheBlocked = true;
+                while (Block.LastGate < lastGate && Layout.mapMask(supportMasks[Block.LastGate]) < Tile)
+                    ++Block.LastGate;
+            }
+
+            Schedule.Layouts[Schedule.BlockCount] = Layout;
+            Schedule.Blocks[Schedule.BlockCount++] = Block;
+            Gate = Block.LastGate;
+        }
+
+        return Schedule;
+    }
+
+    namespace Detail
+    {
+        /// @brief Run a cache-block schedule; `forEachGate(first, last, fn)` invokes fn on the gates [first, last).
+        template<dimension_t TileQBitCount, dimension_t StateCount, dimension_t GateCount, typename ForEachGate>
+        constexpr void runCacheBlockSchedule(StateVector<StateCount>& state,
+            const CacheBlockSchedule<QBitCountOf<StateCount>, GateCount>& schedule, ForEachGate&& forEachGate)
+        {
+            constexpr dimension_t Tile = TileSize<TileQBitCount, StateCount>;
+
+            QubitLayout<QBitCountOf<StateCount>> Layout{};
+
+            for (dimension_t b = 0; b < schedule.BlockCount; ++b)
+            {
+                const GateBlock& Block = schedule.Blocks[b];
+
+                // Transpose into the layout planned for this block
+                if (schedule.Layouts[b] != Layout)
+                {
+                    permuteQubits(state, Layout, schedule.Layouts[b]);
+                    Layout = schedule.Layouts[b];
+                }
+
+                if (!Block.CacheBlocked)
+                {
+                    // A single gate reaching outside the tile: one full sweep
+                    forEachGate(Block.FirstGate, Block.LastGate,
+                        [&](const auto& gate) { applyGateToRange(state, gate, Layout, 0, StateCount); });
+                    continue;
+                }
+
+                // Apply all gates of the block to one tile before moving on to the next one
+                for (dimension_t tile = 0; tile < StateCount; tile += Tile)
+                {
+                    forEachGate(Block.FirstGate, Block.LastGate,
+                        [&](const auto& gate) { applyGateToRange(state, gate, Layout, tile, tile + Tile); });
+                }
+            }
+
+            // Hand the state back in logical order
+            permuteQubits(state, Layout, QubitLayout<QBitCountOf<StateCount>>{});
+        }
+    }
+
+    /**
+     * @brief     Execute a gate pack in place using the cache-blocked schedule.
+     *
+     * @tparam TileQBitCount  Number of low qubits spanned by one cache tile.
+     * @tparam StateCount     Dimension of the global state vector.
+     * @tparam Gates          Gate-like callables; blockable gates are applied tile by tile.
+     * @param state           The global state vector, updated in place. It is in logical
+     *                        qubit order on entry and on return.
+     * @param firstGate       Position of the first gate of the pack to apply.
+     * @param lastGate        One past the position of the last gate of the pack to apply.
+     * @param gates           The gates, in order.
+     */
+    template<dimension_t TileQBitCount = CacheTileQBitCount, dimension_t StateCount, typename... Gates>
+    constexpr void executeCacheBlockedRange(StateVector<StateCount>& state,
+        dimension_t firstGate, dimension_t lastGate, const Gates&... gates)
+    {
+        constexpr dimension_t GateCount = sizeof...(Gates);
+
+        if constexpr (GateCount > 0)
+        {
+            const std::array<dimension_t, GateCount> SupportMasks{ gateSupportMask<StateCount>(gates)... };
+
+            Detail::runCacheBlockSchedule<TileQBitCount>(state,
+                buildCacheBlockSchedule<TileQBitCount, StateCount>(SupportMasks, firstGate, lastGate),
+                [&](dimension_t first, dimension_t last, auto&& fn) { forEachGateInRange(first, last, fn, gates...); });
+        }
+    }
+
+    /**
+     * @brief     Execute the entries [firstGate, lastGate) of a homogeneous gate array using the cache-blocked schedule.
+     *
+     * @tparam TileQBitCount  Number of low qubits spanned by one cache tile.
+     * @param state           The global state vector, updated in place (logical order on entry and return).
+     * @param gates           Gate storage, e.g. the records of a `CircuitRecord`.
+     * @param firstGate       First entry of `gates` to apply.
+     * @param lastGate        One past the last entry of `gates` to apply.
+     */
+    template<dimension_t TileQBitCount = CacheTileQBitCount, dimension_t StateCount, typename GateType, dimension_t Capacity>
+    constexpr void executeCacheBlockedSequence(StateVector<StateCount>& state,
+        const std::array<GateType, Capacity>& gates, dimension_t firstGate, dimension_t lastGate)
+    {
+        if constexpr (Capacity > 0)
+        {
+            std::array<dimension_t, Capacity> SupportMasks{};
+            for (dimension_t g = firstGate; g < lastGate; ++g)
+                SupportMasks[g] = gateSupportMask<StateCount>(gates[g]);
+
+            Detail::runCacheBlockSchedule<TileQBitCount>(state,
+                buildCacheBlockSchedule<TileQBitCount, StateCount>(SupportMasks, firstGate, lastGate),
+                [&](dimension_t first, dimension_t last, auto&& fn)
+                {
+                    for (dimension_t g = first; g < last; ++g)
+                        fn(gates[g]);
+                });
+        }
+    }
+
+    /**
+     * @brief     Execute a gate pack in place using the cache-blocked schedule.
+     *
+     * @tparam TileQBitCount  Number of low qubits spanned by one cache tile.
+     * @param state           The global state vector, updated in place (logical order on entry and return).
+     * @param gates           The gates to apply, in order.
+     */
+    template<dimension_t TileQBitCount = CacheTileQBitCount, dimension_t StateCount, typename... Gates>
+    constexpr void executeCacheBlocked(StateVector<StateCount>& state, const Gates&... gates)
+    {
+        executeCacheBlockedRange<TileQBitCount>(state, 0, sizeof...(Gates), gates...);
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <bit>
+
+#include "core_types.h"
+#include "circuit_record.h"
+#include "wavefunction/hamming_weight_state_vector.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Gate kernels working directly on fixed-Hamming-weight subspace states.
+	///
+	/**
+	 * @details
+	 * A gate preserves the Hamming weight exactly when its matrix only connects local basis
+	 * states with the same number of set bits, i.e. it is block diagonal over the local weight
+	 * sectors. `conservesHammingWeight` checks that on the gate's recorded matrix; gates
+	 * failing the check cannot run in the subspace.
+	 *
+	 * Kernels, on the recorded form of a gate (see circuit_record.h):
+	 *  - diagonal gates (phases, CZ, ZZ rotations) scale every amplitude by the diagonal
+	 *    entry of its local pattern, in one pass over the ranks;
+	 *  - other conserving gates (SWAP, iSWAP, Givens rotations, fSim) mix amplitudes within a
+	 *    weight sector: the subspace states sharing all bits outside the gate form a group, the
+	 *    group is visited once from its lowest member, and the sector block of the matrix is
+	 *    applied to the group's amplitudes.
+	 */
+
+	/// @brief True if the recorded gate only couples local basis states of equal Hamming weight.
+	template<dimension_t MaxQBitCount>
+	constexpr bool conservesHammingWeight(const GateRecord<MaxQBitCount>& gate) noexcept
+	{
+		for (dimension_t i = 0; i < gate.dim(); ++i)
+			for (dimension_t j = 0; j < gate.dim(); ++j)
+			{
+				if (std::popcount(i) != std::popcount(j) && !isNegligible(gate.Matrix[i][j]))
+					return false;
+			}
+		return true;
+	}
+
+	/**
+	 * @brief     Apply a Hamming-weight conserving recorded gate in place to a subspace state.
+	 *
+	 * @tparam QBitCount  Number of qubits.
+	 * @tparam Weight     Hamming weight of the subspace.
+	 * @param state       The subspace state.
+	 * @param gate        The gate record; must satisfy `conservesHammingWeight`.
+	 */
+	template<dimension_t QBitCount, dimension_t Weight, dimension_t MaxQBitCount>
+	constexpr void applyHammingWeightGate(HammingWeightStateVector<QBitCount, Weight>& state,
+		const GateRecord<MaxQBitCount>& gate) noexcept
+	{
+		using SubspaceState = HammingWeightStateVector<QBitCount, Weight>;
+		constexpr dimension_t MaxDim = ConstexprMath::pow2(MaxQBitCount);
+
+		const auto localPatternOf = [&](dimension_t basisIndex)
+			{
+				dimension_t Local = 0;
+				for (dimension_t q = 0; q < gate.QBitCount; ++q)
+					Local |= ((basisIndex >> gate.AffectedBits[q]) & 1) << q;
+				return Local;
+			};
+		const auto scatter = [&](dimension_t local)
+			{
+				dimension_t Global = 0;
+				for (dimension_t q = 0; q < gate.QBitCount; ++q)
+					Global |= ((local >> q) & 1) << gate.AffectedBits[q];
+				return Global;
+			};
+
+		if (gate.IsDiagonal)
+		{
+			for (dimension_t r = 0; r < SubspaceState::SubspaceDim; ++r)
+			{
+				const dimension_t Local = localPatternOf(SubspaceState::basisIndexOf(r));
+				state.m_Amplitudes[r] = gate.Matrix[Local][Local] * state.m_Amplitudes[r];
+			}
+			return;
+		}
+
+		const dimension_t Support = gate.getAffectedMask();
+		for (dimension_t r = 0; r < SubspaceState::SubspaceDim; ++r)
+		{
+			const dimension_t BasisIndex = SubspaceState::basisIndexOf(r);
+			const dimension_t Local = localPatternOf(BasisIndex);
+			const dimension_t SectorWeight = static_cast<dimension_t>(std::popcount(Local));
+
+			// Visit every group once, from its member with the lowest local pattern
+			if (Local != ConstexprMath::pow2(SectorWeight) - 1)
+				continue;
+
+			// The sector: local patterns of weight SectorWeight, and the ranks of their group members
+			std::array<dimension_t, MaxDim> Patterns{};
+			std::array<dimension_t, MaxDim> Ranks{};
+			std::array<cplx_t, MaxDim> Amplitudes{};
+			dimension_t SectorDim = 0;
+			const dimension_t Rest = BasisIndex & ~Support;
+			for (dimension_t Pattern = 0; Pattern < gate.dim(); ++Pattern)
+			{
+				if (static_cast<dimension_t>(std::popcount(Pattern)) != SectorWeight)
+					continue;
+
+				Patterns[SectorDim] = Pattern;
+				Ranks[SectorDim] = SubspaceState::rankOf(Rest | scatter(Pattern));
+				Amplitudes[SectorDim] = state.m_Amplitudes[Ranks[SectorDim]];
+				++SectorDim;
+			}
+
+			for (dimension_t i = 0; i < SectorDim; ++i)
+			{
+				cplx_t Sum{};
+				for (dimension_t j = 0; j < SectorDim; ++j)
+					Sum += gate.Matrix[Patterns[i]][Patterns[j]] * Amplitudes[j];
+				state.m_Amplitudes[Ranks[i]] = Sum;
+			}
+		}
+	}
+}
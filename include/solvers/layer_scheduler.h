@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+
+#include "core_types.h"
+#include "circuit_record.h"
+#include "gate_scheduler.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Layer scheduling: packing gates on disjoint qubits into single fused sweeps.
+    ///
+    /**
+     * @details
+     * Gates on disjoint qubits commute, so a recorded circuit can be regrouped into layers of
+     * mutually disjoint gates (each gate goes to the earliest layer after all gates it overlaps).
+     * A layer is then applied in one pass: the state decomposes into independent blocks over
+     * the union of the layer's qubits; every block is gathered once, all small unitaries of the
+     * layer are applied to it while it sits in registers / L1, and it is scattered back once.
+     * Three Hadamards on qubits 0, 1 and 2 thus cost one sweep instead of three.
+     *
+     * A layer is itself a blockable gate whose support is the union of its gates, so layers
+     * still take part in cache blocking and qubit remapping (see gate_scheduler.h). The union
+     * of a layer is limited to `LayerMaxQBitCount` qubits so that a block fits into L1.
+     */
+
+    /// @brief Maximum number of qubits spanned by one layer: 2^10 amplitudes × 16 bytes = 16 KiB.
+    constexpr dimension_t LayerMaxQBitCount = 10;
+
+    /**
+     * @brief     A layer of gates on disjoint qubits, viewed in a recorded circuit.
+     *
+     * @tparam MaxQBitCount  Width of the widest recorded gate.
+     */
+    template<dimension_t MaxQBitCount>
+    struct GateLayer
+    {
+        /// @brief The gates of the recorded circuit.
+        const GateRecord<MaxQBitCount>* Gates = nullptr;
+
+        /// @brief Indices in `Gates` of the gates of the layer, in execution order.
+        const dimension_t* GateIndices = nullptr;
+
+        /// @brief Number of gates in the layer.
+        dimension_t GateCount = 0;
+
+        /// @brief The g-th gate of the layer.
+        constexpr const GateRecord<MaxQBitCount>& gate(dimension_t g) const noexcept
+        {
+            return Gates[GateIndices[g]];
+        }
+
+        /// @brief Get the union of the supports of the layer's gates.
+        constexpr dimension_t getAffectedMask() const noexcept
+        {
+            dimension_t Mask = 0;
+            for (dimension_t g = 0; g < GateCount; ++g)
+                Mask |= gate(g).getAffectedMask();
+            return Mask;
+        }
+
+        /**
+         * @brief     Apply all gates of the layer in one pass over a contiguous range of the state.
+         * @see       QuantumGateOp::applyInPlace for the meaning of the layout and the range.
+         */
+        template<dimension_t StateCount>
+        constexpr void applyInPlace(StateVector<StateCount>& state,
+            const QubitLayout<QBitCountOf<StateCount>>& layout,
+            dimension_t firstIndex, dimension_t lastIndex) const noexcept
+        {
+            if (GateCount == 1)
+                return gate(0).applyInPlace(state, layout, firstIndex, lastIndex);
+
+            constexpr dimension_t GateDim = ConstexprMath::pow2(MaxQBitCount);
+
+            // Physical union support, in ascending order; local bit t is physical bit UnionBits[t]
+            const dimension_t UnionMask = layout.mapMask(getAffectedMask());
+            const dimension_t UnionCount = static_cast<dimension_t>(std::popcount(UnionMask));
+            const dimension_t LocalDim = ConstexprMath::pow2(UnionCount);
+
+            qbit_list_t<LayerMaxQBitCount> UnionBits{};
+            for (dimension_t Bit = 0, t = 0; t < UnionCount; ++Bit)
+            {
+                if ((UnionMask >> Bit) & 1)
+                    UnionBits[t++] = Bit;
+            }
+
+            // Global offset of every local index
+            std::array<dimension_t, ConstexprMath::pow2(LayerMaxQBitCount)> Offsets{};
+            for (dimension_t i = 0; i < LocalDim; ++i)
+                for (dimension_t t = 0; t < UnionCount; ++t)
+                    Offsets[i] |= ((i >> t) & 1) << UnionBits[t];
+
+            // Local support mask and local offsets of every gate of the layer
+            std::array<dimension_t, LayerMaxQBitCount> GateMasks{};
+            std::array<std::array<dimension_t, GateDim>, LayerMaxQBitCount> GateOffsets{};
+            for (dimension_t g = 0; g < GateCount; ++g)
+            {
+                for (dimension_t q = 0; q < gate(g).QBitCount; ++q)
+                {
+                    const dimension_t Physical = layout.physical(gate(g).AffectedBits[q]);
+                    const dimension_t LocalBit = static_cast<dimension_t>(std::popcount(UnionMask & ((dimension_t(1) << Physical) - 1)));
+
+                    GateMasks[g] |= dimension_t(1) << LocalBit;
+                    for (dimension_t i = 0; i < gate(g).dim(); ++i)
+                        GateOffsets[g][i] |= ((i >> q) & 1) << LocalBit;
+                }
+            }
+
+            state_vector_t<ConstexprMath::pow2(LayerMaxQBitCount)> Local{};
+            const dimension_t BlockCount = (lastIndex - firstIndex) / LocalDim;
+
+            for (dimension_t block = 0; block < BlockCount; ++block)
+            {
+                // Insert zero bits at the union positions to get the block base
+                dimension_t Base = block;
+                for (dimension_t t = 0; t < UnionCount; ++t)
+                {
+                    const dimension_t LowMask = (dimension_t(1) << UnionBits[t]) - 1;
+                    Base = ((Base & ~LowMask) << 1) | (Base & LowMask);
+                }
+                Base += firstIndex;
+
+                for (dimension_t i = 0; i < LocalDim; ++i)
+                    Local[i] = state.m_StateVector[Base + Offsets[i]];
+
+                // Every gate of the layer on the gathered block
+                for (dimension_t g = 0; g < GateCount; ++g)
+                {
+                    const GateRecord<MaxQBitCount>& Gate = gate(g);
+                    const std::array<dimension_t, GateDim>& Offset = GateOffsets[g];
+                    const dimension_t Dim = Gate.dim();
+
+                    for (dimension_t LocalBase = 0; LocalBase < LocalDim; ++LocalBase)
+                    {
+                        if (LocalBase & GateMasks[g])
+                            continue;
+
+                        if (Gate.IsDiagonal)
+                        {
+                            for (dimension_t i = 0; i < Dim; ++i)
+                                Local[LocalBase + Offset[i]] = Gate.Matrix[i][i] * Local[LocalBase + Offset[i]];
+                            continue;
+                        }
+
+                        state_vector_t<GateDim> In{};
+                        for (dimension_t i = 0; i < Dim; ++i)
+                            In[i] = Local[LocalBase + Offset[i]];
+                        for (dimension_t i = 0; i < Dim; ++i)
+                        {
+                            cplx_t Sum{};
+                            for (dimension_t j = 0; j < Dim; ++j)
+                                Sum += Gate.Matrix[i][j] * In[j];
+                            Local[LocalBase + Offset[i]] = Sum;
+                        }
+                    }
+                }
+
+                for (dimension_t i = 0; i < LocalDim; ++i)
+                    state.m_StateVector[Base + Offsets[i]] = Local[i];
+            }
+        }
+    };
+
+    /// @brief A circuit regrouped into layers of gates on disjoint qubits.
+    /// @tparam Capacity  Maximum number of gates.
+    ///
+    /// Only gate indices are kept, not copies of the gates: records of wide gates are large
+    /// (64 KiB per gate at 6 qubits), and the layering is built once per circuit. The same
+    /// layering serves the records of a circuit and their summaries (see `CircuitSummary`).
+    template<dimension_t Capacity>
+    struct LayeredCircuit
+    {
+        /// @brief Indices of the gates in the recorded circuit, reordered so that every layer is contiguous.
+        std::array<dimension_t, Capacity> GateOrder{};
+
+        /// @brief Position in `GateOrder` of the first gate of every layer; LayerStart[LayerCount] is the gate count.
+        std::array<dimension_t, Capacity + 1> LayerStart{};
+
+        dimension_t LayerCount = 0;
+
+        /// @brief Views of the layers of a circuit, usable as gates by the cache-blocked scheduler.
+        /// @param circuit  The recorded circuit the layering was built from.
+        /// @note  The views point into `circuit` and into this layering; neither may move while they are used.
+        template<dimension_t MaxQBitCount>
+        constexpr std::array<GateLayer<MaxQBitCount>, Capacity> getLayers(
+            const CircuitRecord<MaxQBitCount, Capacity>& circuit) const noexcept
+        {
+            std::array<GateLayer<MaxQBitCount>, Capacity> Layers{};
+            for (dimension_t l = 0; l < LayerCount; ++l)
+            {
+                Layers[l] = GateLayer<MaxQBitCount>{ circuit.Gates.data(), GateOrder.data() + LayerStart[l],
+                    LayerStart[l + 1] - LayerStart[l] };
+            }
+            return Layers;
+        }
+    };
+
+    /**
+     * @brief     Group the entries [firstGate, lastGate) of a homogeneous gate array into layers.
+     *
+     * @param gates      Gate storage exposing supports, e.g. the records of a `CircuitRecord`
+     *                   or the summaries of a `CircuitSummary`.
+     * @param firstGate  First gate to layer.
+     * @param lastGate   One past the last gate to layer.
+     * @return           The layering of the circuit; gates keep their relative order within a layer.
+     *
+     * A gate goes to the first layer after every layer holding a gate it overlaps in which
+     * the union of qubits stays within `LayerMaxQBitCount`. Moving a gate across layers of
+     * disjoint gates preserves the circuit, as disjoint gates commute.
+     */
+    template<typename GateType, dimension_t Capacity>
+    constexpr LayeredCircuit<Capacity> buildLayers(
+        const std::array<GateType, Capacity>& gates, dimension_t firstGate, dimension_t lastGate) noexcept
+    {
+        constexpr dimension_t MaxQBits = sizeof(dimension_t) * 8;
+
+        std::array<dimension_t, Capacity> GateLayerIndex{};
+        std::array<dimension_t, Capacity> LayerMasks{};
+        std::array<dimension_t, MaxQBits> QBitNextLayer{};
+        dimension_t LayerCount = 0;
+
+        for (dimension_t g = firstGate; g < lastGate; ++g)
+        {
+            const dimension_t Support = gates[g].getAffectedMask();
+
+            // Earliest layer after all gates this one overlaps
+            dimension_t Layer = 0;
+            for (dimension_t q = 0; q < MaxQBits; ++q)
+            {
+                if ((Support >> q) & 1)
+                    Layer = std::max(Layer, QBitNextLayer[q]);
+            }
+
+            while (Layer < LayerCount && std::popcount(LayerMasks[Layer] | Support) > static_cast<int>(LayerMaxQBitCount))
+                ++Layer;
+
+            LayerCount = std::max(LayerCount, Layer + 1);
+            LayerMasks[Layer] |= Support;
+            GateLayerIndex[g] = Layer;
+            for (dimension_t q = 0; q < MaxQBits; ++q)
+            {
+                if ((Support >> q) & 1)
+                    QBitNextLayer[q] = Layer + 1;
+            }
+        }
+
+        // Emit the gate indices layer by layer
+        LayeredCircuit<Capacity> Result{};
+        Result.LayerCount = LayerCount;
+        dimension_t Emitted = 0;
+        for (dimension_t l = 0; l < LayerCount; ++l)
+        {
+            Result.LayerStart[l] = Emitted;
+            for (dimension_t g = firstGate; g < lastGate; ++g)
+            {
+                if (GateLayerIndex[g] == l)
+                    Result.GateOrder[Emitted++] = g;
+            }
+        }
+        Result.LayerStart[LayerCount] = Emitted;
+        return Result;
+    }
+
+    /// @brief Group the gates [firstGate, lastGate) of a recorded circuit into layers.
+    template<dimension_t MaxQBitCount, dimension_t Capacity>
+    constexpr LayeredCircuit<Capacity> buildLayers(
+        const CircuitRecord<MaxQBitCount, Capacity>& circuit, dimension_t firstGate, dimension_t lastGate) noexcept
+    {
+        return buildLayers(circuit.Gates, firstGate, lastGate);
+    }
+
+    /**
+     * @brief     Execute gates [firstGate, lastGate) of a recorded circuit layer by layer.
+     *
+     * @param state      The global state vector, updated in place (logical order on entry and return).
+     * @param circuit    The recorded circuit.
+     * @param firstGate  First gate to execute.
+     * @param lastGate   One past the last gate to execute.
+     *
+     * Each layer is one gate for the cache-blocked scheduler: layers on low qubits are still
+     * applied tile by tile, and a layer reaching outside the tile costs one sweep in total.
+     */
+    template<dimension_t TileQBitCount = CacheTileQBitCount, dimension_t StateCount, dimension_t MaxQBitCount, dimension_t Capacity>
+    constexpr void executeLayered(StateVector<StateCount>& state,
+        const CircuitRecord<MaxQBitCount, Capacity>& circuit, dimension_t firstGate, dimension_t lastGate)
+    {
+        const LayeredCircuit<Capacity> Layered = buildLayers(circuit, firstGate, lastGate);
+        executeCacheBlockedSequence<TileQBitCount>(state, Layered.getLayers(circuit), 0, Layered.LayerCount);
+    }
+}
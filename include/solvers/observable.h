@@ -0,0 +1,197 @@
+#pragma once
+#include <tuple>
+
+#include "core_types.h"
+#include "quantum_gate_solver.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Hermitian observables on a few qubits and their sums, e.g. H = Σ c_k P_k.
+	///
+	/**
+	 * @details
+	 * An observable is applied with the same block kernel as a gate (the kernel does not
+	 * require unitarity). `apply` returns O|ψ⟩, which is what expectation values and the
+	 * adjoint gradient method need; `expectationValue` returns Re⟨ψ|O|ψ⟩.
+	 */
+
+	/// @brief Concept for observables: Hermitian operators that can be applied to a state vector.
+	template<typename ObservableType>
+	concept ObservableLike =
+		requires(const ObservableType o, const StateVector<1>& state)
+	{
+		{ o.apply(state) } -> std::same_as<StateVector<1>>;
+	};
+
+	/// @brief Re⟨a|b⟩, accumulated in index order.
+	template<dimension_t StateCount>
+	constexpr float_t realOverlap(const StateVector<StateCount>& a, const StateVector<StateCount>& b) noexcept
+	{
+		float_t Sum = 0.0;
+		for (dimension_t i = 0; i < StateCount; ++i)
+		{
+			Sum += a.m_StateVector[i].re * b.m_StateVector[i].re + a.m_StateVector[i].im * b.m_StateVector[i].im;
+		}
+		return Sum;
+	}
+
+	/**
+	 * @brief     A weighted Hermitian operator acting on a specific set of qubits.
+	 * @tparam QBitCount  Number of qubits the operator acts on.
+	 */
+	template<dimension_t QBitCount>
+	class ObservableOp
+	{
+		/// @brief The Hermitian matrix of the operator.
+		matrix_t<ConstexprMath::pow2(QBitCount)> OperatorMatrix;
+
+		/// @brief Fixed-size list of qubit indices the operator acts on.
+		qbit_list_t<QBitCount> AffectedBits;
+
+		/// @brief Real coefficient of the term.
+		float_t Coefficient;
+
+	public:
+		constexpr ObservableOp(const matrix_t<ConstexprMath::pow2(QBitCount)>& O,
+			const qbit_list_t<QBitCount>& affectedBits, float_t coefficient = 1.0) noexcept
+			: OperatorMatrix(O), AffectedBits(affectedBits), Coefficient(coefficient)
+		{
+		}
+
+		/// @brief Scale the term by a real coefficient.
+		constexpr ObservableOp operator*(float_t coefficient) const noexcept
+		{
+			return ObservableOp(OperatorMatrix, AffectedBits, Coefficient * coefficient);
+		}
+
+		/// @brief Get the operator's matrix.
+		constexpr const matrix_t<ConstexprMath::pow2(QBitCount)>& getOperatorMatrix() const noexcept
+		{
+			return OperatorMatrix;
+		}
+
+		/// @brief Get the list of qubit indices the operator acts on.
+		constexpr const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Get the bit mask of the qubits the operator acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return qbitMask(AffectedBits);
+		}
+
+		/// @brief Compute c · O|ψ⟩.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount> apply(StateVector<StateCount> state) const noexcept
+		{
+			applyGateMatrix<QBitCount>(state, OperatorMatrix, AffectedBits);
+			for (cplx_t& c : state.m_StateVector)
+				c = c * Coefficient;
+			return state;
+		}
+
+		/// @brief Compute ⟨ψ|c · O|ψ⟩ (real for a Hermitian operator).
+		template<dimension_t StateCount>
+		constexpr float_t expectationValue(const StateVector<StateCount>& state) const noexcept
+		{
+			return realOverlap(state, apply(state));
+		}
+	};
+
+	/// @brief Sum of observable terms, created with `operator+` on observables.
+	template<ObservableLike... Terms>
+	class ObservableSum
+	{
+		std::tuple<Terms...> m_terms;
+
+	public:
+		constexpr explicit ObservableSum(const Terms&... terms) noexcept
+			: m_terms(terms...)
+		{
+		}
+
+		/// @brief Get the individual terms of the sum.
+		constexpr const std::tuple<Terms...>& getTerms() const noexcept
+		{
+			return m_terms;
+		}
+
+		/// @brief Compute Σ_k O_k|ψ⟩.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount> apply(const StateVector<StateCount>& state) const noexcept
+		{
+			StateVector<StateCount> Result{};
+			std::apply([&](const auto&... term)
+				{
+					([&]
+						{
+							const StateVector<StateCount> Contribution = term.apply(state);
+							for (dimension_t i = 0; i < StateCount; ++i)
+								Result.m_StateVector[i] += Contribution.m_StateVector[i];
+						}(), ...);
+				}, m_terms);
+			return Result;
+		}
+
+		/// @brief Compute ⟨ψ|Σ_k O_k|ψ⟩.
+		template<dimension_t StateCount>
+		constexpr float_t expectationValue(const StateVector<StateCount>& state) const noexcept
+		{
+			return realOverlap(state, apply(state));
+		}
+	};
+
+	/// @brief Add two observables (terms or sums) into a flat sum.
+	template<ObservableLike A, ObservableLike B>
+	constexpr auto operator+(const A& a, const B& b) noexcept
+	{
+		constexpr auto asTuple = [](const auto& o)
+		{
+			if constexpr (requires { o.getTerms(); })
+				return o.getTerms();
+			else
+				return std::make_tuple(o);
+		};
+
+		return std::apply([](const auto&... terms) { return ObservableSum<std::remove_cvref_t<decltype(terms)>...>(terms...); },
+			std::tuple_cat(asTuple(a), asTuple(b)));
+	}
+
+	/// @brief Qubits an observable (term or sum) acts on; all ones if the observable does not tell.
+	template<ObservableLike ObservableType>
+	constexpr dimension_t observableSupportMask(const ObservableType& observable) noexcept
+	{
+		if constexpr (requires { observable.getAffectedMask(); })
+			return observable.getAffectedMask();
+		else if constexpr (requires { observable.getTerms(); })
+			return std::apply([](const auto&... term) { return (observableSupportMask(term) | ... | dimension_t{ 0 }); },
+				observable.getTerms());
+		else
+			return ~dimension_t(0);
+	}
+
+	/**
+	 * @brief     Factory for creating `ObservableOp` objects from a constant Hermitian matrix.
+	 *
+	 * @tparam QBitCount       Number of qubits the operator acts on.
+	 * @tparam OperatorMatrix  Hermitian 2^QBitCount × 2^QBitCount matrix (checked at compile time).
+	 *
+	 * Example:
+	 *   auto H = Observable<1, Gates::Z>().onBits(0) + Observable<1, Gates::X>().onBits(1) * 0.5;
+	 */
+	template<dimension_t QBitCount, auto OperatorMatrix>
+		requires (is_gate_matrix_v<std::remove_cvref_t<decltype(OperatorMatrix)>>&& is_hermitian<OperatorMatrix>())
+	struct Observable
+	{
+		/// @brief Bind the operator to a list of qubit indices.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr ObservableOp<QBitCount> onBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == QBitCount);
+			return ObservableOp<QBitCount>(OperatorMatrix, qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <concepts>
+
+#include "core_types.h"
+#include "quantum_gate_solver.h"
+#include "quantum_gates/parametric_gates.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Gate operations whose angles are runtime values.
+	///
+	/**
+	 * @details
+	 * `QuantumGate<K, Matrix>` takes its matrix as a template argument, so an angle computed
+	 * at run time (optimizer output, file input) cannot be used with it. `ParametricGate<Kind>`
+	 * takes the angles as ordinary constructor arguments instead; the constructor is constexpr,
+	 * so constant angles still work in constant expressions. The closed-form matrix of the kind
+	 * is built once per gate, and diagonal kinds (RZ, CPhase) are applied as a per-amplitude
+	 * phase rather than a dense matrix-vector product.
+	 */
+
+	/// @brief Concept for gate kinds usable with `ParametricGate` (see quantum_gates/parametric_gates.h).
+	template<typename Kind>
+	concept parametric_gate_kind =
+		requires(const std::array<float_t, Kind::ParameterCount>& angles)
+	{
+		{ Kind::QBitCount } -> std::convertible_to<dimension_t>;
+		{ Kind::IsDiagonal } -> std::convertible_to<bool>;
+		{ Kind::matrix(angles) } -> std::same_as<matrix_t<ConstexprMath::pow2(Kind::QBitCount)>>;
+		{ Kind::derivative(angles, dimension_t{}) } -> std::same_as<matrix_t<ConstexprMath::pow2(Kind::QBitCount)>>;
+	};
+
+	/**
+	 * @brief     Application of a parametric gate with concrete angles to a specific set of qubits.
+	 *
+	 * @tparam Kind  Gate kind providing the closed-form matrix (e.g. `Gates::RX`).
+	 *
+	 * Besides the functional-style call operator, the operation exposes the same in-place
+	 * range kernel as `QuantumGateOp`, so it takes part in cache-blocked scheduling and
+	 * qubit remapping, and its matrix, so the batched executors accept it as a fixed gate.
+	 */
+	template<parametric_gate_kind Kind>
+	class ParametricGateOp
+	{
+	public:
+		static constexpr dimension_t QBitCount = Kind::QBitCount;
+		static constexpr dimension_t ParameterCount = Kind::ParameterCount;
+
+	private:
+		static constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		/// @brief The angles the gate was created with.
+		const std::array<float_t, Kind::ParameterCount> Parameters;
+
+		/// @brief Fixed-size list of qubit indices affected by this gate.
+		const qbit_list_t<QBitCount> AffectedBits;
+
+		/// @brief The gate matrix, evaluated once from the angles.
+		const matrix_t<Dim> GateMatrix;
+
+	public:
+		/// @brief Construct an operation from the angles and the affected qubits.
+		constexpr ParametricGateOp(const std::array<float_t, Kind::ParameterCount>& parameters,
+			const qbit_list_t<QBitCount>& affectedBits) noexcept
+			: Parameters(parameters), AffectedBits(affectedBits), GateMatrix(Kind::matrix(parameters))
+		{
+		}
+
+		/// @brief Get the angles of the gate.
+		constexpr const std::array<float_t, Kind::ParameterCount>& getParameters() const noexcept
+		{
+			return Parameters;
+		}
+
+		/// @brief Get the unitary matrix of the gate.
+		constexpr const matrix_t<Dim>& getGateMatrix() const noexcept
+		{
+			return GateMatrix;
+		}
+
+		/// @brief Get the list of qubit indices the gate acts on.
+		constexpr const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Get the bit mask of the qubits the gate acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return qbitMask(AffectedBits);
+		}
+
+		/// @brief Apply the gate in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			if constexpr (Kind::IsDiagonal)
+			{
+				state_vector_t<Dim> Diagonal{};
+				for (dimension_t i = 0; i < Dim; ++i)
+					Diagonal[i] = GateMatrix[i][i];
+
+				applyDiagonalMatrix<QBitCount>(state, Diagonal, layout.map(AffectedBits), firstIndex, lastIndex);
+			}
+			else
+			{
+				applyGateMatrix<QBitCount>(state, GateMatrix, layout.map(AffectedBits), firstIndex, lastIndex);
+			}
+		}
+
+		/// @brief Apply the gate in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyInPlace(state, QubitLayout<QBitCountOf<StateCount>>{}, 0, StateCount);
+		}
+
+		/// @brief Apply the inverse gate U^† in place to a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			if constexpr (Kind::IsDiagonal)
+			{
+				state_vector_t<Dim> Diagonal{};
+				for (dimension_t i = 0; i < Dim; ++i)
+					Diagonal[i] = GateMatrix[i][i].conj();
+
+				applyDiagonalMatrix<QBitCount>(state, Diagonal, AffectedBits);
+			}
+			else
+			{
+				applyGateMatrix<QBitCount>(state, adjointMatrix(GateMatrix), AffectedBits);
+			}
+		}
+
+		/// @brief Apply ∂U/∂θ_p in place (not unitary) to a state vector stored in logical order.
+		/// @param parameter  Index p of the angle to differentiate by.
+		template<dimension_t StateCount>
+		constexpr void applyDerivativeInPlace(StateVector<StateCount>& state, dimension_t parameter) const noexcept
+		{
+			applyGateMatrix<QBitCount>(state, Kind::derivative(Parameters, parameter), AffectedBits);
+		}
+
+		/// @brief Apply the gate to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount>
+			operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+	};
+
+	/**
+	 * @brief     Factory for creating `ParametricGateOp` objects from runtime (or constexpr) angles.
+	 *
+	 * @tparam Kind  Gate kind providing the closed-form matrix.
+	 *
+	 * Example:
+	 *   auto rx = ParametricGate<Gates::RX>(theta).toBits(0);
+	 *   auto u3 = ParametricGate<Gates::U3>(theta, phi, lambda).toBits(1);
+	 */
+	template<parametric_gate_kind Kind>
+	struct ParametricGate
+	{
+		/// @brief The angles of the gate.
+		std::array<float_t, Kind::ParameterCount> Parameters;
+
+		/// @brief Construct a gate from its angles (exactly Kind::ParameterCount values).
+		template<std::convertible_to<float_t>... Angles>
+			requires (sizeof...(Angles) == Kind::ParameterCount)
+		constexpr explicit ParametricGate(Angles... angles) noexcept
+			: Parameters{ static_cast<float_t>(angles)... }
+		{
+		}
+
+		/// @brief Bind this gate to a list of qubit indices and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr ParametricGateOp<Kind> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == Kind::QBitCount);
+			return ParametricGateOp<Kind>(Parameters, qbit_list_t<Kind::QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+}
@@ -0,0 +1,287 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "core_types.h"
+#include "quantum_gate_solver.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Reduced density matrices of qubit subsets, their spectra and entanglement entropies.
+	///
+	/**
+	 * @details
+	 * Split the qubits into a kept register A (K qubits) and the traced-out rest B. Seen as a
+	 * 2^K × 2^(N-K) matrix Ψ[a][b] = ψ(a, b), the state gives the reduced density matrix as
+	 * a single product ρ_A = Ψ Ψ†. The columns of Ψ are exactly the blocks `GateBlockIndexer`
+	 * enumerates for the kept qubits, so the product is computed in one pass over the state:
+	 * columns are gathered `PartialTracePanelWidth` at a time and each panel is folded into
+	 * the upper triangle of ρ_A (a rank-8 update), which keeps ρ_A traffic low.
+	 *
+	 * Large states cut the panels into at most `PartialTraceMaxRangeCount` contiguous ranges,
+	 * each folded into its own partial ρ_A on hardware threads (serially in constant
+	 * evaluation) and added up in range order afterwards. The ranges depend only on the
+	 * dimensions, so the result is the same whatever the thread count, and the partials never
+	 * take more memory than the state itself.
+	 *
+	 * `hermitianEigenvalues` diagonalises ρ_A with cyclic Jacobi rotations, from which the von
+	 * Neumann entropy S = -Σ λ log2 λ and the Rényi entropies S_α = log2(Σ λ^α) / (1 - α)
+	 * follow. Everything is constexpr.
+	 *
+	 * Local basis bit q of ρ_A is keptBits[q], as for gates.
+	 */
+
+	/// @brief Number of traced-out columns gathered before they are folded into ρ_A.
+	constexpr dimension_t PartialTracePanelWidth = 8;
+
+	/// @brief Minimum number of panels in a range; smaller states are folded into ρ_A directly.
+	constexpr dimension_t PartialTracePanelsPerRange = 64;
+
+	/// @brief Maximum number of panel ranges, each with its own partial ρ_A.
+	constexpr dimension_t PartialTraceMaxRangeCount = 16;
+
+	/// @brief Eigenvalues (and spectrum weights) below this are treated as zero in entropies.
+	constexpr float_t SpectrumTolerance = 1E-14;
+
+	/**
+	 * @brief     Compute the reduced density matrix ρ_A = Tr_B |ψ><ψ| of a qubit subset.
+	 *
+	 * @tparam QBitCount   Number of kept qubits K.
+	 * @tparam StateCount  Dimension of the global state vector.
+	 * @param state        The (normalised) global state vector.
+	 * @param keptBits     The kept qubits; local bit q of ρ_A maps to keptBits[q].
+	 * @return             The 2^K × 2^K Hermitian, positive semi-definite matrix ρ_A.
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount>
+	constexpr matrix_t<ConstexprMath::pow2(QBitCount)> reducedDensityMatrix(const StateVector<StateCount>& state,
+		const qbit_list_t<QBitCount>& keptBits) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+		constexpr dimension_t ColumnCount = StateCount / Dim;
+		constexpr dimension_t PanelWidth = ColumnCount < PartialTracePanelWidth ? ColumnCount : PartialTracePanelWidth;
+
+		constexpr dimension_t PanelCount = ColumnCount / PanelWidth;
+		constexpr dimension_t RangeCount = std::clamp<dimension_t>(std::min(PanelCount / PartialTracePanelsPerRange,
+			StateCount / (Dim * Dim)), 1, PartialTraceMaxRangeCount);
+
+		const GateBlockIndexer<QBitCount> Indexer(keptBits);
+
+		// Fold the panels [firstPanel, lastPanel) into the upper triangle of rho
+		const auto foldPanels = [&](matrix_t<Dim>& rho, dimension_t firstPanel, dimension_t lastPanel)
+			{
+				std::array<state_vector_t<PanelWidth>, Dim> Panel{};
+				for (dimension_t First = firstPanel * PanelWidth; First < lastPanel * PanelWidth; First += PanelWidth)
+				{
+					// Gather Ψ[a][First .. First + PanelWidth)
+					for (dimension_t c = 0; c < PanelWidth; ++c)
+					{
+						const dimension_t Base = Indexer.base(First + c);
+						for (dimension_t a = 0; a < Dim; ++a)
+							Panel[a][c] = state.m_StateVector[Base + Indexer.Offsets[a]];
+					}
+
+					// ρ[i][j] += Σ_c Ψ[i][c] Ψ*[j][c] on the upper triangle
+					for (dimension_t i = 0; i < Dim; ++i)
+						for (dimension_t j = i; j < Dim; ++j)
+						{
+							cplx_t Sum = rho[i][j];
+							for (dimension_t c = 0; c < PanelWidth; ++c)
+								Sum += Panel[i][c] * Panel[j][c].conj();
+							rho[i][j] = Sum;
+						}
+				}
+			};
+
+		matrix_t<Dim> Rho{};
+		if constexpr (RangeCount == 1)
+		{
+			foldPanels(Rho, 0, PanelCount);
+		}
+		else
+		{
+			// Contiguous panel ranges; the first PanelCount % RangeCount ranges take one more panel
+			const auto firstPanelOf = [](dimension_t range)
+				{
+					return PanelCount / RangeCount * range + std::min(range, PanelCount % RangeCount);
+				};
+
+			std::vector<matrix_t<Dim>> Partials(RangeCount);
+			const auto work = [&](dimension_t firstRange, dimension_t lastRange)
+				{
+					for (dimension_t Range = firstRange; Range < lastRange; ++Range)
+						foldPanels(Partials[Range], firstPanelOf(Range), firstPanelOf(Range + 1));
+				};
+
+			dimension_t WorkerCount = 1;
+			if !consteval
+			{
+				WorkerCount = std::clamp<dimension_t>(std::thread::hardware_concurrency(), 1, RangeCount);
+			}
+
+			if (WorkerCount == 1)
+			{
+				work(0, RangeCount);
+			}
+			else
+			{
+				const auto firstRangeOf = [&](dimension_t worker)
+					{
+						return RangeCount / WorkerCount * worker + std::min(worker, RangeCount % WorkerCount);
+					};
+
+				std::vector<std::jthread> Workers{};
+				Workers.reserve(WorkerCount - 1);
+				for (dimension_t w = 1; w < WorkerCount; ++w)
+					Workers.emplace_back(work, firstRangeOf(w), firstRangeOf(w + 1));
+				work(0, firstRangeOf(1));
+			}
+
+			// Merge in range order, once every worker has joined
+			for (const matrix_t<Dim>& Partial : Partials)
+				for (dimension_t i = 0; i < Dim; ++i)
+					for (dimension_t j = i; j < Dim; ++j)
+						Rho[i][j] += Partial[i][j];
+		}
+
+		for (dimension_t i = 0; i < Dim; ++i)
+		{
+			Rho[i][i].im = 0.0;
+			for (dimension_t j = i + 1; j < Dim; ++j)
+				Rho[j][i] = Rho[i][j].conj();
+		}
+		return Rho;
+	}
+
+	/**
+	 * @brief     Compute the eigenvalues of a Hermitian matrix, in descending order.
+	 *
+	 * @tparam Dim        Dimension of the matrix.
+	 * @param matrix      The Hermitian matrix (only its upper triangle and real diagonal are trusted).
+	 * @param maxSweeps   Upper bound on the number of Jacobi sweeps.
+	 * @return            The real eigenvalues, largest first.
+	 *
+	 * Cyclic complex Jacobi: every off-diagonal pair (p, q) is first made real by a phase on
+	 * column q, then zeroed with a real plane rotation. Convergence is quadratic; sweeps stop
+	 * once the off-diagonal mass is negligible against the diagonal.
+	 */
+	template<dimension_t Dim>
+	constexpr probability_vector_t<Dim> hermitianEigenvalues(matrix_t<Dim> matrix, dimension_t maxSweeps = 64) noexcept
+	{
+		for (dimension_t Sweep = 0; Sweep < maxSweeps; ++Sweep)
+		{
+			float_t OffDiagonal = 0.0;
+			float_t Diagonal = 0.0;
+			for (dimension_t p = 0; p < Dim; ++p)
+			{
+				Diagonal += matrix[p][p].re * matrix[p][p].re;
+				for (dimension_t q = p + 1; q < Dim; ++q)
+					OffDiagonal += matrix[p][q].normSquared();
+			}
+			if (OffDiagonal <= 1E-30 * Diagonal || OffDiagonal == 0.0)
+				break;
+
+			for (dimension_t p = 0; p < Dim; ++p)
+				for (dimension_t q = p + 1; q < Dim; ++q)
+				{
+					const float_t Magnitude = ConstexprMath::sqrt(matrix[p][q].normSquared());
+					if (Magnitude == 0.0)
+						continue;
+
+					// A_pq = |A_pq| e^{iφ}; U = diag(1, e^{-iφ}) · R(θ) on (p, q)
+					const cplx_t Phase = matrix[p][q] * (1.0 / Magnitude);
+					const float_t Theta = (matrix[q][q].re - matrix[p][p].re) / (2.0 * Magnitude);
+					const float_t T = (Theta >= 0.0 ? 1.0 : -1.0) / (ConstexprMath::abs(Theta) + ConstexprMath::sqrt(Theta * Theta + 1.0));
+					const float_t C = 1.0 / ConstexprMath::sqrt(T * T + 1.0);
+					const float_t S = T * C;
+					const cplx_t PhaseConj = Phase.conj();
+
+					// Columns: A ← A U
+					for (dimension_t k = 0; k < Dim; ++k)
+					{
+						const cplx_t Akp = matrix[k][p];
+						const cplx_t Akq = matrix[k][q];
+						matrix[k][p] = Akp * C - PhaseConj * Akq * S;
+						matrix[k][q] = Akp * S + PhaseConj * Akq * C;
+					}
+
+					// Rows: A ← U† A
+					for (dimension_t k = 0; k < Dim; ++k)
+					{
+						const cplx_t Apk = matrix[p][k];
+						const cplx_t Aqk = matrix[q][k];
+						matrix[p][k] = Apk * C - Phase * Aqk * S;
+						matrix[q][k] = Apk * S + Phase * Aqk * C;
+					}
+
+					matrix[p][q] = cplx_t::zero();
+					matrix[q][p] = cplx_t::zero();
+					matrix[p][p].im = 0.0;
+					matrix[q][q].im = 0.0;
+				}
+		}
+
+		probability_vector_t<Dim> Eigenvalues{};
+		for (dimension_t i = 0; i < Dim; ++i)
+			Eigenvalues[i] = matrix[i][i].re;
+
+		for (dimension_t i = 1; i < Dim; ++i)
+			for (dimension_t j = i; j > 0 && Eigenvalues[j - 1] < Eigenvalues[j]; --j)
+			{
+				const float_t Tmp = Eigenvalues[j];
+				Eigenvalues[j] = Eigenvalues[j - 1];
+				Eigenvalues[j - 1] = Tmp;
+			}
+		return Eigenvalues;
+	}
+
+	/// @brief Von Neumann entropy S = -Σ λ log2 λ (in bits) of a density matrix spectrum.
+	template<dimension_t Dim>
+	constexpr float_t vonNeumannEntropy(const probability_vector_t<Dim>& spectrum) noexcept
+	{
+		float_t Entropy = 0.0;
+		for (float_t Lambda : spectrum)
+		{
+			if (Lambda > SpectrumTolerance)
+				Entropy -= Lambda * ConstexprMath::log(Lambda);
+		}
+		return Entropy / ConstexprMath::Ln2;
+	}
+
+	/**
+	 * @brief     Rényi entropy S_α = log2(Σ λ^α) / (1 - α) (in bits) of a density matrix spectrum.
+	 *
+	 * @param spectrum  The eigenvalues of the density matrix.
+	 * @param alpha     The order α >= 0; α = 1 gives the von Neumann entropy.
+	 */
+	template<dimension_t Dim>
+	constexpr float_t renyiEntropy(const probability_vector_t<Dim>& spectrum, float_t alpha) noexcept
+	{
+		if (alpha == 1.0)
+			return vonNeumannEntropy(spectrum);
+
+		float_t Sum = 0.0;
+		for (float_t Lambda : spectrum)
+		{
+			if (Lambda > SpectrumTolerance)
+				Sum += ConstexprMath::pow(Lambda, alpha);
+		}
+		return ConstexprMath::log(Sum) / (ConstexprMath::Ln2 * (1.0 - alpha));
+	}
+
+	/// @brief Entanglement entropy (von Neumann, in bits) between the kept qubits and the rest.
+	template<dimension_t QBitCount, dimension_t StateCount>
+	constexpr float_t entanglementEntropy(const StateVector<StateCount>& state, const qbit_list_t<QBitCount>& keptBits) noexcept
+	{
+		return vonNeumannEntropy(hermitianEigenvalues(reducedDensityMatrix(state, keptBits)));
+	}
+
+	/// @brief Rényi-α entanglement entropy (in bits) between the kept qubits and the rest.
+	template<dimension_t QBitCount, dimension_t StateCount>
+	constexpr float_t renyiEntanglementEntropy(const StateVector<StateCount>& state, const qbit_list_t<QBitCount>& keptBits,
+		float_t alpha) noexcept
+	{
+		return renyiEntropy(hermitianEigenvalues(reducedDensityMatrix(state, keptBits)), alpha);
+	}
+}
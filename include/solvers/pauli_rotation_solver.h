@@ -0,0 +1,280 @@
+#pragma once
+#include <bit>
+#include <concepts>
+#include <stdexcept>
+
+#include "core_types.h"
+#include "constexprmath/constexpr_trigon.h"
+#include "quantum_gate_solver.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Rotations exp(-iθP) about a Pauli string P, applied in a single pass.
+	///
+	/**
+	 * @details
+	 * Trotterised time evolution is a product of exp(-iθP) for Pauli strings P. The usual
+	 * decomposition (basis changes, a CX ladder onto one qubit, RZ, and the ladder undone)
+	 * costs 2w + 1 sweeps for a string of weight w. `PauliRotation` applies the exponential
+	 * directly instead.
+	 *
+	 * With XMask the qubits carrying X or Y and ZMask those carrying Z or Y, a Pauli string
+	 * maps basis states to basis states:
+	 *
+	 *   P|j> = i^{#Y} (-1)^{popcount(j & ZMask)} |j ⊕ XMask>,
+	 *
+	 * so exp(-iθP) = cos θ I - i sin θ P only mixes the amplitude pairs (j, j ⊕ XMask), with
+	 * a parity-dependent phase. One pass over half of the indices updates every pair; a
+	 * string without X or Y is diagonal and scales every amplitude by one of two phases.
+	 */
+
+	/// @brief The single-qubit Pauli operators.
+	enum class Pauli : unsigned char
+	{
+		I,
+		X,
+		Y,
+		Z
+	};
+
+	/// @brief Parse a Pauli letter ('I', 'X', 'Y', 'Z', lower case accepted).
+	/// @throws std::invalid_argument for any other character (a compile error in constant evaluation).
+	constexpr Pauli pauliFromLetter(char letter)
+	{
+		switch (letter)
+		{
+		case 'I': case 'i':
+			return Pauli::I;
+		case 'X': case 'x':
+			return Pauli::X;
+		case 'Y': case 'y':
+			return Pauli::Y;
+		case 'Z': case 'z':
+			return Pauli::Z;
+		default:
+			throw std::invalid_argument("Pauli letter must be one of I, X, Y, Z");
+		}
+	}
+
+	/// @brief A Pauli string of QBitCount letters, checked at compile time.
+	///
+	/// Built implicitly from a string literal of exactly QBitCount letters among I, X, Y, Z;
+	/// a literal of the wrong length does not convert and a wrong letter fails compilation.
+	template<dimension_t QBitCount>
+	struct PauliString
+	{
+		std::array<Pauli, QBitCount> Paulis{};
+
+		consteval PauliString(const char (&letters)[QBitCount + 1])
+		{
+			for (dimension_t q = 0; q < QBitCount; ++q)
+				Paulis[q] = pauliFromLetter(letters[q]);
+		}
+	};
+
+	/**
+	 * @brief     Application of exp(-iθP) to a specific set of qubits.
+	 *
+	 * @tparam QBitCount  Length of the Pauli string.
+	 *
+	 * Letter q of the string acts on AffectedBits[q]. The operation also exposes its
+	 * derivative by θ, so `adjointGradient` differentiates it.
+	 */
+	template<dimension_t QBitCount>
+	class PauliRotationOp
+	{
+	public:
+		static constexpr dimension_t ParameterCount = 1;
+
+	private:
+		/// @brief The rotation angle θ.
+		const std::array<float_t, ParameterCount> Parameters;
+
+		/// @brief The Pauli string.
+		const std::array<Pauli, QBitCount> Paulis;
+
+		/// @brief Fixed-size list of qubit indices the letters act on.
+		const qbit_list_t<QBitCount> AffectedBits;
+
+		/**
+		 * @brief     Apply α I + β P in place to a range of the state.
+		 *
+		 * @param affectedBits  The physical positions of the letters.
+		 *
+		 * Covers the rotation (α = cos θ, β = -i sin θ), its adjoint (β = i sin θ) and its
+		 * derivative (α = -sin θ, β = -i cos θ) with one kernel.
+		 */
+		template<dimension_t StateCount>
+		constexpr void applyCombination(StateVector<StateCount>& state, const cplx_t& alpha, const cplx_t& beta,
+			const qbit_list_t<QBitCount>& affectedBits, dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			dimension_t XMask = 0;
+			dimension_t ZMask = 0;
+			dimension_t YCount = 0;
+			for (dimension_t q = 0; q < QBitCount; ++q)
+			{
+				const dimension_t Bit = dimension_t(1) << affectedBits[q];
+				XMask |= (Paulis[q] == Pauli::X || Paulis[q] == Pauli::Y) ? Bit : 0;
+				ZMask |= (Paulis[q] == Pauli::Z || Paulis[q] == Pauli::Y) ? Bit : 0;
+				YCount += (Paulis[q] == Pauli::Y) ? 1 : 0;
+			}
+
+			// β i^{#Y}, the coefficient of P|j> for j of even parity
+			constexpr std::array<cplx_t, 4> PowersOfI{ cplx_t(1.0, 0.0), cplx_t(0.0, 1.0), cplx_t(-1.0, 0.0), cplx_t(0.0, -1.0) };
+			const cplx_t Beta = beta * PowersOfI[YCount % 4];
+
+			if (XMask == 0)
+			{
+				const cplx_t EvenFactor = alpha + Beta;
+				const cplx_t OddFactor = alpha - Beta;
+				for (dimension_t j = firstIndex; j < lastIndex; ++j)
+				{
+					cplx_t& Amplitude = state.m_StateVector[j];
+					Amplitude = ((std::popcount(j & ZMask) & 1) ? OddFactor : EvenFactor) * Amplitude;
+				}
+				return;
+			}
+
+			// Pairs (j, j ⊕ XMask), enumerated by the indices with a zero at the lowest flipped bit
+			const dimension_t PivotLowMask = (XMask & (~XMask + 1)) - 1;
+			const dimension_t PairCount = (lastIndex - firstIndex) / 2;
+			for (dimension_t t = 0; t < PairCount; ++t)
+			{
+				const dimension_t j = firstIndex + (((t & ~PivotLowMask) << 1) | (t & PivotLowMask));
+				const dimension_t k = j ^ XMask;
+
+				const cplx_t Aj = state.m_StateVector[j];
+				const cplx_t Ak = state.m_StateVector[k];
+				const cplx_t BetaJ = (std::popcount(j & ZMask) & 1) ? -Beta : Beta;
+				const cplx_t BetaK = (std::popcount(k & ZMask) & 1) ? -Beta : Beta;
+
+				state.m_StateVector[j] = alpha * Aj + BetaK * Ak;
+				state.m_StateVector[k] = alpha * Ak + BetaJ * Aj;
+			}
+		}
+
+	public:
+		/// @brief Construct a rotation from its angle, its Pauli string and the affected qubits.
+		constexpr PauliRotationOp(float_t theta, const std::array<Pauli, QBitCount>& paulis,
+			const qbit_list_t<QBitCount>& affectedBits) noexcept
+			: Parameters{ theta }, Paulis(paulis), AffectedBits(affectedBits)
+		{
+		}
+
+		/// @brief Get the rotation angle θ.
+		constexpr const std::array<float_t, ParameterCount>& getParameters() const noexcept
+		{
+			return Parameters;
+		}
+
+		/// @brief Get the Pauli string.
+		constexpr const std::array<Pauli, QBitCount>& getPaulis() const noexcept
+		{
+			return Paulis;
+		}
+
+		/// @brief Get the list of qubit indices the letters act on.
+		constexpr const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Get the bit mask of the qubits with a non-identity letter (the support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			dimension_t Mask = 0;
+			for (dimension_t q = 0; q < QBitCount; ++q)
+			{
+				if (Paulis[q] != Pauli::I)
+					Mask |= dimension_t(1) << AffectedBits[q];
+			}
+			return Mask;
+		}
+
+		/// @brief Apply the rotation in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			const float_t Theta = Parameters[0];
+			applyCombination(state, cplx_t::fromReal(ConstexprMath::cos(Theta)), cplx_t(0.0, -ConstexprMath::sin(Theta)),
+				layout.map(AffectedBits), firstIndex, lastIndex);
+		}
+
+		/// @brief Apply the rotation in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyInPlace(state, QubitLayout<QBitCountOf<StateCount>>{}, 0, StateCount);
+		}
+
+		/// @brief Apply the inverse rotation exp(iθP) in place to a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			const float_t Theta = Parameters[0];
+			applyCombination(state, cplx_t::fromReal(ConstexprMath::cos(Theta)), cplx_t(0.0, ConstexprMath::sin(Theta)),
+				AffectedBits, 0, StateCount);
+		}
+
+		/// @brief Apply ∂/∂θ exp(-iθP) = -i P exp(-iθP) in place (not unitary) to a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyDerivativeInPlace(StateVector<StateCount>& state, dimension_t) const noexcept
+		{
+			const float_t Theta = Parameters[0];
+			applyCombination(state, cplx_t::fromReal(-ConstexprMath::sin(Theta)), cplx_t(0.0, -ConstexprMath::cos(Theta)),
+				AffectedBits, 0, StateCount);
+		}
+
+		/// @brief Apply the rotation to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount>
+			operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+	};
+
+	/**
+	 * @brief     Factory for creating `PauliRotationOp` objects.
+	 *
+	 * @tparam QBitCount  Length of the Pauli string.
+	 *
+	 * Example: one Trotter step of exp(-iθ X0 Z3 Y5)
+	 *   auto step = PauliRotation<3>(theta, "XZY").toBits(0, 3, 5);
+	 */
+	template<dimension_t QBitCount>
+	struct PauliRotation
+	{
+		/// @brief The rotation angle θ.
+		float_t Theta;
+
+		/// @brief The Pauli string.
+		std::array<Pauli, QBitCount> Paulis{};
+
+		/// @brief Construct a rotation from its angle and the letters of its Pauli string.
+		/// @param paulis  A literal of QBitCount letters among I, X, Y, Z; letter q acts on the q-th qubit given to toBits.
+		constexpr PauliRotation(float_t theta, const PauliString<QBitCount>& paulis) noexcept
+			: Theta(theta), Paulis(paulis.Paulis)
+		{
+		}
+
+		/// @brief Construct a rotation from its angle and its Pauli string.
+		constexpr PauliRotation(float_t theta, const std::array<Pauli, QBitCount>& paulis) noexcept
+			: Theta(theta), Paulis(paulis)
+		{
+		}
+
+		/// @brief Bind this rotation to a list of qubit indices and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr PauliRotationOp<QBitCount> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == QBitCount);
+			return PauliRotationOp<QBitCount>(Theta, Paulis, qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <concepts>
+
+#include "core_types.h"
+#include "quantum_gate_solver.h"
+#include "quantum_gates/arithmetic_functions.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Gates applying a reversible classical function as a permutation of basis states.
+	///
+	/**
+	 * @details
+	 * Arithmetic on a register (modular multiplication, adders, comparators) is a bijection f
+	 * of the register's basis states. Spelled out as CX / Toffoli chains, every link of the
+	 * chain is one dense-kernel sweep over the state. `PermutationGate<K, f, C>` instead
+	 * tabulates f over the 2^K values of a K-qubit target register at compile time, and
+	 * applies it in a single pass by moving amplitudes: |c, x> -> |c, f(x)> if all C control
+	 * qubits are set, unchanged otherwise. No arithmetic is done on the amplitudes, and
+	 * values with f(x) = x are not touched.
+	 *
+	 * The function is checked to be a bijection of [0, 2^K) when the gate type is formed.
+	 * Functions for the usual cases live in quantum_gates/arithmetic_functions.h.
+	 */
+
+	/// @brief True if Function maps [0, 2^QBitCount) onto itself one-to-one.
+	template<dimension_t QBitCount, auto Function>
+	constexpr bool is_bijection() noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		std::array<bool, Dim> Hit{};
+		for (dimension_t x = 0; x < Dim; ++x)
+		{
+			const dimension_t Image = Function(x);
+			if (Image >= Dim || Hit[Image])
+				return false;
+			Hit[Image] = true;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief     Application of a controlled permutation gate to a specific set of qubits.
+	 *
+	 * @tparam QBitCount     Number of target qubits the function acts on.
+	 * @tparam Function      The bijection of [0, 2^QBitCount), callable as `dimension_t(dimension_t)`.
+	 * @tparam ControlCount  Number of control qubits.
+	 *
+	 * The affected qubits list the controls first, then the targets; bit q of the function's
+	 * argument is the q-th target qubit.
+	 */
+	template<dimension_t QBitCount, auto Function, dimension_t ControlCount>
+	class PermutationGateOp
+	{
+	public:
+		/// @brief Total number of qubits the gate acts on.
+		static constexpr dimension_t Width = ControlCount + QBitCount;
+
+	private:
+		static constexpr dimension_t TargetDim = ConstexprMath::pow2(QBitCount);
+
+		/// @brief Local index of the controls when all of them are set.
+		static constexpr dimension_t ControlOnes = ConstexprMath::pow2(ControlCount) - 1;
+
+		/// @brief The moved values of a permutation (f(x) != x) and their images.
+		struct MovedValues
+		{
+			std::array<dimension_t, TargetDim> From{};
+			std::array<dimension_t, TargetDim> To{};
+			dimension_t Count = 0;
+		};
+
+		/// @brief Tabulate the moved values of f, or of f^-1.
+		static constexpr MovedValues tabulate(bool inverse) noexcept
+		{
+			MovedValues Moved{};
+			for (dimension_t x = 0; x < TargetDim; ++x)
+			{
+				const dimension_t Image = Function(x);
+				if (Image == x)
+					continue;
+
+				Moved.From[Moved.Count] = inverse ? Image : x;
+				Moved.To[Moved.Count] = inverse ? x : Image;
+				++Moved.Count;
+			}
+			return Moved;
+		}
+
+		static constexpr MovedValues Forward = tabulate(false);
+		static constexpr MovedValues Inverse = tabulate(true);
+
+		/// @brief Controls, then targets.
+		const qbit_list_t<Width> AffectedBits;
+
+		/**
+		 * @brief     Move the amplitudes of a range of the state along a tabulated permutation.
+		 *
+		 * Every block over the affected qubits gathers the moved amplitudes of its controlled
+		 * subspace, then scatters them to their images: one read and one write per moved value.
+		 */
+		template<dimension_t StateCount>
+		static constexpr void permute(StateVector<StateCount>& state, const MovedValues& moved,
+			const qbit_list_t<Width>& affectedBits, dimension_t firstIndex, dimension_t lastIndex) noexcept
+		{
+			constexpr dimension_t Dim = ConstexprMath::pow2(Width);
+
+			const GateBlockIndexer<Width> Indexer(affectedBits);
+			const dimension_t BlockCount = (lastIndex - firstIndex) / Dim;
+
+			std::array<dimension_t, TargetDim> FromOffsets{};
+			std::array<dimension_t, TargetDim> ToOffsets{};
+			for (dimension_t m = 0; m < moved.Count; ++m)
+			{
+				FromOffsets[m] = Indexer.Offsets[ControlOnes | (moved.From[m] << ControlCount)];
+				ToOffsets[m] = Indexer.Offsets[ControlOnes | (moved.To[m] << ControlCount)];
+			}
+
+			state_vector_t<TargetDim> Local{};
+			for (dimension_t block = 0; block < BlockCount; ++block)
+			{
+				const dimension_t Base = firstIndex + Indexer.base(block);
+
+				for (dimension_t m = 0; m < moved.Count; ++m)
+					Local[m] = state.m_StateVector[Base + FromOffsets[m]];
+				for (dimension_t m = 0; m < moved.Count; ++m)
+					state.m_StateVector[Base + ToOffsets[m]] = Local[m];
+			}
+		}
+
+	public:
+		/// @brief Construct an operation on the given qubits (controls first).
+		constexpr explicit PermutationGateOp(const qbit_list_t<Width>& affectedBits) noexcept
+			: AffectedBits(affectedBits)
+		{
+		}
+
+		/// @brief Get the list of qubit indices the gate acts on (controls first).
+		constexpr const qbit_list_t<Width>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Get the bit mask of the qubits the gate acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return qbitMask(AffectedBits);
+		}
+
+		/// @brief Apply the gate in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			permute(state, Forward, layout.map(AffectedBits), firstIndex, lastIndex);
+		}
+
+		/// @brief Apply the gate in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			permute(state, Forward, AffectedBits, 0, StateCount);
+		}
+
+		/// @brief Apply the inverse permutation f^-1 in place to a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			permute(state, Inverse, AffectedBits, 0, StateCount);
+		}
+
+		/// @brief Apply the gate to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount>
+			operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+	};
+
+	/**
+	 * @brief     Factory for creating `PermutationGateOp` objects from a constexpr bijection.
+	 *
+	 * @tparam QBitCount     Number of target qubits.
+	 * @tparam Function      The bijection of [0, 2^QBitCount) applied to the target register.
+	 * @tparam ControlCount  Number of control qubits (listed first in `toBits`).
+	 *
+	 * Example: the controlled multiplication by 2 mod 21 of Shor's algorithm, in one pass
+	 *   PermutationGate<5, Gates::ModularMultiplication<2, 21>{}, 1>().toBits(0, 3, 4, 5, 6, 7)
+	 */
+	template<dimension_t QBitCount, auto Function, dimension_t ControlCount = 0>
+		requires (is_bijection<QBitCount, Function>())
+	struct PermutationGate
+	{
+		/// @brief Bind this gate to its control qubits, then its target qubits, and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr PermutationGateOp<QBitCount, Function, ControlCount> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == ControlCount + QBitCount);
+			return PermutationGateOp<QBitCount, Function, ControlCount>(
+				qbit_list_t<ControlCount + QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+}
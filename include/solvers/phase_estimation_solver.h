@@ -0,0 +1,185 @@
+#pragma once
+#include <concepts>
+
+#include "core_types.h"
+#include "circuit_record.h"
+#include "fourier_transform_solver.h"
+#include "quantum_gate_solver.h"
+#include "quantum_gates/common_gates.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Quantum phase estimation with controlled powers computed by repeated squaring.
+	///
+	/**
+	 * @details
+	 * Phase estimation on P phase qubits applies controlled-U^(2^k) for k < P. Building
+	 * U^(2^k) from 2^k applications of U makes the circuit exponential in the precision. The
+	 * target unitary is small, though, so `PhaseEstimation` squares its matrix instead:
+	 * U^(2^k) = (U^(2^(k-1)))², P - 1 small matrix products in total, evaluated at compile
+	 * time for a constexpr gate.
+	 *
+	 * The block applies, on the phase register p and the target register t:
+	 *  - a Hadamard on every phase qubit p_k, followed by U^(2^k) on t controlled by p_k,
+	 *    which only touches the half of the state where p_k is set;
+	 *  - the inverse QFT of the phase register with the FFT kernel (see fourier_transform_solver.h).
+	 *
+	 * Bit k of the measured phase register value is phase qubit k, the same convention as
+	 * `InverseQFT`; for an eigenstate U|u> = e^{2πiφ}|u> the outcome peaks at φ · 2^P.
+	 */
+
+	/// @brief U^(2^k) for every k < PowerCount, by repeated squaring.
+	template<dimension_t PowerCount, dimension_t Dim>
+	constexpr std::array<matrix_t<Dim>, PowerCount> powersOfTwoOf(const matrix_t<Dim>& U) noexcept
+	{
+		std::array<matrix_t<Dim>, PowerCount> Powers{};
+		if constexpr (PowerCount > 0)
+		{
+			Powers[0] = U;
+			for (dimension_t k = 1; k < PowerCount; ++k)
+				Powers[k] = multiplyMatrices(Powers[k - 1], Powers[k - 1]);
+		}
+		return Powers;
+	}
+
+	/**
+	 * @brief     Application of a phase estimation block to a phase register and a target register.
+	 *
+	 * @tparam PhaseQBitCount   Number of phase (precision) qubits.
+	 * @tparam TargetQBitCount  Number of qubits the estimated unitary acts on.
+	 */
+	template<dimension_t PhaseQBitCount, dimension_t TargetQBitCount>
+	class PhaseEstimationOp
+	{
+		static constexpr dimension_t TargetDim = ConstexprMath::pow2(TargetQBitCount);
+
+		/// @brief U^(2^k) for every phase qubit k.
+		const std::array<matrix_t<TargetDim>, PhaseQBitCount> Powers;
+
+		/// @brief The phase register; bit k of the estimate is PhaseBits[k].
+		const qbit_list_t<PhaseQBitCount> PhaseBits;
+
+		/// @brief The target register; local bit q of U maps to TargetBits[q].
+		const qbit_list_t<TargetQBitCount> TargetBits;
+
+	public:
+		/// @brief Construct a block from the precomputed powers and both registers.
+		constexpr PhaseEstimationOp(const std::array<matrix_t<TargetDim>, PhaseQBitCount>& powers,
+			const qbit_list_t<PhaseQBitCount>& phaseBits, const qbit_list_t<TargetQBitCount>& targetBits) noexcept
+			: Powers(powers), PhaseBits(phaseBits), TargetBits(targetBits)
+		{
+		}
+
+		/// @brief Get the matrix U^(2^k) controlled by phase qubit k.
+		constexpr const matrix_t<TargetDim>& getPower(dimension_t k) const noexcept
+		{
+			return Powers[k];
+		}
+
+		/// @brief Get the phase register.
+		constexpr const qbit_list_t<PhaseQBitCount>& getPhaseBits() const noexcept
+		{
+			return PhaseBits;
+		}
+
+		/// @brief Get the target register.
+		constexpr const qbit_list_t<TargetQBitCount>& getTargetBits() const noexcept
+		{
+			return TargetBits;
+		}
+
+		/// @brief Get the bit mask of both registers (the support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return qbitMask(PhaseBits) | qbitMask(TargetBits);
+		}
+
+		/// @brief Apply the block in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			const qbit_list_t<PhaseQBitCount> Phase = layout.map(PhaseBits);
+			const qbit_list_t<TargetQBitCount> Target = layout.map(TargetBits);
+
+			for (dimension_t k = 0; k < PhaseQBitCount; ++k)
+			{
+				applyGateMatrix<1>(state, Gates::H, qbit_list_t<1>{ Phase[k] }, firstIndex, lastIndex);
+				applyControlledGateMatrix<TargetQBitCount>(state, Powers[k], Phase[k], Target, firstIndex, lastIndex);
+			}
+			applyFourierTransform<PhaseQBitCount>(state, Phase, true, firstIndex, lastIndex);
+		}
+
+		/// @brief Apply the block in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyInPlace(state, QubitLayout<QBitCountOf<StateCount>>{}, 0, StateCount);
+		}
+
+		/// @brief Undo the block in place on a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyFourierTransform<PhaseQBitCount>(state, PhaseBits, false);
+			for (dimension_t k = PhaseQBitCount; k-- > 0;)
+			{
+				applyControlledGateMatrix<TargetQBitCount>(state, adjointMatrix(Powers[k]), PhaseBits[k], TargetBits);
+				applyGateMatrix<1>(state, Gates::H, qbit_list_t<1>{ PhaseBits[k] });
+			}
+		}
+
+		/// @brief Apply the block to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount>
+			operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+	};
+
+	/**
+	 * @brief     Factory for phase estimation blocks of a gate.
+	 *
+	 * @tparam PhaseQBitCount   Number of phase (precision) qubits.
+	 * @tparam TargetQBitCount  Number of qubits of the estimated gate.
+	 *
+	 * The gate's matrix is squared PhaseQBitCount - 1 times on construction, and its qubits
+	 * become the target register.
+	 *
+	 * Example: 8 bits of the phase of RZ(θ) on qubit 8
+	 *   PhaseEstimation<8, 1>(ParametricGate<Gates::RZ>(theta).toBits(8)).toBits(0, 1, 2, 3, 4, 5, 6, 7)
+	 */
+	template<dimension_t PhaseQBitCount, dimension_t TargetQBitCount>
+	struct PhaseEstimation
+	{
+		static constexpr dimension_t TargetDim = ConstexprMath::pow2(TargetQBitCount);
+
+		/// @brief U^(2^k) for every phase qubit k.
+		std::array<matrix_t<TargetDim>, PhaseQBitCount> Powers{};
+
+		/// @brief The target register.
+		qbit_list_t<TargetQBitCount> TargetBits{};
+
+		/// @brief Prepare the block for a gate exposing its matrix and qubits.
+		template<RecordableGate GateType>
+			requires (recorded_qbit_count_v<GateType> == TargetQBitCount)
+		constexpr explicit PhaseEstimation(const GateType& gate) noexcept
+			: Powers(powersOfTwoOf<PhaseQBitCount>(gate.getGateMatrix())), TargetBits(gate.getAffectedBits())
+		{
+		}
+
+		/// @brief Bind the block to its phase register and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr PhaseEstimationOp<PhaseQBitCount, TargetQBitCount> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == PhaseQBitCount);
+			return PhaseEstimationOp<PhaseQBitCount, TargetQBitCount>(Powers,
+				qbit_list_t<PhaseQBitCount>{ static_cast<dimension_t>(qbits)... }, TargetBits);
+		}
+	};
+}
@@ -0,0 +1,258 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+
+#include "core_types.h"
+#include "constexprmath/constexpr_trigon.h"
+#include "quantum_gate_solver.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Diagonal oracle gates defined by a predicate or a phase function over basis indices.
+	///
+	/**
+	 * @details
+	 * A Grover oracle flips the sign of the marked basis states; decomposing it into
+	 * multi-controlled gates costs one sweep per gate. A phase oracle instead takes the
+	 * classical definition directly: a predicate p(x) (|x> -> -|x> if p(x)) or a phase
+	 * function φ(x) (|x> -> e^{iφ(x)} |x>) over the values x of a K-qubit register, bit q of
+	 * x being the q-th qubit the oracle is bound to.
+	 *
+	 * The function is tabulated into an `OracleTable` once: at compile time for the
+	 * `PhaseOracle` / `PhaseFunctionOracle` factories, whose function is a template argument,
+	 * or explicitly with `tabulatePredicate` / `tabulatePhaseFunction` for runtime functions.
+	 * The table also lists the values whose phase is not one, and the oracle is applied in
+	 * a single pass touching only those amplitudes: O(2^n · marked / 2^K) instead of O(gates · 2^n).
+	 *
+	 * The operation refers to its table instead of copying it (tables of wide registers are
+	 * large); a runtime table must outlive the operations bound to it, and binding a
+	 * temporary table does not compile.
+	 */
+
+	/// @brief A tabulated diagonal oracle on QBitCount qubits.
+	template<dimension_t QBitCount>
+	struct OracleTable
+	{
+		static constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		/// The phase of every register value.
+		state_vector_t<Dim> Diagonal{};
+
+		/// The values whose phase is not one, in ascending order.
+		std::array<dimension_t, Dim> Active{};
+		dimension_t ActiveCount = 0;
+
+		/// @brief Rebuild the list of active values from the diagonal.
+		constexpr void collectActive() noexcept
+		{
+			ActiveCount = 0;
+			for (dimension_t x = 0; x < Dim; ++x)
+			{
+				if (Diagonal[x].re != 1.0 || Diagonal[x].im != 0.0)
+					Active[ActiveCount++] = x;
+			}
+		}
+	};
+
+	/// @brief Tabulate a predicate: the phase is -1 where it holds, 1 elsewhere.
+	template<dimension_t QBitCount, typename Predicate>
+		requires std::predicate<const Predicate&, dimension_t>
+	constexpr OracleTable<QBitCount> tabulatePredicate(const Predicate& predicate) noexcept
+	{
+		OracleTable<QBitCount> Table{};
+		for (dimension_t x = 0; x < OracleTable<QBitCount>::Dim; ++x)
+			Table.Diagonal[x] = cplx_t::fromReal(predicate(x) ? -1.0 : 1.0);
+		Table.collectActive();
+		return Table;
+	}
+
+	/// @brief Tabulate a phase function: the phase of value x is e^{iφ(x)}.
+	template<dimension_t QBitCount, typename PhaseFunction>
+		requires std::convertible_to<std::invoke_result_t<const PhaseFunction&, dimension_t>, float_t>
+	constexpr OracleTable<QBitCount> tabulatePhaseFunction(const PhaseFunction& phase) noexcept
+	{
+		OracleTable<QBitCount> Table{};
+		for (dimension_t x = 0; x < OracleTable<QBitCount>::Dim; ++x)
+		{
+			const float_t Phi = static_cast<float_t>(phase(x));
+			Table.Diagonal[x] = (Phi == 0.0) ? cplx_t::fromReal(1.0) : cplx_t(ConstexprMath::cos(Phi), ConstexprMath::sin(Phi));
+		}
+		Table.collectActive();
+		return Table;
+	}
+
+	/**
+	 * @brief     Application of a tabulated diagonal oracle to a specific set of qubits.
+	 *
+	 * @tparam QBitCount  Number of qubits of the oracle's register.
+	 */
+	template<dimension_t QBitCount>
+	class PhaseOracleOp
+	{
+		/// @brief Local index bits resolved by the low offset table; the rest by the high one.
+		static constexpr dimension_t LowQBitCount = QBitCount / 2;
+		static constexpr dimension_t HighQBitCount = QBitCount - LowQBitCount;
+
+		/// @brief The tabulated oracle (not owned).
+		const OracleTable<QBitCount>& Table;
+
+		/// @brief Fixed-size list of qubit indices the register is bound to.
+		const qbit_list_t<QBitCount> AffectedBits;
+
+		/**
+		 * @brief     Multiply the active amplitudes of a range by their phase (or its conjugate).
+		 *
+		 * The global offset of a register value is split into the offsets of its low and high
+		 * halves, so wide registers need two tables of 2^(K/2) offsets instead of one of 2^K.
+		 */
+		template<dimension_t StateCount>
+		constexpr void applyPhases(StateVector<StateCount>& state, const qbit_list_t<QBitCount>& affectedBits,
+			dimension_t firstIndex, dimension_t lastIndex, bool conjugate) const noexcept
+		{
+			if (Table.ActiveCount == 0)
+				return;
+
+			std::array<dimension_t, ConstexprMath::pow2(LowQBitCount)> LowOffsets{};
+			for (dimension_t i = 0; i < LowOffsets.size(); ++i)
+				for (dimension_t q = 0; q < LowQBitCount; ++q)
+					LowOffsets[i] |= ((i >> q) & 1) << affectedBits[q];
+
+			std::array<dimension_t, ConstexprMath::pow2(HighQBitCount)> HighOffsets{};
+			for (dimension_t i = 0; i < HighOffsets.size(); ++i)
+				for (dimension_t q = 0; q < HighQBitCount; ++q)
+					HighOffsets[i] |= ((i >> q) & 1) << affectedBits[LowQBitCount + q];
+
+			qbit_list_t<QBitCount> SortedBits = affectedBits;
+			std::sort(SortedBits.begin(), SortedBits.end());
+
+			const dimension_t BlockCount = (lastIndex - firstIndex) / OracleTable<QBitCount>::Dim;
+			for (dimension_t block = 0; block < BlockCount; ++block)
+			{
+				// Insert a zero bit at every affected position (ascending order)
+				dimension_t Base = block;
+				for (dimension_t q = 0; q < QBitCount; ++q)
+				{
+					const dimension_t LowMask = (dimension_t(1) << SortedBits[q]) - 1;
+					Base = ((Base & ~LowMask) << 1) | (Base & LowMask);
+				}
+				Base += firstIndex;
+
+				for (dimension_t a = 0; a < Table.ActiveCount; ++a)
+				{
+					const dimension_t x = Table.Active[a];
+					const dimension_t Offset = LowOffsets[x & (LowOffsets.size() - 1)] | HighOffsets[x >> LowQBitCount];
+					cplx_t& Amplitude = state.m_StateVector[Base + Offset];
+					Amplitude = (conjugate ? Table.Diagonal[x].conj() : Table.Diagonal[x]) * Amplitude;
+				}
+			}
+		}
+
+	public:
+		/// @brief Bind a tabulated oracle to a register; the table must outlive the operation.
+		constexpr PhaseOracleOp(const OracleTable<QBitCount>& table, const qbit_list_t<QBitCount>& affectedBits) noexcept
+			: Table(table), AffectedBits(affectedBits)
+		{
+		}
+
+		/// @brief Binding a temporary table would leave the operation dangling.
+		PhaseOracleOp(const OracleTable<QBitCount>&& table, const qbit_list_t<QBitCount>& affectedBits) = delete;
+
+		/// @brief Get the tabulated oracle.
+		constexpr const OracleTable<QBitCount>& getTable() const noexcept
+		{
+			return Table;
+		}
+
+		/// @brief Get the list of qubit indices the oracle acts on.
+		constexpr const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Get the bit mask of the qubits the oracle acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return qbitMask(AffectedBits);
+		}
+
+		/// @brief Apply the oracle in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			applyPhases(state, layout.map(AffectedBits), firstIndex, lastIndex, false);
+		}
+
+		/// @brief Apply the oracle in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyPhases(state, AffectedBits, 0, StateCount, false);
+		}
+
+		/// @brief Apply the inverse oracle (conjugate phases) in place to a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyPhases(state, AffectedBits, 0, StateCount, true);
+		}
+
+		/// @brief Apply the oracle to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount>
+			operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+	};
+
+	/**
+	 * @brief     Factory for sign-flip oracles from a constexpr predicate, tabulated at compile time.
+	 *
+	 * @tparam QBitCount  Number of qubits of the register.
+	 * @tparam Predicate  Callable as `bool(dimension_t)`; marks the values whose sign is flipped.
+	 *
+	 * Example: the Grover oracle marking x = 5 on qubits 0..3
+	 *   PhaseOracle<4, [](dimension_t x) { return x == 5; }>().toBits(0, 1, 2, 3)
+	 */
+	template<dimension_t QBitCount, auto Predicate>
+		requires std::predicate<decltype(Predicate), dimension_t>
+	struct PhaseOracle
+	{
+		static constexpr OracleTable<QBitCount> Table = tabulatePredicate<QBitCount>(Predicate);
+
+		/// @brief Bind the oracle to its register and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr PhaseOracleOp<QBitCount> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == QBitCount);
+			return PhaseOracleOp<QBitCount>(Table, qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+
+	/**
+	 * @brief     Factory for phase oracles from a constexpr phase function, tabulated at compile time.
+	 *
+	 * @tparam QBitCount  Number of qubits of the register.
+	 * @tparam Phase      Callable as `float_t(dimension_t)`; the angle φ(x) of |x> -> e^{iφ(x)} |x>.
+	 */
+	template<dimension_t QBitCount, auto Phase>
+		requires std::convertible_to<std::invoke_result_t<decltype(Phase), dimension_t>, float_t>
+	struct PhaseFunctionOracle
+	{
+		static constexpr OracleTable<QBitCount> Table = tabulatePhaseFunction<QBitCount>(Phase);
+
+		/// @brief Bind the oracle to its register and return an operation.
+		template<std::convertible_to<dimension_t>... QBits>
+		constexpr PhaseOracleOp<QBitCount> toBits(QBits... qbits) const
+		{
+			static_assert(sizeof...(qbits) == QBitCount);
+			return PhaseOracleOp<QBitCount>(Table, qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
+		}
+	};
+}
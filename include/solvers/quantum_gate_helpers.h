@@ -12,7 +12,10 @@ namespace KetCat::QCC
      *  - Type trait `is_gate_matrix` to identify gate matrix types.
      *  - `apply_unitary` : constexpr matrix-vector multiplication (used to apply a local gate).
      *  - `is_valid_square_matrix` : compile-time check for square matrices with power-of-two size.
+     *  - `adjointMatrix`, `multiplyMatrices` : small dense matrix algebra on gate matrices.
+     *  - `convertMatrix` : change the precision of a gate matrix.
      *  - `is_unitary` : constexpr runtime/checkable check that a matrix is unitary.
+     *  - `is_hermitian` : constexpr check that a matrix is Hermitian (observables).
      */
 
      /// @brief  Type trait to check if a type is a gate matrix:
@@ -49,55 +52,98 @@ namespace KetCat::QCC
     template<typename T>
     inline constexpr bool is_1_qbit_gate_matrix_v = is_1_qbit_gate_matrix<T>::value;
 
+    /// @brief  Computes the conjugate transpose (Hermitian adjoint) of a square matrix.
+    /// @tparam Dim     Dimension of the square matrix.
+    /// @param mat      The matrix.
+    /// @return         mat^†, i.e. the inverse of mat if mat is unitary.
+    template<dimension_t Dim, precision_type Real>
+    constexpr matrix_t<Dim, Real> adjointMatrix(const matrix_t<Dim, Real>& mat) noexcept
+    {
+        matrix_t<Dim, Real> Adjoint{};
+        for (dimension_t i = 0; i < Dim; ++i)
+            for (dimension_t j = 0; j < Dim; ++j)
+                Adjoint[i][j] = mat[j][i].conj();
+        return Adjoint;
+    }
+
+    /// @brief  Converts a matrix to another precision (gate matrices are defined in double).
+    template<precision_type To, dimension_t Dim, precision_type From>
+    constexpr matrix_t<Dim, To> convertMatrix(const matrix_t<Dim, From>& mat) noexcept
+    {
+        matrix_t<Dim, To> Converted{};
+        for (dimension_t i = 0; i < Dim; ++i)
+            for (dimension_t j = 0; j < Dim; ++j)
+                Converted[i][j] = complex_t<To>(static_cast<To>(mat[i][j].re), static_cast<To>(mat[i][j].im));
+        return Converted;
+    }
+
+    /// @brief  Computes the product of two square matrices.
+    /// @return A · B
+    template<dimension_t Dim>
+    constexpr matrix_t<Dim> multiplyMatrices(const matrix_t<Dim>& A, const matrix_t<Dim>& B) noexcept
+    {
+        matrix_t<Dim> Product{};
+        for (dimension_t i = 0; i < Dim; ++i)
+            for (dimension_t k = 0; k < Dim; ++k)
+                for (dimension_t j = 0; j < Dim; ++j)
+                    Product[i][j] += A[i][k] * B[k][j];
+        return Product;
+    }
+
+    /// @brief  Checks whether two matrices are equal element-wise within an absolute tolerance.
+    template<dimension_t Dim>
+    constexpr bool matricesEqual(const matrix_t<Dim>& A, const matrix_t<Dim>& B, float_t epsilon = 1E-9) noexcept
+    {
+        for (dimension_t i = 0; i < Dim; ++i)
+            for (dimension_t j = 0; j < Dim; ++j)
+            {
+                if (ConstexprMath::abs(A[i][j].re - B[i][j].re) > epsilon ||
+                    ConstexprMath::abs(A[i][j].im - B[i][j].im) > epsilon)
+                    return false;
+            }
+        return true;
+    }
+
     /// @brief  Checks whether a provided square complex matrix is unitary.
     /// @tparam Dim     Dimension of the square matrix (2^k).
     /// @param mat      The matrix to check.
-    /// @return         True if mat * mat^� equals the identity, false otherwise.
+    /// @return         True if mat^† * mat equals the identity, false otherwise.
     ///
     /// @details
     /// This function computes the conjugate transpose (Hermitian adjoint) of `mat`,
-    /// multiplies `mat` by its conjugate transpose and verifies that the product is
-    /// equal to the identity matrix within exact arithmetic. Because this routine
-    /// uses exact float_t checks for equality of re/im components, it is intended
-    /// for constexpr / compile-time constructed matrices used as gates.
+    /// multiplies it with `mat` and verifies that the product is equal to the identity
+    /// matrix within a small tolerance. It is intended for constexpr / compile-time
+    /// constructed matrices used as gates.
     template<auto M>
     constexpr bool is_unitary()
     {
         // Get the matrix dimension from the type trait
         constexpr dimension_t Dim = is_gate_matrix<std::remove_cvref_t<decltype(M)>>::dim;
 
-        // Epsilon for floating-point comparison
-        constexpr float_t Epsilon = 1E-9;
-
-        // Check unitarity: M * M^� == I
-        for (dimension_t i = 0; i < Dim; i++)
-            for (dimension_t j = 0; j < Dim; j++)
-            {
-                cplx_t Sum{ 0,0 };
-                for (dimension_t k = 0; k < Dim; k++)
-                    Sum = Sum + M[k][i].conj() * M[k][j];
+        // Check unitarity: M^† * M == I
+        matrix_t<Dim> Identity{};
+        for (dimension_t i = 0; i < Dim; ++i)
+            Identity[i][i] = cplx_t::fromReal(1.0);
 
-                constexpr auto abs = [](float_t v) -> float_t
-                {
-                    return (v < 0.0) ? -v : v;
-                };
+        return matricesEqual(multiplyMatrices(adjointMatrix(M), M), Identity);
+    }
 
-                if (i == j && (abs(Sum.re - 1) > Epsilon || abs(Sum.im) > Epsilon))
-                    return false;
-                if (i != j && (abs(Sum.re) > Epsilon || abs(Sum.im) > Epsilon))
-                    return false;
-            }
-        return true;
+    /// @brief  Checks whether a provided square complex matrix is Hermitian (mat == mat^†).
+    /// @details Used to validate observables at compile time.
+    template<auto M>
+    constexpr bool is_hermitian()
+    {
+        return matricesEqual(adjointMatrix(M), M);
     }
 
     /// @brief  Applies a unitary matrix to a state vector via matrix-vector multiplication.
-    template<dimension_t Dim>
-    constexpr state_vector_t<Dim>
-        applyUnitary(const matrix_t<Dim>& U,
-            const state_vector_t<Dim>& v) noexcept
+    template<dimension_t Dim, precision_type Real>
+    constexpr state_vector_t<Dim, Real>
+        applyUnitary(const matrix_t<Dim, Real>& U,
+            const state_vector_t<Dim, Real>& v) noexcept
     {
         // Result initialized to zero amplitudes
-        state_vector_t<Dim> Result{ cplx_t::zero() };
+        state_vector_t<Dim, Real> Result{};
 
         // Standard matrix-vector product:
         // result[i] = sum_j U[i][j] * v[j]
@@ -1,6 +1,7 @@
 #pragma once
 #include "core_types.h"
 #include "quantum_gate_helpers.h"
+#include "qubit_layout.h"
 #include "wavefunction/state_vector.h"
 
 
@@ -11,10 +12,284 @@ namespace KetCat::QCC
 		requires (is_gate_matrix_v<std::remove_cvref_t<decltype(GateMatrix)>>&& is_unitary<GateMatrix>())
 	struct QuantumGate;
 
+	/// @brief  Compute the bit mask of a list of qubit indices.
+	template<dimension_t QBitCount>
+	constexpr dimension_t qbitMask(const qbit_list_t<QBitCount>& qbits) noexcept
+	{
+		dimension_t Mask = 0;
+		for (dimension_t q : qbits)
+		{
+			Mask |= (dimension_t(1) << q);
+		}
+		return Mask;
+	}
+
+	/**
+	 * @brief     Index helper enumerating the blocks a k-qubit gate decomposes the state into.
+	 *
+	 * @tparam QBitCount  Number of qubits the gate acts on.
+	 *
+	 * Each block corresponds to a fixed assignment of the unaffected qubits; the affected
+	 * qubits span the local 2^QBitCount basis inside each block. Block bases (indices where
+	 * all targeted qubits are zero) are enumerated directly by inserting zero bits at the
+	 * affected positions into a running block counter, and the local-to-global offsets are
+	 * precomputed once, so no index is visited twice.
+	 */
+	template<dimension_t QBitCount>
+	struct GateBlockIndexer
+	{
+		/// @brief Number of amplitudes in one block.
+		static constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		/// @brief Global offset of every local basis state |b0 b1 ... bk-1> inside a block.
+		std::array<dimension_t, Dim> Offsets{};
+
+		/// @brief Affected bit positions in ascending order.
+		qbit_list_t<QBitCount> SortedBits{};
+
+		/// @brief Precompute offsets and sorted bit positions for the given qubits.
+		/// @param affectedBits  The global qubit indices; local bit q maps to affectedBits[q].
+		constexpr explicit GateBlockIndexer(const qbit_list_t<QBitCount>& affectedBits) noexcept
+			: SortedBits(affectedBits)
+		{
+			for (dimension_t i = 0; i < Dim; ++i)
+			{
+				// Map local basis |b0 b1 ... bk-1> to physical qubits affectedBits[]
+				for (dimension_t q = 0; q < QBitCount; ++q)
+				{
+					if (i & (dimension_t(1) << q))
+					{
+						Offsets[i] |= (dimension_t(1) << affectedBits[q]);
+					}
+				}
+			}
+
+			for (dimension_t i = 1; i < QBitCount; ++i)
+			{
+				for (dimension_t j = i; j > 0 && SortedBits[j - 1] > SortedBits[j]; --j)
+				{
+					const dimension_t Tmp = SortedBits[j];
+					SortedBits[j] = SortedBits[j - 1];
+					SortedBits[j - 1] = Tmp;
+				}
+			}
+		}
+
+		/// @brief Base index of the given block (all affected qubits zero).
+		constexpr dimension_t base(dimension_t block) const noexcept
+		{
+			// Insert a zero bit at every affected position (ascending order)
+			dimension_t Base = block;
+			for (dimension_t q = 0; q < QBitCount; ++q)
+			{
+				const dimension_t LowMask = (dimension_t(1) << SortedBits[q]) - 1;
+				Base = ((Base & ~LowMask) << 1) | (Base & LowMask);
+			}
+			return Base;
+		}
+	};
+
+	/**
+	 * @brief     Apply a k-qubit matrix in place to a range of a global state vector.
+	 *
+	 * @tparam QBitCount   Number of qubits the matrix acts on.
+	 * @tparam StateCount  Dimension of the global state vector.
+	 * @tparam Real        Precision of the state and the matrix.
+	 * @param state        The global state vector, updated in place.
+	 * @param U            The 2^QBitCount × 2^QBitCount matrix to apply.
+	 * @param affectedBits The global qubit indices; local bit q maps to affectedBits[q].
+	 * @param firstIndex   First amplitude index of the processed range.
+	 * @param lastIndex    One past the last amplitude index of the processed range.
+	 *
+	 * For each block (see `GateBlockIndexer`) we:
+	 *  1) gather the local amplitudes into `LocalIn`,
+	 *  2) compute `LocalOut = U * LocalIn`,
+	 *  3) write `LocalOut` back into the corresponding positions of the global state.
+	 *
+	 * The matrix does not need to be unitary, which lets observables and derivative
+	 * operators reuse the same kernel.
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount, precision_type Real>
+	constexpr void applyGateMatrix(StateVector<StateCount, Real>& state,
+		const matrix_t<ConstexprMath::pow2(QBitCount), Real>& U,
+		const qbit_list_t<QBitCount>& affectedBits,
+		dimension_t firstIndex = 0, dimension_t lastIndex = StateCount) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		const GateBlockIndexer<QBitCount> Indexer(affectedBits);
+		const dimension_t BlockCount = (lastIndex - firstIndex) / Dim;
+
+		for (dimension_t block = 0; block < BlockCount; ++block)
+		{
+			const dimension_t Base = firstIndex + Indexer.base(block);
+
+			// Gather local (2^k) amplitudes
+			state_vector_t<Dim, Real> LocalIn{};
+			for (dimension_t i = 0; i < Dim; ++i)
+			{
+				LocalIn[i] = state.m_StateVector[Base + Indexer.Offsets[i]];
+			}
+
+			// Apply k-qubit matrix in the local subspace
+			const state_vector_t<Dim, Real> LocalOut = applyUnitary(U, LocalIn);
+
+			// Scatter results back to the full statevector
+			for (dimension_t i = 0; i < Dim; ++i)
+			{
+				state.m_StateVector[Base + Indexer.Offsets[i]] = LocalOut[i];
+			}
+		}
+	}
+
+	/**
+	 * @brief     Apply a diagonal k-qubit matrix in place to a range of a global state vector.
+	 *
+	 * @tparam QBitCount   Number of qubits the matrix acts on.
+	 * @tparam StateCount  Dimension of the global state vector.
+	 * @param state        The global state vector, updated in place.
+	 * @param diagonal     The 2^QBitCount diagonal entries of the matrix.
+	 * @param affectedBits The global qubit indices; local bit q maps to affectedBits[q].
+	 * @param firstIndex   First amplitude index of the processed range.
+	 * @param lastIndex    One past the last amplitude index of the processed range.
+	 *
+	 * Diagonal gates never mix amplitudes, so every amplitude is just multiplied by the
+	 * entry of its local basis state; entries equal to one are skipped altogether
+	 * (a controlled phase only touches a quarter of the state).
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount>
+	constexpr void applyDiagonalMatrix(StateVector<StateCount>& state,
+		const state_vector_t<ConstexprMath::pow2(QBitCount)>& diagonal,
+		const qbit_list_t<QBitCount>& affectedBits,
+		dimension_t firstIndex = 0, dimension_t lastIndex = StateCount) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		const GateBlockIndexer<QBitCount> Indexer(affectedBits);
+		const dimension_t BlockCount = (lastIndex - firstIndex) / Dim;
+
+		// Collect the local basis states whose entry is not one
+		std::array<dimension_t, Dim> Active{};
+		dimension_t ActiveCount = 0;
+		for (dimension_t i = 0; i < Dim; ++i)
+		{
+			if (diagonal[i].re != 1.0 || diagonal[i].im != 0.0)
+				Active[ActiveCount++] = i;
+		}
+
+		for (dimension_t block = 0; block < BlockCount; ++block)
+		{
+			const dimension_t Base = firstIndex + Indexer.base(block);
+			for (dimension_t a = 0; a < ActiveCount; ++a)
+			{
+				cplx_t& Amplitude = state.m_StateVector[Base + Indexer.Offsets[Active[a]]];
+				Amplitude = diagonal[Active[a]] * Amplitude;
+			}
+		}
+	}
+
+	/**
+	 * @brief     Apply a k-qubit matrix, controlled by one qubit, in place to a range of a global state vector.
+	 *
+	 * @tparam QBitCount   Number of target qubits the matrix acts on.
+	 * @tparam StateCount  Dimension of the global state vector.
+	 * @param state        The global state vector, updated in place.
+	 * @param U            The 2^QBitCount × 2^QBitCount matrix applied where the control is set.
+	 * @param controlBit   The global index of the control qubit.
+	 * @param targetBits   The global target qubit indices; local bit q maps to targetBits[q].
+	 * @param firstIndex   First amplitude index of the processed range.
+	 * @param lastIndex    One past the last amplitude index of the processed range.
+	 *
+	 * Only the half of every block with the control set is gathered and multiplied, instead
+	 * of applying the 2^(k+1)-dimensional controlled matrix to the whole block.
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount>
+	constexpr void applyControlledGateMatrix(StateVector<StateCount>& state,
+		const matrix_t<ConstexprMath::pow2(QBitCount)>& U,
+		dimension_t controlBit, const qbit_list_t<QBitCount>& targetBits,
+		dimension_t firstIndex = 0, dimension_t lastIndex = StateCount) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		qbit_list_t<QBitCount + 1> AffectedBits{ controlBit };
+		for (dimension_t q = 0; q < QBitCount; ++q)
+			AffectedBits[q + 1] = targetBits[q];
+
+		const GateBlockIndexer<QBitCount + 1> Indexer(AffectedBits);
+		const dimension_t BlockCount = (lastIndex - firstIndex) / (2 * Dim);
+
+		for (dimension_t block = 0; block < BlockCount; ++block)
+		{
+			const dimension_t Base = firstIndex + Indexer.base(block);
+
+			// Local indices 2i + 1: control set, targets in state i
+			state_vector_t<Dim> LocalIn{};
+			for (dimension_t i = 0; i < Dim; ++i)
+				LocalIn[i] = state.m_StateVector[Base + Indexer.Offsets[2 * i + 1]];
+
+			const state_vector_t<Dim> LocalOut = applyUnitary(U, LocalIn);
+
+			for (dimension_t i = 0; i < Dim; ++i)
+				state.m_StateVector[Base + Indexer.Offsets[2 * i + 1]] = LocalOut[i];
+		}
+	}
+
+	/**
+	 * @brief     Apply a k-qubit phase-permutation matrix in place to a range of a global state vector.
+	 *
+	 * @tparam QBitCount   Number of qubits the matrix acts on.
+	 * @tparam StateCount  Dimension of the global state vector.
+	 * @param state        The global state vector, updated in place.
+	 * @param U            The matrix; every column must hold one non-zero entry (X, CX, Toffoli, SWAP, phases).
+	 * @param affectedBits The global qubit indices; local bit q maps to affectedBits[q].
+	 * @param firstIndex   First amplitude index of the processed range.
+	 * @param lastIndex    One past the last amplitude index of the processed range.
+	 *
+	 * Local basis state j is moved to the row of its column's non-zero entry and multiplied
+	 * by that entry: 2^k products per block instead of the 4^k of `applyGateMatrix`.
+	 */
+	template<dimension_t QBitCount, dimension_t StateCount>
+	constexpr void applyPhasePermutationMatrix(StateVector<StateCount>& state,
+		const matrix_t<ConstexprMath::pow2(QBitCount)>& U,
+		const qbit_list_t<QBitCount>& affectedBits,
+		dimension_t firstIndex = 0, dimension_t lastIndex = StateCount) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		// Image and phase of every local basis state: the largest entry of its column
+		std::array<dimension_t, Dim> Rows{};
+		state_vector_t<Dim> Phases{};
+		for (dimension_t j = 0; j < Dim; ++j)
+		{
+			for (dimension_t i = 1; i < Dim; ++i)
+			{
+				if (U[i][j].normSquared() > U[Rows[j]][j].normSquared())
+					Rows[j] = i;
+			}
+			Phases[j] = U[Rows[j]][j];
+		}
+
+		const GateBlockIndexer<QBitCount> Indexer(affectedBits);
+		const dimension_t BlockCount = (lastIndex - firstIndex) / Dim;
+
+		for (dimension_t block = 0; block < BlockCount; ++block)
+		{
+			const dimension_t Base = firstIndex + Indexer.base(block);
+
+			state_vector_t<Dim> LocalIn{};
+			for (dimension_t j = 0; j < Dim; ++j)
+				LocalIn[j] = state.m_StateVector[Base + Indexer.Offsets[j]];
+
+			for (dimension_t j = 0; j < Dim; ++j)
+				state.m_StateVector[Base + Indexer.Offsets[Rows[j]]] = Phases[j] * LocalIn[j];
+		}
+	}
+
 	/**
 	 * @brief     Represents an application of a quantum gate to a specific set of qubits.
 	 *
 	 * @tparam QBitCount  Number of qubits the gate matrix acts on (compile-time).
+	 * @tparam Real       Precision of the matrix and of the state vectors the gate applies to.
 	 *
 	 * This class is a lightweight, non-copyable, non-movable handle that stores
 	 * a compile-time sized unitary matrix for the gate and a fixed list of
@@ -22,7 +297,7 @@ namespace KetCat::QCC
 	 * applies the gate to the specified qubits and returns the transformed
 	 * global state vector (functional style).
 	 */
-	template<dimension_t QBitCount>
+	template<dimension_t QBitCount, precision_type Real = float_t>
 	class QuantumGateOp
 	{
 		/**
@@ -30,7 +305,7 @@ namespace KetCat::QCC
 		 *
 		 * Size: 2^QBitCount × 2^QBitCount. Stored as a compile-time sized matrix type.
 		 */
-		const matrix_t<ConstexprMath::pow2(QBitCount)> GateMatrix;
+		const matrix_t<ConstexprMath::pow2(QBitCount), Real> GateMatrix;
 
 		/**
 		 * @brief  Fixed-size list of qubit indices affected by this gate.
@@ -57,7 +332,7 @@ namespace KetCat::QCC
 		 * Static assertions verify matrix shape and unitarity at compile-time where possible.
 		 */
 		constexpr QuantumGateOp(
-			const matrix_t<ConstexprMath::pow2(QBitCount)>& U,
+			const matrix_t<ConstexprMath::pow2(QBitCount), Real>& U,
 			const qbit_list_t<QBitCount>& affectedBits)
 			: GateMatrix(U), AffectedBits(affectedBits)
 		{
@@ -72,107 +347,74 @@ namespace KetCat::QCC
 		friend struct QuantumGate;
 
 	public:
+		/// @brief Get the unitary matrix of the gate.
+		constexpr const matrix_t<ConstexprMath::pow2(QBitCount), Real>& getGateMatrix() const noexcept
+		{
+			return GateMatrix;
+		}
+
+		/// @brief Get the list of qubit indices the gate acts on.
+		constexpr const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+
+		/// @brief Get the bit mask of the qubits the gate acts on (its support).
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return qbitMask(AffectedBits);
+		}
+
 		/**
-		 * @brief     Apply the stored gate to a global state vector and return the result.
+		 * @brief     Apply the stored gate in place to a contiguous range of a global state vector.
 		 *
 		 * @tparam StateCount  Dimension of the global state vector (2^number_of_global_qubits).
-		 * @param state        The input global state vector (passed by value — functional style).
-		 * @return             A new global state vector with the gate applied to `affectedBits`.
-		 *
-		 * The algorithm partitions the global state into independent blocks of size 2^QBitCount.
-		 * Each block corresponds to a fixed assignment of the unaffected qubits; the affected
-		 * qubits span the local 2^QBitCount basis inside each block. For each block we:
-		 *  1) gather the local amplitudes into `localIn`,
-		 *  2) compute `localOut = gatematrix_t * localIn`,
-		 *  3) write `localOut` back into the corresponding positions of the global state.
+		 * @param state        The global state vector, updated in place.
+		 * @param layout       Logical-to-physical qubit layout the state is currently stored in.
+		 * @param firstIndex   First amplitude index of the range (aligned to the range size).
+		 * @param lastIndex    One past the last amplitude index of the range.
 		 *
-		 * Only indices where all targeted qubits are zero are treated as block "bases" to avoid
-		 * redundant processing.
+		 * The range must be closed under the gate, i.e. all affected (physical) qubits must lie
+		 * below log2(lastIndex - firstIndex). This is what allows the cache-blocked scheduler
+		 * to run several gates on one cache tile before moving on to the next one.
 		 */
 		template<dimension_t StateCount>
-		constexpr StateVector<StateCount>
-			operator()(StateVector<StateCount> state) const
+		constexpr void applyInPlace(StateVector<StateCount, Real>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
 		{
-			constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
-
-			StateVector<StateCount> Result = state;
-
-			// ------------------------------------------------------------
-			// Precompute masks for affected qubits
-			// ------------------------------------------------------------
-
-			dimension_t AffectedMask = 0;
-			std::array<dimension_t, QBitCount> BitPos{};
-
-			for (dimension_t i = 0; i < QBitCount; ++i) {
-				BitPos[i] = AffectedBits[i];
-				AffectedMask |= (dimension_t(1) << BitPos[i]);
-			}
-
-			// ------------------------------------------------------------
-			// Iterate over all block bases
-			// Each base corresponds to one fixed configuration of
-			// the non-affected qubits
-			// ------------------------------------------------------------
-
-			for (dimension_t base = 0; base < StateCount; ++base) {
-
-				// Only process each block once:
-				// base must have all affected qubits = 0
-				if (base & AffectedMask)
-					continue;
-
-				// --------------------------------------------------------
-				// Gather local (2^k) amplitudes
-				// --------------------------------------------------------
-
-				state_vector_t<Dim> LocalIndices{};
-
-				for (dimension_t i = 0; i < Dim; ++i)
-				{
-					dimension_t GlobalIndex = base;
-
-					// Map local basis |b0 b1 ... bk-1>
-					// to physical qubits affectedBits[]
-					for (dimension_t q = 0; q < QBitCount; ++q)
-					{
-						if (i & (dimension_t(1) << q))
-						{
-							GlobalIndex |= (dimension_t(1) << BitPos[q]);
-						}
-					}
-
-					LocalIndices[i] = Result[GlobalIndex];
-				}
-
-				// --------------------------------------------------------
-				// Apply k-qubit unitary in the local subspace
-				// --------------------------------------------------------
-
-				const state_vector_t<Dim> LocalOut =
-					applyUnitary(GateMatrix, LocalIndices);
-
-				// --------------------------------------------------------
-				// Scatter results back to the full statevector
-				// --------------------------------------------------------
-
-				for (dimension_t i = 0; i < Dim; ++i)
-				{
-					dimension_t GlobalIndex = base;
+			applyGateMatrix<QBitCount>(state, GateMatrix, layout.map(AffectedBits), firstIndex, lastIndex);
+		}
 
-					for (dimension_t q = 0; q < QBitCount; ++q)
-					{
-						if (i & (dimension_t(1) << q))
-						{
-							GlobalIndex |= (dimension_t(1) << BitPos[q]);
-						}
-					}
+		/// @brief Apply the stored gate in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount, Real>& state) const noexcept
+		{
+			applyGateMatrix<QBitCount>(state, GateMatrix, AffectedBits);
+		}
 
-					Result[GlobalIndex] = LocalOut[i];
-				}
-			}
+		/// @brief Apply the inverse gate U^† in place to a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount, Real>& state) const noexcept
+		{
+			applyGateMatrix<QBitCount>(state, adjointMatrix(GateMatrix), AffectedBits);
+		}
 
-			return Result;
+		/**
+		 * @brief     Apply the stored gate to a global state vector and return the result.
+		 *
+		 * @tparam StateCount  Dimension of the global state vector (2^number_of_global_qubits).
+		 * @param state        The input global state vector (passed by value — functional style).
+		 * @return             A new global state vector with the gate applied to `affectedBits`.
+		 *
+		 * See `applyGateMatrix` for the block decomposition used by the kernel.
+		 */
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount, Real>
+			operator()(StateVector<StateCount, Real> state) const
+		{
+			applyInPlace(state);
+			return state;
 		}
 	};
 
@@ -200,21 +442,23 @@ namespace KetCat::QCC
 		/**
 		 * @brief     Bind this gate to a list of qubit indices and return an operation.
 		 *
+		 * @tparam Real   Precision of the state vectors the gate applies to (double by default).
 		 * @tparam QBits  Variadic list of indices convertible to `dimension_t`. The
 		 *                number of provided indices must equal `QBitCount`.
 		 * @param qbits   The qubit indices to which the gate will be applied.
-		 * @return         A `QuantumGateOp<QBitCount>` object ready to apply the gate.
+		 * @return         A `QuantumGateOp<QBitCount, Real>` object ready to apply the gate.
 		 *
 		 * Example:
 		 *   auto h2 = QuantumGate<1>(HADAMARD).toBits(1);
+		 *   auto h2f = QuantumGate<1>(HADAMARD).toBits<float>(1);  // for StateVector<N, float>
 		 */
-		template<std::convertible_to<dimension_t>... QBits>
-		constexpr QuantumGateOp<QBitCount> toBits(QBits... qbits) const
+		template<precision_type Real = float_t, std::convertible_to<dimension_t>... QBits>
+		constexpr QuantumGateOp<QBitCount, Real> toBits(QBits... qbits) const
 		{
 			static_assert(sizeof...(qbits) == QBitCount);
 			//static_assert(is_valid_square_matrix(GateMatrix), "The provided matrix is not a valid square matrix.");
 		   // static_assert(is_unitary(GateMatrix), "The provided matrix is not unitary.");
-			return QuantumGateOp<QBitCount>(GateMatrix, qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
+			return QuantumGateOp<QBitCount, Real>(convertMatrix<Real>(GateMatrix), qbit_list_t<QBitCount>{ static_cast<dimension_t>(qbits)... });
 		}
 	};
 
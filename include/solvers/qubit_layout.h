@@ -0,0 +1,191 @@
+#pragma once
+#include <bit>
+#include <utility>
+
+#include "core_types.h"
+#include "wavefunction/state_vector.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Logical-to-physical qubit mapping used by the executor to keep hot qubits in low bit positions.
+    ///
+    /**
+     * @details
+     * A gate on qubit q touches amplitude pairs 2^q apart. For high q this defeats both
+     * the cache and the TLB, and such gates cannot take part in cache-blocked execution.
+     * The executor may therefore store the state in a *physical* qubit order that differs
+     * from the *logical* one used by the circuit. `QubitLayout` records that permutation,
+     * maps gate supports into physical positions and `permuteQubits` performs the global
+     * bit-permutation (transpose) pass when the layout changes.
+     *
+     * The executor always restores the identity layout before the state is handed out,
+     * so measurement and visualisation code only ever sees logical order.
+     */
+
+    /// @brief Number of qubits spanned by a state vector of the given dimension.
+    template<dimension_t StateCount>
+    constexpr dimension_t QBitCountOf = static_cast<dimension_t>(std::bit_width(StateCount) - 1);
+
+    /// @brief Permutation between logical qubits and physical bit positions of the state vector.
+    /// @tparam QBitCount  Number of qubits.
+    template<dimension_t QBitCount>
+    struct QubitLayout
+    {
+        /// Physical bit position of every logical qubit.
+        qbit_list_t<QBitCount> LogicalToPhysical = identityPermutation();
+
+        /// @brief The identity permutation 0, 1, ..., QBitCount-1.
+        static constexpr qbit_list_t<QBitCount> identityPermutation() noexcept
+        {
+            qbit_list_t<QBitCount> Identity{};
+            for (dimension_t q = 0; q < QBitCount; ++q)
+                Identity[q] = q;
+            return Identity;
+        }
+
+        /// @brief Physical bit position of a logical qubit.
+        constexpr dimension_t physical(dimension_t logicalQBit) const noexcept
+        {
+            return (logicalQBit < QBitCount) ? LogicalToPhysical[logicalQBit] : logicalQBit;
+        }
+
+        /// @brief Map a list of logical qubit indices to their physical positions.
+        template<dimension_t ListSize>
+        constexpr qbit_list_t<ListSize> map(const qbit_list_t<ListSize>& logicalQBits) const noexcept
+        {
+            qbit_list_t<ListSize> Physical{};
+            for (dimension_t i = 0; i < ListSize; ++i)
+                Physical[i] = physical(logicalQBits[i]);
+            return Physical;
+        }
+
+        /// @brief Map a logical support mask to the corresponding physical mask.
+        constexpr dimension_t mapMask(dimension_t logicalMask) const noexcept
+        {
+            dimension_t PhysicalMask = 0;
+            for (dimension_t q = 0; q < QBitCount; ++q)
+            {
+                if (logicalMask & (dimension_t(1) << q))
+                    PhysicalMask |= (dimension_t(1) << LogicalToPhysical[q]);
+            }
+
+            // Bits beyond the register (e.g. the all-ones mask of opaque gates) stay put
+            const dimension_t RegisterMask = ConstexprMath::pow2(QBitCount) - 1;
+            return PhysicalMask | (logicalMask & ~RegisterMask);
+        }
+
+        /// @brief Map a physical amplitude index to the logical index it represents.
+        constexpr dimension_t toLogicalIndex(dimension_t physicalIndex) const noexcept
+        {
+            dimension_t LogicalIndex = 0;
+            for (dimension_t q = 0; q < QBitCount; ++q)
+            {
+                if (physicalIndex & (dimension_t(1) << LogicalToPhysical[q]))
+                    LogicalIndex |= (dimension_t(1) << q);
+            }
+            return LogicalIndex;
+        }
+
+        constexpr bool isIdentity() const noexcept
+        {
+            return LogicalToPhysical == identityPermutation();
+        }
+
+        constexpr bool operator==(const QubitLayout&) const noexcept = default;
+    };
+
+    namespace Detail
+    {
+        /**
+         * @brief     Move every bit p of the amplitude indices to bit involution[p], in place.
+         *
+         * The involution pairs up bit positions (or leaves them alone), so the index map is an
+         * involution too: every amplitude either stays or swaps with its partner.
+         */
+        template<dimension_t StateCount>
+        constexpr void applyBitInvolution(StateVector<StateCount>& state,
+            const qbit_list_t<QBitCountOf<StateCount>>& involution) noexcept
+        {
+            constexpr dimension_t QBitCount = QBitCountOf<StateCount>;
+
+            dimension_t MovingBits = 0;
+            for (dimension_t p = 0; p < QBitCount; ++p)
+            {
+                if (involution[p] != p)
+                    MovingBits |= (dimension_t(1) << p);
+            }
+            if (MovingBits == 0)
+                return;
+
+            for (dimension_t index = 0; index < StateCount; ++index)
+            {
+                dimension_t Target = index & ~MovingBits;
+                for (dimension_t p = 0; p < QBitCount; ++p)
+                {
+                    if (index & MovingBits & (dimension_t(1) << p))
+                        Target |= (dimension_t(1) << involution[p]);
+                }
+                if (Target > index)
+                    std::swap(state.m_StateVector[index], state.m_StateVector[Target]);
+            }
+        }
+    }
+
+    /**
+     * @brief     Global bit-permutation pass: re-order the amplitudes from one layout to another.
+     *
+     * @tparam StateCount  Dimension of the state vector.
+     * @param state        The state vector stored in layout `from`, rewritten in layout `to`.
+     * @param from         Current layout of `state`.
+     * @param to           Requested layout.
+     *
+     * Every logical qubit q moves from physical bit from[q] to physical bit to[q]. The pass
+     * works in place: every permutation is the product of two involutions (a rotation
+     * c_i → c_{i+1} of a cycle is the reflection c_i → c_{-i} followed by c_i → c_{1-i}), and
+     * an involution of the bits is applied by swapping amplitude pairs. It therefore costs
+     * at most two sweeps of swaps and no scratch memory.
+     */
+    template<dimension_t StateCount>
+    constexpr void permuteQubits(StateVector<StateCount>& state,
+        const QubitLayout<QBitCountOf<StateCount>>& from,
+        const QubitLayout<QBitCountOf<StateCount>>& to) noexcept
+    {
+        constexpr dimension_t QBitCount = QBitCountOf<StateCount>;
+
+        if (from == to)
+            return;
+
+        // Permutation of the physical bit positions: from[q] goes to to[q]
+        qbit_list_t<QBitCount> Destination = QubitLayout<QBitCount>::identityPermutation();
+        for (dimension_t q = 0; q < QBitCount; ++q)
+            Destination[from.LogicalToPhysical[q]] = to.LogicalToPhysical[q];
+
+        // Split every cycle c_0 → c_1 → ... → c_{k-1} into the two reflections
+        qbit_list_t<QBitCount> First = QubitLayout<QBitCount>::identityPermutation();
+        qbit_list_t<QBitCount> Second = QubitLayout<QBitCount>::identityPermutation();
+        std::array<bool, QBitCount> Visited{};
+        for (dimension_t Start = 0; Start < QBitCount; ++Start)
+        {
+            if (Visited[Start])
+                continue;
+
+            qbit_list_t<QBitCount> Cycle{};
+            dimension_t Length = 0;
+            for (dimension_t p = Start; !Visited[p]; p = Destination[p])
+            {
+                Visited[p] = true;
+                Cycle[Length++] = p;
+            }
+
+            for (dimension_t i = 0; i < Length; ++i)
+            {
+                First[Cycle[i]] = Cycle[(Length - i) % Length];
+                Second[Cycle[i]] = Cycle[(Length + 1 - i) % Length];
+            }
+        }
+
+        Detail::applyBitInvolution(state, First);
+        Detail::applyBitInvolution(state, Second);
+    }
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <vector>
+
+#include "core_types.h"
+#include "wavefunction/state_vector.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Inner products, norms, fidelities and trace distances of state vectors.
+	///
+	/**
+	 * @details
+	 * Verification compares every simulated state against a reference, so these kernels run
+	 * on large batches of states. They read `m_StateVector` directly (`StateVector::operator[]`
+	 * is bounds-checked) and accumulate in a fixed order that does not depend on how the work
+	 * is split:
+	 *  - the state is cut into chunks of `MetricChunkSize` amplitudes;
+	 *  - inside a chunk, `MetricLaneCount` independent accumulators take every
+	 *    MetricLaneCount-th amplitude (no loop-carried dependency, so the loop vectorises)
+	 *    and are added pairwise at the end of the chunk;
+	 *  - chunk sums are combined as a balanced binary tree, built on the fly with one partial
+	 *    sum per tree level.
+	 *
+	 * Aligned blocks of `MetricBlockChunkCount` chunks are complete subtrees, so they are summed
+	 * on hardware threads (serially in constant evaluation and for small states) and merged
+	 * along the same tree afterwards: the result is bit-identical whatever the thread count.
+	 * Pairwise summation also keeps the rounding error at O(log n) instead of O(n) for a
+	 * running sum.
+	 *
+	 * Fidelity and trace distance use the pure-state formulas F = |⟨φ|ψ⟩|² and
+	 * D = sqrt(1 - F), normalising by the norms of both states.
+	 */
+
+	/// @brief Number of amplitudes summed sequentially (per lane) before entering the pairwise tree.
+	constexpr dimension_t MetricChunkSize = 256;
+
+	/// @brief Number of independent accumulators inside a chunk.
+	constexpr dimension_t MetricLaneCount = 4;
+
+	/// @brief Number of chunks in a block, the unit of work of a thread (a power of two).
+	constexpr dimension_t MetricBlockChunkCount = 64;
+
+	/// @brief Minimum number of blocks per thread; smaller sums do not start threads.
+	constexpr dimension_t MetricBlocksPerThread = 4;
+
+	/**
+	 * @brief     Partial sums of a balanced binary tree, built on the fly like a binary counter.
+	 *
+	 * Levels[l] holds the sum of the last complete subtree of 2^l chunks; `Filled` counts the
+	 * chunks pushed so far.
+	 */
+	template<typename Value>
+	struct PairwiseTree
+	{
+		std::array<Value, 64> Levels{};
+		dimension_t Filled = 0;
+
+		/// @brief Push the sum of a complete subtree of 2^level chunks (Filled must be a multiple of 2^level).
+		constexpr void push(Value sum, dimension_t level = 0) noexcept
+		{
+			const dimension_t Count = dimension_t(1) << level;
+
+			// Carry like a binary counter: equal-sized subtrees are merged
+			for (; (Filled >> level) & 1; ++level)
+			{
+				sum = Levels[level] + sum;
+				Levels[level] = Value{};
+			}
+			Levels[level] = sum;
+			Filled += Count;
+		}
+
+		/// @brief Fold the remaining subtrees, smallest (rightmost) first.
+		constexpr Value total() const noexcept
+		{
+			Value Total{};
+			bool HasTotal = false;
+			for (dimension_t Level = 0; Level < Levels.size(); ++Level)
+			{
+				if ((Filled >> Level) & 1)
+				{
+					Total = HasTotal ? Levels[Level] + Total : Levels[Level];
+					HasTotal = true;
+				}
+			}
+			return Total;
+		}
+	};
+
+	/// @brief Sum term(i) over [first, last) with `MetricLaneCount` lanes added pairwise.
+	template<typename Value, typename TermFunction>
+	constexpr Value chunkSum(const TermFunction& term, dimension_t first, dimension_t last) noexcept
+	{
+		std::array<Value, MetricLaneCount> Lanes{};
+		dimension_t i = first;
+		for (; i + MetricLaneCount <= last; i += MetricLaneCount)
+			for (dimension_t l = 0; l < MetricLaneCount; ++l)
+				Lanes[l] += term(i + l);
+		for (dimension_t l = 0; l < last - i; ++l)
+			Lanes[l] += term(i + l);
+
+		for (dimension_t Width = MetricLaneCount / 2; Width > 0; Width /= 2)
+			for (dimension_t l = 0; l < Width; ++l)
+				Lanes[l] += Lanes[l + Width];
+		return Lanes[0];
+	}
+
+	/**
+	 * @brief     Sum term(i) over [0, Count) in a fixed chunked, pairwise order.
+	 *
+	 * @tparam Count     Number of terms.
+	 * @tparam Value     Accumulator type (float_t or cplx_t).
+	 * @param term       Callable returning the i-th term; called concurrently from several threads.
+	 */
+	template<dimension_t Count, typename Value, typename TermFunction>
+	constexpr Value deterministicSum(const TermFunction& term) noexcept
+	{
+		constexpr dimension_t ChunkSize = Count < MetricChunkSize ? Count : MetricChunkSize;
+		constexpr dimension_t ChunkCount = ChunkSize == 0 ? 0 : (Count + ChunkSize - 1) / ChunkSize;
+		constexpr dimension_t BlockCount = ChunkCount / MetricBlockChunkCount;
+		constexpr dimension_t BlockLevel = std::countr_zero(MetricBlockChunkCount);
+
+		const auto chunk = [&](dimension_t chunkIndex)
+			{
+				const dimension_t First = chunkIndex * ChunkSize;
+				return chunkSum<Value>(term, First, First + ChunkSize < Count ? First + ChunkSize : Count);
+			};
+
+		// Every full block is a complete subtree of the tree: sum the blocks independently
+		std::vector<Value> BlockSums(BlockCount);
+		const auto work = [&](dimension_t firstBlock, dimension_t lastBlock)
+			{
+				for (dimension_t Block = firstBlock; Block < lastBlock; ++Block)
+				{
+					PairwiseTree<Value> Tree{};
+					for (dimension_t c = 0; c < MetricBlockChunkCount; ++c)
+						Tree.push(chunk(Block * MetricBlockChunkCount + c));
+					BlockSums[Block] = Tree.Levels[BlockLevel];
+				}
+			};
+
+		dimension_t WorkerCount = 1;
+		if !consteval
+		{
+			const dimension_t MaxWorkerCount = BlockCount / MetricBlocksPerThread;
+			WorkerCount = std::clamp<dimension_t>(std::thread::hardware_concurrency(), 1, std::max<dimension_t>(MaxWorkerCount, 1));
+		}
+
+		if (WorkerCount == 1)
+		{
+			work(0, BlockCount);
+		}
+		else
+		{
+			// Contiguous block ranges; the first BlockCount % WorkerCount workers take one more block
+			const auto firstBlockOf = [&](dimension_t worker)
+				{
+					return BlockCount / WorkerCount * worker + std::min(worker, BlockCount % WorkerCount);
+				};
+
+			std::vector<std::jthread> Workers{};
+			Workers.reserve(WorkerCount - 1);
+			for (dimension_t w = 1; w < WorkerCount; ++w)
+				Workers.emplace_back(work, firstBlockOf(w), firstBlockOf(w + 1));
+			work(0, firstBlockOf(1));
+		}
+
+		// Blocks first, then the chunks past the last full block, which never carry into the block levels
+		PairwiseTree<Value> Tree{};
+		for (const Value& BlockSum : BlockSums)
+			Tree.push(BlockSum, BlockLevel);
+		for (dimension_t Chunk = BlockCount * MetricBlockChunkCount; Chunk < ChunkCount; ++Chunk)
+			Tree.push(chunk(Chunk));
+		return Tree.total();
+	}
+
+	/// @brief Inner product ⟨a|b⟩ = Σ a*_i b_i.
+	template<dimension_t StateCount>
+	constexpr cplx_t innerProduct(const StateVector<StateCount>& a, const StateVector<StateCount>& b) noexcept
+	{
+		return deterministicSum<StateCount, cplx_t>([&](dimension_t i)
+			{
+				// Read the components as scalars; GCC 12 cannot copy default-initialised amplitudes out of constexpr states
+				const float_t ARe = a.m_StateVector[i].re, AIm = a.m_StateVector[i].im;
+				const float_t BRe = b.m_StateVector[i].re, BIm = b.m_StateVector[i].im;
+				return cplx_t(ARe * BRe + AIm * BIm, ARe * BIm - AIm * BRe);
+			});
+	}
+
+	/// @brief Squared norm ⟨ψ|ψ⟩.
+	template<dimension_t StateCount>
+	constexpr float_t squaredNorm(const StateVector<StateCount>& state) noexcept
+	{
+		return deterministicSum<StateCount, float_t>([&](dimension_t i)
+			{
+				return state.m_StateVector[i].normSquared();
+			});
+	}
+
+	/// @brief Norm sqrt(⟨ψ|ψ⟩).
+	template<dimension_t StateCount>
+	constexpr float_t norm(const StateVector<StateCount>& state) noexcept
+	{
+		return ConstexprMath::sqrt(squaredNorm(state));
+	}
+
+	/// @brief Fidelity |⟨a|b⟩|² / (⟨a|a⟩⟨b|b⟩) of two pure states, in [0, 1].
+	template<dimension_t StateCount>
+	constexpr float_t fidelity(const StateVector<StateCount>& a, const StateVector<StateCount>& b) noexcept
+	{
+		const float_t Norms = squaredNorm(a) * squaredNorm(b);
+		if (Norms == 0.0)
+			return 0.0;
+
+		const float_t Fidelity = innerProduct(a, b).normSquared() / Norms;
+		return Fidelity < 1.0 ? Fidelity : 1.0;
+	}
+
+	/// @brief Trace distance (1/2)‖|a><a| - |b><b|‖₁ = sqrt(1 - F) of two pure states, in [0, 1].
+	template<dimension_t StateCount>
+	constexpr float_t traceDistance(const StateVector<StateCount>& a, const StateVector<StateCount>& b) noexcept
+	{
+		return ConstexprMath::sqrt(1.0 - fidelity(a, b));
+	}
+}
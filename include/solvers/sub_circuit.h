@@ -0,0 +1,245 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+
+#include "core_types.h"
+#include "circuit_record.h"
+#include "quantum_gate_helpers.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Reusable sub-circuits, fused once into a single gate, and their repetitions.
+	///
+	/**
+	 * @details
+	 * A block that appears several times in a circuit (the controlled multiplications of
+	 * Shor's algorithm, a Trotter step, a Grover iteration) used to be written out and executed
+	 * gate by gate for every copy. A `SubCircuit` records the block once (see circuit_record.h)
+	 * and, if the union of its qubits is at most `SubCircuitFuseQBitCount` wide, fuses it into
+	 * a single gate record on that support (the record is only as wide as the recorded gates
+	 * can reach): the fused matrix is computed once, column by column, by running the
+	 * recorded gates on the basis states of the support. Blocks made of X / CX / Toffoli /
+	 * phases fuse into a phase permutation and are applied by moving amplitudes; diagonal
+	 * blocks are applied as per-amplitude phases.
+	 *
+	 * `repeat<N>()` returns the block applied N times. A fused block is raised to the N-th
+	 * power by squaring (O(log N) small matrix products) and still costs one pass; a block
+	 * too wide to fuse runs its gates N times in every cache tile.
+	 *
+	 * `withGates` accepts sub-circuits next to ordinary gates; an unfused block runs all of
+	 * its gates on one cache tile before moving on to the next.
+	 */
+
+	/// @brief Widest support a sub-circuit is fused on: 2^6 × 2^6 amplitudes × 16 bytes = 64 KiB.
+	constexpr dimension_t SubCircuitFuseQBitCount = 6;
+
+	/// @brief Width of the fused record of a gate pack: the sum of the gate widths (a bound on
+	/// the union of their supports), capped at SubCircuitFuseQBitCount.
+	template<RecordableGate... Gates>
+	constexpr dimension_t sub_circuit_fused_qbit_count_v =
+		std::min(SubCircuitFuseQBitCount, std::max(dimension_t{ 1 }, (recorded_qbit_count_v<Gates> + ... + dimension_t{ 0 })));
+
+	/**
+	 * @brief     A recorded block of gates, fused into one gate when its support is small.
+	 *
+	 * @tparam MaxQBitCount  Width of the widest recorded gate.
+	 * @tparam Capacity      Maximum number of recorded gates.
+	 * @tparam FusedQBitCount Width of the fused record; blocks with a wider support are not fused.
+	 */
+	template<dimension_t MaxQBitCount, dimension_t Capacity,
+		dimension_t FusedQBitCount = std::min(SubCircuitFuseQBitCount, MaxQBitCount * Capacity)>
+	struct SubCircuit
+	{
+		/// The recorded gates.
+		CircuitRecord<MaxQBitCount, Capacity> Body{};
+
+		/// True if `Fused` holds the whole block (including its repetitions).
+		bool IsFused = false;
+
+		/// The block as one gate on its support, in ascending qubit order.
+		GateRecord<FusedQBitCount> Fused{};
+
+		/// Number of times the body is applied.
+		dimension_t RepeatCount = 1;
+
+		/// @brief Record a gate pack and fuse it if its support is small enough.
+		template<RecordableGate... GateTypes>
+			requires (sizeof...(GateTypes) <= Capacity)
+		static constexpr SubCircuit fromGates(const GateTypes&... gates) noexcept
+		{
+			SubCircuit Circuit{};
+			Circuit.Body = CircuitRecord<MaxQBitCount, Capacity>::fromGates(gates...);
+			Circuit.fuse();
+			return Circuit;
+		}
+
+		/// @brief The block applied Count times (Count >= 1).
+		template<dimension_t Count>
+			requires (Count >= 1)
+		constexpr SubCircuit repeat() const noexcept
+		{
+			SubCircuit Repeated = *this;
+			Repeated.RepeatCount = RepeatCount * Count;
+			if (IsFused)
+				Repeated.Fused = powerOf(Fused, Count);
+			return Repeated;
+		}
+
+		/// @brief Get the union of the supports of the recorded gates.
+		constexpr dimension_t getAffectedMask() const noexcept
+		{
+			return Body.getSupportMask();
+		}
+
+		/// @brief Apply the block in place to a contiguous range of a state stored in the given layout.
+		/// @see QuantumGateOp::applyInPlace
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state,
+			const QubitLayout<QBitCountOf<StateCount>>& layout,
+			dimension_t firstIndex, dimension_t lastIndex) const noexcept
+		{
+			if (IsFused)
+				return Fused.applyInPlace(state, layout, firstIndex, lastIndex);
+
+			for (dimension_t r = 0; r < RepeatCount; ++r)
+				for (dimension_t g = 0; g < Body.GateCount; ++g)
+					Body.Gates[g].applyInPlace(state, layout, firstIndex, lastIndex);
+		}
+
+		/// @brief Apply the block in place to the whole state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			applyInPlace(state, QubitLayout<QBitCountOf<StateCount>>{}, 0, StateCount);
+		}
+
+		/// @brief Undo the block in place on a state vector stored in logical order.
+		template<dimension_t StateCount>
+		constexpr void applyAdjointInPlace(StateVector<StateCount>& state) const noexcept
+		{
+			if (IsFused)
+				return adjointOf(Fused).applyInPlace(state);
+
+			for (dimension_t r = 0; r < RepeatCount; ++r)
+				for (dimension_t g = Body.GateCount; g-- > 0;)
+					adjointOf(Body.Gates[g]).applyInPlace(state);
+		}
+
+		/// @brief Apply the block to a global state vector and return the result.
+		template<dimension_t StateCount>
+		constexpr StateVector<StateCount> operator()(StateVector<StateCount> state) const
+		{
+			applyInPlace(state);
+			return state;
+		}
+
+	private:
+		static constexpr dimension_t FusedDim = ConstexprMath::pow2(FusedQBitCount);
+
+		/// @brief Fuse the body into one record on its support, if the support is narrow enough.
+		constexpr void fuse() noexcept
+		{
+			const dimension_t Support = Body.getSupportMask();
+			const dimension_t Width = static_cast<dimension_t>(std::popcount(Support));
+			IsFused = (Width > 0 && Width <= FusedQBitCount);
+			if (!IsFused)
+				return;
+
+			Fused = GateRecord<FusedQBitCount>{};
+			Fused.QBitCount = Width;
+			for (dimension_t Bit = 0, q = 0; q < Width; ++Bit)
+			{
+				if ((Support >> Bit) & 1)
+					Fused.AffectedBits[q++] = Bit;
+			}
+
+			// The body on the support's local qubits: global qubit AffectedBits[q] becomes local bit q
+			CircuitRecord<MaxQBitCount, Capacity> Local = Body;
+			for (dimension_t g = 0; g < Local.GateCount; ++g)
+				for (dimension_t q = 0; q < Local.Gates[g].QBitCount; ++q)
+				{
+					const dimension_t Global = Local.Gates[g].AffectedBits[q];
+					Local.Gates[g].AffectedBits[q] = static_cast<dimension_t>(std::popcount(Support & ((dimension_t(1) << Global) - 1)));
+				}
+
+			// Column j of the fused matrix is the image of the local basis state j
+			for (dimension_t j = 0; j < Fused.dim(); ++j)
+			{
+				StateVector<FusedDim> Column{};
+				Column.m_StateVector[j] = cplx_t::fromReal(1.0);
+				for (dimension_t g = 0; g < Local.GateCount; ++g)
+					Local.Gates[g].applyInPlace(Column);
+
+				for (dimension_t i = 0; i < Fused.dim(); ++i)
+					Fused.Matrix[i][j] = Column.m_StateVector[i];
+			}
+			Fused.classify();
+		}
+
+		/// @brief Product of two records on the same qubits: first, then second.
+		template<dimension_t Width>
+		static constexpr GateRecord<Width> productOf(const GateRecord<Width>& first, const GateRecord<Width>& second) noexcept
+		{
+			GateRecord<Width> Product = first;
+			for (dimension_t i = 0; i < first.dim(); ++i)
+				for (dimension_t j = 0; j < first.dim(); ++j)
+				{
+					cplx_t Sum{};
+					for (dimension_t k = 0; k < first.dim(); ++k)
+						Sum += second.Matrix[i][k] * first.Matrix[k][j];
+					Product.Matrix[i][j] = Sum;
+				}
+			Product.classify();
+			return Product;
+		}
+
+		/// @brief The record raised to a positive power, by squaring.
+		template<dimension_t Width>
+		static constexpr GateRecord<Width> powerOf(const GateRecord<Width>& gate, dimension_t exponent) noexcept
+		{
+			GateRecord<Width> Result = gate;
+			GateRecord<Width> Square = gate;
+			bool HasResult = false;
+			while (exponent > 0)
+			{
+				if (exponent & 1)
+				{
+					Result = HasResult ? productOf(Result, Square) : Square;
+					HasResult = true;
+				}
+				exponent >>= 1;
+				if (exponent > 0)
+					Square = productOf(Square, Square);
+			}
+			return Result;
+		}
+
+		/// @brief The record of the inverse gate.
+		template<dimension_t Width>
+		static constexpr GateRecord<Width> adjointOf(const GateRecord<Width>& gate) noexcept
+		{
+			GateRecord<Width> Adjoint = gate;
+			for (dimension_t i = 0; i < gate.dim(); ++i)
+				for (dimension_t j = 0; j < gate.dim(); ++j)
+					Adjoint.Matrix[i][j] = gate.Matrix[j][i].conj();
+			Adjoint.classify();
+			return Adjoint;
+		}
+	};
+
+	/**
+	 * @brief     Record a block of gates as a reusable sub-circuit.
+	 *
+	 * Example: Shor's controlled multiplication stage, fused once and squared
+	 *   constexpr auto Stage = makeSubCircuit(QuantumGate<2, Gates::CX>().toBits(0, 3), ...);
+	 *   QuantumCircuit<8>().withGates(..., Stage, Stage.repeat<2>(), ...);
+	 */
+	template<RecordableGate... GateTypes>
+	constexpr SubCircuit<recorded_max_qbit_count_v<GateTypes...>, sizeof...(GateTypes), sub_circuit_fused_qbit_count_v<GateTypes...>>
+		makeSubCircuit(const GateTypes&... gates) noexcept
+	{
+		return SubCircuit<recorded_max_qbit_count_v<GateTypes...>, sizeof...(GateTypes),
+			sub_circuit_fused_qbit_count_v<GateTypes...>>::fromGates(gates...);
+	}
+}
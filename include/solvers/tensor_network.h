@@ -0,0 +1,396 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core_types.h"
+#include "circuit_record.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Tensor-network contraction of single amplitudes ⟨x|C|0⟩.
+	///
+	/**
+	 * @details
+	 * A circuit is a network of small tensors: one vector |0⟩ per input qubit, one tensor per
+	 * gate (k output legs and k input legs, its matrix), and one covector ⟨x_q| per output
+	 * qubit. Every wire segment between two of them is an edge of dimension 2 shared by
+	 * exactly two tensors, so contracting all edges gives the scalar ⟨x|C|0⟩ without ever
+	 * forming the 2^n state. The cost is set by the contraction order:
+	 *  - `planContraction` picks pairs greedily, always contracting the pair sharing an edge
+	 *    whose result is smallest compared with its inputs (size(result) - size(a) - size(b));
+	 *  - if an intermediate would exceed `maxRank` legs, edges are sliced: the edge found in
+	 *    the most oversized intermediates is fixed to 0 and to 1, and the network is planned
+	 *    again without it. The amplitude is the sum over the 2^s slices, each contracted in
+	 *    bounded memory (and independent of the others).
+	 *
+	 * A pair is contracted as one matrix product (transpose-transpose-GEMM): both tensors
+	 * are gathered into [free × shared] and [shared × free] matrices, and the product runs
+	 * with the contiguous free index of the second operand innermost.
+	 *
+	 * Tensor data is stored with leg t on bit t of the index. The plan only depends on the
+	 * circuit, not on x, so it is computed once and reused for every amplitude.
+	 */
+
+	/// @brief Default bound on the number of legs of an intermediate tensor: 2^20 × 16 bytes = 16 MiB.
+	constexpr dimension_t TensorNetworkMaxRank = 20;
+
+	/// @brief A tensor of dimension-2 legs.
+	struct Tensor
+	{
+		/// Edge of every leg; leg t is bit t of the data index.
+		std::vector<dimension_t> Legs{};
+
+		/// 2^Legs.size() entries.
+		std::vector<cplx_t> Data{};
+	};
+
+	/// @brief A tensor network: the tensors and the number of edges connecting them.
+	struct TensorNetwork
+	{
+		std::vector<Tensor> Tensors{};
+		dimension_t EdgeCount = 0;
+	};
+
+	/// @brief A contraction order and the sliced edges it relies on.
+	struct ContractionPlan
+	{
+		/// Pairs of tensor ids contracted in order; the result of step s gets id TensorCount + s.
+		std::vector<std::pair<dimension_t, dimension_t>> Steps{};
+
+		/// Edges fixed to every value in turn; the slices are summed.
+		std::vector<dimension_t> SlicedEdges{};
+
+		/// Number of legs of the largest intermediate tensor of one slice.
+		dimension_t MaxRank = 0;
+
+		/// Multiply-adds of one slice: Σ over steps of 2^(legs of both operands, shared counted once).
+		float_t Cost = 0.0;
+	};
+
+	/**
+	 * @brief     Build the network of ⟨x|C|0⟩ for a recorded circuit.
+	 *
+	 * @tparam QBitCount  Number of qubits.
+	 * @param record      The recorded gates.
+	 * @param basisIndex  The output basis state x.
+	 */
+	template<dimension_t QBitCount, dimension_t MaxQBitCount, dimension_t Capacity>
+	constexpr TensorNetwork buildTensorNetwork(const CircuitRecord<MaxQBitCount, Capacity>& record, dimension_t basisIndex)
+	{
+		TensorNetwork Network{};
+
+		// Current open edge of every qubit, starting at its |0⟩ input
+		std::array<dimension_t, QBitCount> Wire{};
+		for (dimension_t q = 0; q < QBitCount; ++q)
+		{
+			Wire[q] = Network.EdgeCount++;
+			Network.Tensors.push_back(Tensor{ { Wire[q] }, { cplx_t::fromReal(1.0), cplx_t::zero() } });
+		}
+
+		for (dimension_t g = 0; g < record.GateCount; ++g)
+		{
+			const GateRecord<MaxQBitCount>& Gate = record.Gates[g];
+			const dimension_t K = Gate.QBitCount;
+
+			// Legs 0 .. K-1 are the outputs, legs K .. 2K-1 the inputs, in local bit order
+			Tensor GateTensor{};
+			GateTensor.Legs.resize(2 * K);
+			for (dimension_t q = 0; q < K; ++q)
+			{
+				GateTensor.Legs[K + q] = Wire[Gate.AffectedBits[q]];
+				GateTensor.Legs[q] = Wire[Gate.AffectedBits[q]] = Network.EdgeCount++;
+			}
+			GateTensor.Data.resize(Gate.dim() * Gate.dim());
+			for (dimension_t Out = 0; Out < Gate.dim(); ++Out)
+				for (dimension_t In = 0; In < Gate.dim(); ++In)
+					GateTensor.Data[Out | (In << K)] = Gate.Matrix[Out][In];
+			Network.Tensors.push_back(GateTensor);
+		}
+
+		for (dimension_t q = 0; q < QBitCount; ++q)
+		{
+			const bool Bit = (basisIndex >> q) & 1;
+			Network.Tensors.push_back(Tensor{ { Wire[q] },
+				{ cplx_t::fromReal(Bit ? 0.0 : 1.0), cplx_t::fromReal(Bit ? 1.0 : 0.0) } });
+		}
+		return Network;
+	}
+
+	namespace Detail
+	{
+		/// @brief Number of entries 2^rank of a tensor, as a double (infinity past 2^1023) so costs never wrap.
+		constexpr float_t entryCount(dimension_t rank) noexcept
+		{
+			if (rank > 1023)
+				return std::numeric_limits<float_t>::infinity();
+			return std::bit_cast<float_t>(static_cast<std::uint64_t>(rank + 1023) << 52);
+		}
+
+		/// @brief True if the edge is one of the legs.
+		constexpr bool hasLeg(const std::vector<dimension_t>& legs, dimension_t edge) noexcept
+		{
+			for (dimension_t Leg : legs)
+			{
+				if (Leg == edge)
+					return true;
+			}
+			return false;
+		}
+
+		/// @brief Legs of the contraction of two tensors: the free legs of b, then those of a.
+		constexpr std::vector<dimension_t> contractedLegs(const std::vector<dimension_t>& a, const std::vector<dimension_t>& b)
+		{
+			std::vector<dimension_t> Legs{};
+			for (dimension_t Leg : b)
+				if (!hasLeg(a, Leg))
+					Legs.push_back(Leg);
+			for (dimension_t Leg : a)
+				if (!hasLeg(b, Leg))
+					Legs.push_back(Leg);
+			return Legs;
+		}
+
+		/// @brief Number of distinct legs of two tensors.
+		constexpr dimension_t unionRank(const std::vector<dimension_t>& a, const std::vector<dimension_t>& b) noexcept
+		{
+			dimension_t Rank = a.size();
+			for (dimension_t Leg : b)
+				Rank += hasLeg(a, Leg) ? 0 : 1;
+			return Rank;
+		}
+
+		/// @brief Greedy contraction order of a network given by the legs of its tensors.
+		/// @param oversized  Receives the legs of every intermediate with more than maxRank legs.
+		constexpr ContractionPlan planGreedy(std::vector<std::vector<dimension_t>> legs, dimension_t maxRank,
+			std::vector<std::vector<dimension_t>>& oversized)
+		{
+			ContractionPlan Plan{};
+			std::vector<bool> Alive(legs.size(), true);
+			dimension_t AliveCount = legs.size();
+
+			while (AliveCount > 1)
+			{
+				// Best pair sharing an edge; pairs sharing none only when nothing else is left
+				dimension_t BestA = 0, BestB = 0;
+				float_t BestScore = 0.0;
+				bool Found = false, FoundShared = false;
+				for (dimension_t a = 0; a < legs.size(); ++a)
+				{
+					if (!Alive[a])
+						continue;
+					for (dimension_t b = a + 1; b < legs.size(); ++b)
+					{
+						if (!Alive[b])
+							continue;
+
+						const dimension_t Union = unionRank(legs[a], legs[b]);
+						const bool Shared = Union < legs[a].size() + legs[b].size();
+						if (FoundShared && !Shared)
+							continue;
+
+						const dimension_t ResultRank = 2 * Union - legs[a].size() - legs[b].size();
+						const float_t Score = entryCount(ResultRank) - entryCount(legs[a].size()) - entryCount(legs[b].size());
+						if (!Found || (Shared && !FoundShared) || Score < BestScore)
+						{
+							BestA = a;
+							BestB = b;
+							BestScore = Score;
+							Found = true;
+							FoundShared = FoundShared || Shared;
+						}
+					}
+				}
+
+				std::vector<dimension_t> Result = contractedLegs(legs[BestA], legs[BestB]);
+				Plan.Cost += entryCount(unionRank(legs[BestA], legs[BestB]));
+				Plan.MaxRank = Result.size() > Plan.MaxRank ? Result.size() : Plan.MaxRank;
+				if (Result.size() > maxRank)
+					oversized.push_back(Result);
+
+				Plan.Steps.emplace_back(BestA, BestB);
+				Alive[BestA] = Alive[BestB] = false;
+				legs.push_back(std::move(Result));
+				Alive.push_back(true);
+				--AliveCount;
+			}
+			return Plan;
+		}
+
+		/// @brief Contract two tensors as one matrix product; the result has the free legs of b, then of a.
+		constexpr Tensor contractPair(const Tensor& a, const Tensor& b)
+		{
+			std::vector<dimension_t> SharedLegs{}, FreeA{}, FreeB{};
+			for (dimension_t Leg : a.Legs)
+				(hasLeg(b.Legs, Leg) ? SharedLegs : FreeA).push_back(Leg);
+			for (dimension_t Leg : b.Legs)
+				if (!hasLeg(a.Legs, Leg))
+					FreeB.push_back(Leg);
+
+			const dimension_t SharedDim = ConstexprMath::pow2(SharedLegs.size());
+			const dimension_t FreeADim = ConstexprMath::pow2(FreeA.size());
+			const dimension_t FreeBDim = ConstexprMath::pow2(FreeB.size());
+
+			// Position of every leg of a tensor in the (free, shared) split
+			const auto gather = [&](const Tensor& t, const std::vector<dimension_t>& free, std::vector<cplx_t>& matrix, bool sharedMajor)
+				{
+					std::vector<dimension_t> FreeBit(t.Legs.size()), SharedBit(t.Legs.size());
+					std::vector<bool> IsShared(t.Legs.size());
+					for (dimension_t l = 0; l < t.Legs.size(); ++l)
+					{
+						for (dimension_t f = 0; f < free.size(); ++f)
+							if (free[f] == t.Legs[l])
+								FreeBit[l] = f;
+						for (dimension_t s = 0; s < SharedLegs.size(); ++s)
+							if (SharedLegs[s] == t.Legs[l])
+							{
+								SharedBit[l] = s;
+								IsShared[l] = true;
+							}
+					}
+
+					const dimension_t FreeDim = ConstexprMath::pow2(free.size());
+					matrix.resize(FreeDim * SharedDim);
+					for (dimension_t i = 0; i < t.Data.size(); ++i)
+					{
+						dimension_t F = 0, S = 0;
+						for (dimension_t l = 0; l < t.Legs.size(); ++l)
+						{
+							if (IsShared[l])
+								S |= ((i >> l) & 1) << SharedBit[l];
+							else
+								F |= ((i >> l) & 1) << FreeBit[l];
+						}
+						matrix[sharedMajor ? S * FreeDim + F : F * SharedDim + S] = t.Data[i];
+					}
+				};
+
+			std::vector<cplx_t> AMatrix{}, BMatrix{};
+			gather(a, FreeA, AMatrix, false);
+			gather(b, FreeB, BMatrix, true);
+
+			// C[fa][fb] = Σ_s A[fa][s] B[s][fb]; the result index fb + fa·FreeBDim puts the legs of b first
+			Tensor Result{};
+			Result.Legs = FreeB;
+			Result.Legs.insert(Result.Legs.end(), FreeA.begin(), FreeA.end());
+			Result.Data.resize(FreeADim * FreeBDim);
+			for (dimension_t fa = 0; fa < FreeADim; ++fa)
+				for (dimension_t s = 0; s < SharedDim; ++s)
+				{
+					const cplx_t A = AMatrix[fa * SharedDim + s];
+					if (A.re == 0.0 && A.im == 0.0)
+						continue;
+					for (dimension_t fb = 0; fb < FreeBDim; ++fb)
+						Result.Data[fa * FreeBDim + fb] += A * BMatrix[s * FreeBDim + fb];
+				}
+			return Result;
+		}
+
+		/// @brief Fix an edge to a value in every tensor holding it (the leg is removed).
+		constexpr void sliceEdge(std::vector<Tensor>& tensors, dimension_t edge, dimension_t value)
+		{
+			for (Tensor& T : tensors)
+			{
+				for (dimension_t l = 0; l < T.Legs.size(); ++l)
+				{
+					if (T.Legs[l] != edge)
+						continue;
+
+					Tensor Sliced{};
+					Sliced.Legs = T.Legs;
+					Sliced.Legs.erase(Sliced.Legs.begin() + l);
+					Sliced.Data.resize(T.Data.size() / 2);
+					const dimension_t LowMask = ConstexprMath::pow2(l) - 1;
+					for (dimension_t i = 0; i < Sliced.Data.size(); ++i)
+						Sliced.Data[i] = T.Data[(i & LowMask) | (value << l) | ((i & ~LowMask) << 1)];
+					T = std::move(Sliced);
+					break;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief     Plan the contraction of a network, slicing edges until every intermediate has at most maxRank legs.
+	 *
+	 * @param network  The network (only the legs are used).
+	 * @param maxRank  Bound on the number of legs of any intermediate tensor.
+	 */
+	constexpr ContractionPlan planContraction(const TensorNetwork& network, dimension_t maxRank = TensorNetworkMaxRank)
+	{
+		std::vector<std::vector<dimension_t>> Legs{};
+		for (const Tensor& T : network.Tensors)
+			Legs.push_back(T.Legs);
+
+		std::vector<dimension_t> Sliced{};
+		while (true)
+		{
+			std::vector<std::vector<dimension_t>> Oversized{};
+			ContractionPlan Plan = Detail::planGreedy(Legs, maxRank, Oversized);
+			if (Oversized.empty())
+			{
+				Plan.SlicedEdges = Sliced;
+				return Plan;
+			}
+
+			// Slice the edge found in the most oversized intermediates
+			std::vector<dimension_t> Count(network.EdgeCount, 0);
+			for (const std::vector<dimension_t>& Intermediate : Oversized)
+				for (dimension_t Edge : Intermediate)
+					++Count[Edge];
+
+			dimension_t Edge = 0;
+			for (dimension_t e = 1; e < network.EdgeCount; ++e)
+				Edge = Count[e] > Count[Edge] ? e : Edge;
+			if (Count[Edge] == 0)
+			{
+				Plan.SlicedEdges = Sliced;
+				return Plan;
+			}
+
+			Sliced.push_back(Edge);
+			for (std::vector<dimension_t>& TensorLegs : Legs)
+				std::erase(TensorLegs, Edge);
+		}
+	}
+
+	/**
+	 * @brief     Contract a network to its scalar value following a plan.
+	 *
+	 * @param network     The network.
+	 * @param plan        A plan made for the same network structure.
+	 * @param firstSlice  First slice of the range to sum.
+	 * @param lastSlice   One past the last slice (clamped to 2^SlicedEdges.size()).
+	 * @throws std::overflow_error if the slice count 2^SlicedEdges.size() does not fit in dimension_t.
+	 */
+	constexpr cplx_t contractNetwork(const TensorNetwork& network, const ContractionPlan& plan,
+		dimension_t firstSlice = 0, dimension_t lastSlice = ~dimension_t{ 0 })
+	{
+		if (plan.SlicedEdges.size() >= std::numeric_limits<dimension_t>::digits)
+			throw std::overflow_error("too many sliced edges: the slice count overflows");
+
+		const dimension_t SliceCount = ConstexprMath::pow2(plan.SlicedEdges.size());
+		lastSlice = lastSlice < SliceCount ? lastSlice : SliceCount;
+
+		cplx_t Sum{};
+		for (dimension_t Slice = firstSlice; Slice < lastSlice; ++Slice)
+		{
+			std::vector<Tensor> Tensors = network.Tensors;
+			for (dimension_t e = 0; e < plan.SlicedEdges.size(); ++e)
+				Detail::sliceEdge(Tensors, plan.SlicedEdges[e], (Slice >> e) & 1);
+
+			for (const auto& [A, B] : plan.Steps)
+			{
+				Tensors.push_back(Detail::contractPair(Tensors[A], Tensors[B]));
+				Tensors[A] = Tensor{};
+				Tensors[B] = Tensor{};
+			}
+			Sum += Tensors.back().Data[0];
+		}
+		return Sum;
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "core_types.h"
+#include "batched_gate_solver.h"
+#include "circuit_record.h"
+#include "wavefunction/batched_state_vector.h"
+
+namespace KetCat::QCC
+{
+	/// @file
+	/// @brief Full unitary of a small circuit, built by propagating all basis columns at once.
+	///
+	/**
+	 * @details
+	 * Column j of a circuit's unitary is the circuit applied to the basis state |j⟩. Running
+	 * 2^n executors one basis input at a time reloads every gate matrix 2^n times. Here the
+	 * columns are propagated together as a batch-interleaved state (see batched_state_vector.h):
+	 * stored [row][column], a batch of all columns is the unitary itself, and the batched
+	 * kernels load every matrix element once per row and apply it to a whole row of columns.
+	 *
+	 * Columns are processed in panels of `UnitaryColumnPanelWidth`, so the working set is
+	 * 2^n × panel amplitudes instead of 4^n. Panels write disjoint columns of U, so contiguous
+	 * panel ranges run on hardware threads (serially in constant evaluation and for small
+	 * circuits). Gates exposing their matrix use the batched kernel; any other gate
+	 * (permutation, oracle, FFT, sub-circuit ...) is applied column by column. Everything is
+	 * constexpr.
+	 */
+
+	/// @brief Number of columns propagated together.
+	constexpr dimension_t UnitaryColumnPanelWidth = 16;
+
+	/// @brief Minimum number of panels per thread; smaller circuits do not start threads.
+	constexpr dimension_t UnitaryPanelsPerThread = 4;
+
+	/// @brief Apply one gate to every column of a panel.
+	template<dimension_t StateCount, dimension_t PanelWidth, typename GateType>
+	constexpr void applyGateToColumns(BatchedStateVector<StateCount, PanelWidth>& columns, const GateType& gate) noexcept
+	{
+		if constexpr (RecordableGate<GateType>)
+		{
+			applyBatchedGateMatrix<recorded_qbit_count_v<GateType>>(columns, gate.getGateMatrix(), gate.getAffectedBits());
+		}
+		else
+		{
+			for (dimension_t c = 0; c < PanelWidth; ++c)
+				columns.setStateVector(c, gate(columns.getStateVector(c)));
+		}
+	}
+
+	/**
+	 * @brief     Compute the unitary of a gate sequence on QBitCount qubits.
+	 *
+	 * @tparam QBitCount  Number of qubits of the circuit.
+	 * @param gates       The gates, applied in order; called concurrently from several threads.
+	 * @return            U with U[i][j] = ⟨i| gates |j⟩.
+	 */
+	template<dimension_t QBitCount, typename... GateTypes>
+	constexpr matrix_t<ConstexprMath::pow2(QBitCount)> buildUnitary(const GateTypes&... gates) noexcept
+	{
+		constexpr dimension_t Dim = ConstexprMath::pow2(QBitCount);
+		constexpr dimension_t PanelWidth = std::min(Dim, UnitaryColumnPanelWidth);
+
+		constexpr dimension_t PanelCount = Dim / PanelWidth;
+
+		matrix_t<Dim> U{};
+		const auto work = [&](dimension_t firstPanel, dimension_t lastPanel)
+			{
+				for (dimension_t First = firstPanel * PanelWidth; First < lastPanel * PanelWidth; First += PanelWidth)
+				{
+					// Columns First .. First + PanelWidth start as the basis states |First + c>
+					BatchedStateVector<Dim, PanelWidth> Columns{};
+					for (dimension_t c = 0; c < PanelWidth; ++c)
+						Columns.m_Amplitudes[First + c][c] = cplx_t::fromReal(1.0);
+
+					(applyGateToColumns(Columns, gates), ...);
+
+					for (dimension_t i = 0; i < Dim; ++i)
+						for (dimension_t c = 0; c < PanelWidth; ++c)
+							U[i][First + c] = Columns.m_Amplitudes[i][c];
+				}
+			};
+
+		dimension_t WorkerCount = 1;
+		if !consteval
+		{
+			const dimension_t MaxWorkerCount = PanelCount / UnitaryPanelsPerThread;
+			WorkerCount = std::clamp<dimension_t>(std::thread::hardware_concurrency(), 1, std::max<dimension_t>(MaxWorkerCount, 1));
+		}
+
+		if (WorkerCount == 1)
+		{
+			work(0, PanelCount);
+		}
+		else
+		{
+			// Contiguous panel ranges; the first PanelCount % WorkerCount workers take one more panel
+			const auto firstPanelOf = [&](dimension_t worker)
+				{
+					return PanelCount / WorkerCount * worker + std::min(worker, PanelCount % WorkerCount);
+				};
+
+			std::vector<std::jthread> Workers{};
+			Workers.reserve(WorkerCount - 1);
+			for (dimension_t w = 1; w < WorkerCount; ++w)
+				Workers.emplace_back(work, firstPanelOf(w), firstPanelOf(w + 1));
+			work(0, firstPanelOf(1));
+		}
+		return U;
+	}
+}
@@ -0,0 +1,286 @@
+#pragma once
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "solvers/gate_hash.h"
+#include "solvers/gate_scheduler.h"
+#include "wavefunction/qbits.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Cache of intermediate circuit states, keyed by the structural hash of the gate prefix.
+    ///
+    /**
+     * @details
+     * While a circuit is tuned interactively, usually only its last gates change between runs.
+     * `CircuitPrefixCache` keeps the state reached after selected prefixes of a circuit
+     * (checkpoints every few gates, plus the complete circuit). A cached run
+     * looks up the longest prefix of the new gate sequence whose state is known, restores it,
+     * and executes only the remaining gates, so the cost is proportional to the edit rather
+     * than to the circuit depth.
+     *
+     * States live in memory (bounded by a capacity, oldest entries evicted first) and, when a
+     * directory is given, are also written to disk so that they survive the process. Keys are
+     * 64-bit structural hashes (see solvers/gate_hash.h). Every entry, in memory and in its file
+     * header, also keeps an independent 64-bit verification hash of the prefix, compared
+     * before the state is restored: an entry whose key collides with the prefix but whose
+     * verification hash differs is treated as a miss, so a wrong state would take a
+     * simultaneous collision of two independent 64-bit hashes.
+     *
+     * The cache is a runtime facility (hash maps and files), so cached runs are not constexpr.
+     */
+
+    /// @brief Counters describing how effective a prefix cache has been.
+    struct CircuitPrefixCacheStats
+    {
+        /// @brief Runs that resumed from a non-empty cached prefix.
+        dimension_t Hits = 0;
+
+        /// @brief Runs that had to start from |0...0>.
+        dimension_t Misses = 0;
+
+        /// @brief Hits served from the disk store rather than from memory.
+        dimension_t DiskHits = 0;
+
+        /// @brief Gates skipped thanks to cached prefixes.
+        dimension_t SkippedGates = 0;
+
+        /// @brief Gates actually executed.
+        dimension_t ExecutedGates = 0;
+    };
+
+    /**
+     * @brief     In-memory (and optionally on-disk) store of circuit prefix states.
+     *
+     * @tparam QBitCount  Number of qubits of the circuits the cache serves.
+     *
+     * Example:
+     *   CircuitPrefixCache<10> Cache(32, 8, "ketcat_cache");
+     *   auto Run = QuantumCircuit<10>().withGatesCached(Cache, gate1, gate2, ..., tunedGate);
+     */
+    template<dimension_t QBitCount>
+    class CircuitPrefixCache
+    {
+    public:
+        /// @brief Precompute 2^QBitCount for convenience
+        static constexpr dimension_t BasisStateCount = ConstexprMath::pow2(QBitCount);
+
+    private:
+        /// @brief Maximum number of states kept in memory.
+        dimension_t m_capacity;
+
+        /// @brief Number of gates between two stored checkpoints (0: store the complete circuit only).
+        dimension_t m_checkpointStride;
+
+        /// @brief Directory of the disk store (empty: memory only).
+        std::filesystem::path m_directory;
+
+        /// @brief A cached state and the verification hash of the prefix that produced it.
+        struct CachedState
+        {
+            gate_hash_t Check = 0;
+            StateVector<BasisStateCount> State{};
+        };
+
+        /// @brief Cached states by prefix hash.
+        std::unordered_map<gate_hash_t, CachedState> m_states;
+
+        /// @brief Insertion order of the cached states, oldest first.
+        std::deque<gate_hash_t> m_insertionOrder;
+
+        CircuitPrefixCacheStats m_stats;
+
+        /// @brief File holding the state of the given prefix in the disk store.
+        std::filesystem::path filePath(gate_hash_t hash) const
+        {
+            constexpr char HexDigits[] = "0123456789abcdef";
+            std::string Name(16, '0');
+            for (dimension_t i = 0; i < 16; ++i)
+                Name[15 - i] = HexDigits[(hash >> (4 * i)) & 0xF];
+            return m_directory / (Name + ".ketstate");
+        }
+
+        /// @brief Read a state from the disk store, if present, of the right size and with the right verification hash.
+        std::optional<StateVector<BasisStateCount>> loadFromDisk(gate_hash_t hash, gate_hash_t check) const
+        {
+            if (m_directory.empty())
+                return std::nullopt;
+
+            std::ifstream File(filePath(hash), std::ios::binary);
+            if (!File)
+                return std::nullopt;
+
+            std::uint64_t Header[3]{};
+            File.read(reinterpret_cast<char*>(Header), sizeof(Header));
+            if (!File || Header[0] != QBitCount || Header[1] != hash || Header[2] != check)
+                return std::nullopt;
+
+            StateVector<BasisStateCount> State{};
+            File.read(reinterpret_cast<char*>(State.m_StateVector.data()), sizeof(State.m_StateVector));
+            if (!File)
+                return std::nullopt;
+
+            return State;
+        }
+
+        /// @brief Keep a state in memory, evicting the oldest entries beyond the capacity.
+        void remember(gate_hash_t hash, gate_hash_t check, const StateVector<BasisStateCount>& state)
+        {
+            if (m_capacity == 0)
+                return;
+
+            if (m_states.insert_or_assign(hash, CachedState{ check, state }).second)
+            {
+                m_insertionOrder.push_back(hash);
+                while (m_states.size() > m_capacity)
+                {
+                    m_states.erase(m_insertionOrder.front());
+                    m_insertionOrder.pop_front();
+                }
+            }
+        }
+
+        /// @brief Write a state to the disk store (failures are ignored, the cache is best effort).
+        void storeToDisk(gate_hash_t hash, gate_hash_t check, const StateVector<BasisStateCount>& state) const
+        {
+            if (m_directory.empty())
+                return;
+
+            std::error_code Error;
+            std::filesystem::create_directories(m_directory, Error);
+
+            std::ofstream File(filePath(hash), std::ios::binary | std::ios::trunc);
+            const std::uint64_t Header[3]{ QBitCount, hash, check };
+            File.write(reinterpret_cast<const char*>(Header), sizeof(Header));
+            File.write(reinterpret_cast<const char*>(state.m_StateVector.data()), sizeof(state.m_StateVector));
+        }
+
+    public:
+        /// @brief Create a prefix cache.
+        /// @param capacity          Maximum number of states kept in memory.
+        /// @param checkpointStride  Store a checkpoint every this many gates (0: complete circuits only).
+        /// @param directory         Directory of the disk store; empty for a memory-only cache.
+        explicit CircuitPrefixCache(dimension_t capacity = 16, dimension_t checkpointStride = 8,
+            std::filesystem::path directory = {})
+            : m_capacity(capacity), m_checkpointStride(checkpointStride), m_directory(std::move(directory))
+        {
+        }
+
+        /// @brief Number of gates between two stored checkpoints.
+        dimension_t getCheckpointStride() const noexcept
+        {
+            return m_checkpointStride;
+        }
+
+        /// @brief Number of states currently held in memory.
+        dimension_t size() const noexcept
+        {
+            return m_states.size();
+        }
+
+        /// @brief Counters of the runs served so far.
+        const CircuitPrefixCacheStats& getStats() const noexcept
+        {
+            return m_stats;
+        }
+
+        /// @brief Drop all states held in memory (the disk store is left untouched).
+        void clear()
+        {
+            m_states.clear();
+            m_insertionOrder.clear();
+        }
+
+        /// @brief Store the state reached after the prefix with the given hash and verification hash (memory and disk).
+        void store(gate_hash_t hash, gate_hash_t check, const StateVector<BasisStateCount>& state)
+        {
+            remember(hash, check, state);
+            storeToDisk(hash, check, state);
+        }
+
+        /**
+         * @brief     Restore the state of the longest cached prefix of a gate sequence.
+         *
+         * @param prefixHashes  Chained hashes of the sequence (see `circuitPrefixHashes`).
+         * @param state         Receives the cached state; untouched when nothing is found.
+         * @return              Length of the restored prefix (0 when nothing is cached).
+         *
+         * An entry is only restored if its verification hash matches the prefix as well.
+         */
+        template<dimension_t GateCount>
+        dimension_t restoreLongestPrefix(const CircuitPrefixHashes<GateCount>& prefixHashes,
+            StateVector<BasisStateCount>& state)
+        {
+            for (dimension_t Length = prefixHashes.HashableLength; Length > 0; --Length)
+            {
+                const auto Found = m_states.find(prefixHashes.Hashes[Length]);
+                if (Found != m_states.end() && Found->second.Check == prefixHashes.Checks[Length])
+                {
+                    state = Found->second.State;
+                    ++m_stats.Hits;
+                    return Length;
+                }
+            }
+
+            // Memory miss: fall back to the disk store, longest prefix first
+            for (dimension_t Length = prefixHashes.HashableLength; Length > 0 && !m_directory.empty(); --Length)
+            {
+                if (std::optional<StateVector<BasisStateCount>> Loaded = loadFromDisk(prefixHashes.Hashes[Length], prefixHashes.Checks[Length]))
+                {
+                    state = *Loaded;
+                    remember(prefixHashes.Hashes[Length], prefixHashes.Checks[Length], state);
+                    ++m_stats.Hits;
+                    ++m_stats.DiskHits;
+                    return Length;
+                }
+            }
+
+            ++m_stats.Misses;
+            return 0;
+        }
+
+        /**
+         * @brief     Execute a circuit from |0...0>, resuming from the longest cached prefix.
+         *
+         * @param state  Receives the final state.
+         * @param gates  The circuit; caching covers the prefix up to the first gate that is not `HashableGate`.
+         *
+         * The gates after the resumed prefix are executed with the cache-blocked scheduler in
+         * chunks ending at checkpoint positions; the state at each checkpoint and after the
+         * last hashable gate is stored for later runs.
+         */
+        template<typename... Gates>
+        void execute(StateVector<BasisStateCount>& state, const Gates&... gates)
+        {
+            constexpr dimension_t GateCount = sizeof...(Gates);
+
+            const CircuitPrefixHashes<GateCount> PrefixHashes = circuitPrefixHashes<QBitCount>(gates...);
+
+            state = QBitState<QBitCount>()();
+            dimension_t Gate = restoreLongestPrefix(PrefixHashes, state);
+            m_stats.SkippedGates += Gate;
+            m_stats.ExecutedGates += GateCount - Gate;
+
+            while (Gate < PrefixHashes.HashableLength)
+            {
+                dimension_t ChunkEnd = PrefixHashes.HashableLength;
+                if (m_checkpointStride > 0)
+                    ChunkEnd = std::min(ChunkEnd, (Gate / m_checkpointStride + 1) * m_checkpointStride);
+
+                executeCacheBlockedRange(state, Gate, ChunkEnd, gates...);
+                store(PrefixHashes.Hashes[ChunkEnd], PrefixHashes.Checks[ChunkEnd], state);
+                Gate = ChunkEnd;
+            }
+
+            // The unhashable tail is always executed
+            executeCacheBlockedRange(state, Gate, GateCount, gates...);
+        }
+    };
+}
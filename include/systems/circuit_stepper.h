@@ -0,0 +1,332 @@
+#pragma once
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <stop_token>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "solvers/circuit_record.h"
+#include "solvers/layer_scheduler.h"
+#include "wavefunction/state_vector.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Step-wise circuit execution: a coroutine yielding the in-place state between gates.
+    ///
+    /**
+     * @details
+     * Inspecting intermediate states (after each stage of Shor's algorithm, for a debugger or
+     * a streaming visualisation) used to require one circuit per stage, each recomputed from
+     * |0...0>. `QuantumCircuit::withGatesStepwise` instead returns a `CircuitStepGenerator`:
+     * a coroutine that executes the circuit on a state owned by its frame and suspends after
+     * every gate, or only at `Barrier` markers, yielding a `CircuitStep` with a read-only view
+     * of that state. Nothing is copied; the view is valid until the generator is resumed.
+     *
+     * Between two barriers the gates are layered and run through the cache-blocked scheduler as usual.
+     * Execution stops when the consumer stops iterating (destroying the generator) or when
+     * the optional `std::stop_token` is triggered.
+     *
+     * The gates are recorded (see solvers/circuit_record.h) before the coroutine starts, so the
+     * generator does not refer to the gate objects and may outlive them.
+     */
+
+    /// @brief Labelled marker in a gate sequence; it does not change the state.
+    ///
+    /// Barriers delimit the steps of `withGatesStepwise` in `StepMode::Barriers`; `withGates`
+    /// accepts them too and treats them as no-ops.
+    struct Barrier
+    {
+        /// @brief Label reported with the step; must outlive the generator (e.g. a string literal).
+        std::string_view Label;
+
+        /// @brief Barriers act on no qubit.
+        constexpr dimension_t getAffectedMask() const noexcept
+        {
+            return 0;
+        }
+
+        /// @brief No-op range kernel, so a barrier never splits a cache-blocked run.
+        template<dimension_t StateCount>
+        constexpr void applyInPlace(StateVector<StateCount>&,
+            const QubitLayout<QBitCountOf<StateCount>>&, dimension_t, dimension_t) const noexcept
+        {
+        }
+
+        /// @brief Identity, functional style.
+        template<dimension_t StateCount>
+        constexpr StateVector<StateCount> operator()(StateVector<StateCount> state) const noexcept
+        {
+            return state;
+        }
+    };
+
+    /// @brief Where `withGatesStepwise` suspends.
+    enum class StepMode
+    {
+        /// After every gate (and at every barrier, whose label is then reported with the step).
+        EachGate,
+
+        /// Only at barriers, and once more at the end of the circuit (with an empty label).
+        Barriers
+    };
+
+    /// @brief One suspension point of a step-wise execution.
+    /// @tparam StateCount  Dimension of the state vector.
+    template<dimension_t StateCount>
+    struct CircuitStep
+    {
+        /// @brief Number of gates applied so far (barriers excluded).
+        dimension_t GateIndex = 0;
+
+        /// @brief Label of the barrier at this point, empty if there is none.
+        std::string_view Label;
+
+        /// @brief The state after GateIndex gates, owned by the generator.
+        const StateVector<StateCount>* State = nullptr;
+
+        /// @brief Read-only view of the state; valid until the generator is resumed.
+        const StateVector<StateCount>& getStateVector() const noexcept
+        {
+            return *State;
+        }
+    };
+
+    /**
+     * @brief     Move-only generator of circuit steps (input range usable in range-based for).
+     *
+     * @tparam StateCount  Dimension of the state vector.
+     */
+    template<dimension_t StateCount>
+    class CircuitStepGenerator
+    {
+    public:
+        struct promise_type
+        {
+            const CircuitStep<StateCount>* m_current = nullptr;
+            std::exception_ptr m_exception;
+
+            CircuitStepGenerator get_return_object() noexcept
+            {
+                return CircuitStepGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            std::suspend_always yield_value(const CircuitStep<StateCount>& step) noexcept
+            {
+                m_current = &step;
+                return {};
+            }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() noexcept
+            {
+                m_exception = std::current_exception();
+            }
+        };
+
+        /// @brief Sentinel marking the end of the steps.
+        struct Sentinel {};
+
+        /// @brief Input iterator over the steps.
+        class Iterator
+        {
+            std::coroutine_handle<promise_type> m_handle;
+
+        public:
+            using value_type = CircuitStep<StateCount>;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() noexcept = default;
+            explicit Iterator(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) {}
+
+            const CircuitStep<StateCount>& operator*() const noexcept
+            {
+                return *m_handle.promise().m_current;
+            }
+
+            Iterator& operator++()
+            {
+                m_handle.resume();
+                if (m_handle.done() && m_handle.promise().m_exception)
+                    std::rethrow_exception(m_handle.promise().m_exception);
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            bool operator==(Sentinel) const noexcept
+            {
+                return !m_handle || m_handle.done();
+            }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+
+        explicit CircuitStepGenerator(std::coroutine_handle<promise_type> handle) noexcept
+            : m_handle(handle)
+        {
+        }
+
+    public:
+        CircuitStepGenerator(const CircuitStepGenerator&) = delete;
+        CircuitStepGenerator& operator=(const CircuitStepGenerator&) = delete;
+
+        CircuitStepGenerator(CircuitStepGenerator&& other) noexcept
+            : m_handle(std::exchange(other.m_handle, {}))
+        {
+        }
+
+        CircuitStepGenerator& operator=(CircuitStepGenerator&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_handle)
+                    m_handle.destroy();
+                m_handle = std::exchange(other.m_handle, {});
+            }
+            return *this;
+        }
+
+        /// @brief Destroying the generator cancels the remaining execution.
+        ~CircuitStepGenerator()
+        {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        /// @brief Start (or continue) the execution up to the first step.
+        Iterator begin()
+        {
+            Iterator It(m_handle);
+            ++It;
+            return It;
+        }
+
+        Sentinel end() const noexcept
+        {
+            return {};
+        }
+    };
+
+    /// @brief A recorded circuit together with the positions and labels of its barriers.
+    /// @tparam MaxQBitCount  Width of the widest recorded gate.
+    /// @tparam Capacity      Maximum number of recorded gates.
+    template<dimension_t MaxQBitCount, dimension_t Capacity>
+    struct SteppedCircuit
+    {
+        CircuitRecord<MaxQBitCount, Capacity> Record{};
+
+        /// HasBarrier[g] is true if a barrier follows the first g gates.
+        std::array<bool, Capacity + 1> HasBarrier{};
+
+        /// Label of the barrier following the first g gates (the last one if there are several).
+        std::array<std::string_view, Capacity + 1> BarrierLabels{};
+
+        /// @brief Record a pack of gates and barriers.
+        template<typename... Gates>
+        static constexpr SteppedCircuit fromGates(const Gates&... gates) noexcept
+        {
+            SteppedCircuit Circuit{};
+            Circuit.append(gates...);
+            return Circuit;
+        }
+
+        /// @brief Append a pack of gates and barriers in place (for circuits kept on the heap).
+        template<typename... Gates>
+        constexpr void append(const Gates&... gates) noexcept
+        {
+            ([&]
+                {
+                    if constexpr (std::same_as<Gates, Barrier>)
+                    {
+                        HasBarrier[Record.GateCount] = true;
+                        BarrierLabels[Record.GateCount] = gates.Label;
+                    }
+                    else
+                    {
+                        Record.push(recordGate<MaxQBitCount>(gates));
+                    }
+                }(), ...);
+        }
+    };
+
+    /// @brief Concept for the elements of a step-wise gate pack: recordable gates and barriers.
+    template<typename GateType>
+    concept SteppableGate = RecordableGate<GateType> || std::same_as<GateType, Barrier>;
+
+    /// @brief Number of qubits of a steppable gate (zero for barriers).
+    template<SteppableGate GateType>
+    constexpr dimension_t stepped_qbit_count_v = []
+    {
+        if constexpr (std::same_as<GateType, Barrier>)
+            return dimension_t{ 0 };
+        else
+            return recorded_qbit_count_v<GateType>;
+    }();
+
+    /**
+     * @brief     Coroutine executing a recorded circuit step by step.
+     *
+     * @param circuit     One-element heap storage of the recorded circuit, moved into the coroutine
+     *                    frame (the generator may outlive the caller); only read through a const reference.
+     * @param mode        Where to suspend.
+     * @param stopToken   Checked before every step; a stop request ends the execution.
+     */
+    template<dimension_t QBitCount, dimension_t MaxQBitCount, dimension_t Capacity>
+    CircuitStepGenerator<ConstexprMath::pow2(QBitCount)> executeStepwise(
+        std::vector<SteppedCircuit<MaxQBitCount, Capacity>> circuit, StepMode mode, std::stop_token stopToken)
+    {
+        constexpr dimension_t BasisStateCount = ConstexprMath::pow2(QBitCount);
+
+        const SteppedCircuit<MaxQBitCount, Capacity>& Circuit = circuit[0];
+
+        StateVector<BasisStateCount> State{};
+        State.m_StateVector[0] = cplx_t::fromReal(1.0);
+
+        CircuitStep<BasisStateCount> Step{ 0, {}, &State };
+
+        if (Circuit.HasBarrier[0])
+        {
+            Step.Label = Circuit.BarrierLabels[0];
+            co_yield Step;
+        }
+
+        const dimension_t GateCount = Circuit.Record.GateCount;
+
+        // An empty circuit still ends with its end-of-circuit step (unless a barrier already reported it)
+        if (mode == StepMode::Barriers && GateCount == 0 && !Circuit.HasBarrier[0] && !stopToken.stop_requested())
+            co_yield Step;
+
+        dimension_t Applied = 0;
+        while (Applied < GateCount && !stopToken.stop_requested())
+        {
+            // Execute up to the next suspension point
+            dimension_t Next = Applied + 1;
+            if (mode == StepMode::Barriers)
+            {
+                while (Next < GateCount && !Circuit.HasBarrier[Next])
+                    ++Next;
+            }
+
+            executeLayered(State, Circuit.Record, Applied, Next);
+            Applied = Next;
+
+            if (mode == StepMode::EachGate || Circuit.HasBarrier[Applied] || Applied == GateCount)
+            {
+                Step.GateIndex = Applied;
+                Step.Label = Circuit.HasBarrier[Applied] ? Circuit.BarrierLabels[Applied] : std::string_view{};
+                co_yield Step;
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "solvers/compressed_gate_solver.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Executor running a circuit on a block-compressed state vector.
+
+    /// @brief Forward declaration of QuantumCircuit for friend declaration.
+    template<index_t QBitCount>
+    class QuantumCircuit;
+
+    /// @brief Executor that keeps the state compressed and runs every gate on decoded tiles.
+    /// @tparam QBitCount  Number of qubits in the circuit.
+    /// @tparam Format     The amplitude format (`SharedExponentFormat`, `BFloat16Format`).
+    ///
+    /// Trades a bounded error for a 4x smaller state; the error bound and the norm drift are
+    /// reported next to the state, and `renormalize()` removes the drift. The compressed
+    /// blocks are heap-allocated, so the executor cannot be a constexpr variable.
+    template<dimension_t QBitCount, AmplitudeFormat Format>
+    class CompressedCircuitExecutor
+    {
+        /// @brief Precompute 2^QBitCount for convenience
+        static constexpr dimension_t BasisStateCount = ConstexprMath::pow2(QBitCount);
+
+        /// @brief The compressed state vector of the circuit.
+        CompressedStateVector<BasisStateCount, Format> m_stateVector;
+
+        /// @brief Construct executor and immediately execute provided gates, starting from |0>.
+        template<RecordableGate... Gates>
+        constexpr CompressedCircuitExecutor(const Gates& ... gates)
+            : m_stateVector(CompressedStateVector<BasisStateCount, Format>::basisState(0))
+        {
+            applyCompressedGates<QBitCount>(m_stateVector, gates...);
+        }
+
+        friend class QuantumCircuit<QBitCount>;
+
+    public:
+        /// @brief Get the compressed state vector.
+        constexpr const CompressedStateVector<BasisStateCount, Format>& getCompressedStateVector() const noexcept
+        {
+            return m_stateVector;
+        }
+
+        /// @brief Get the final amplitude of a basis state, decoded from its block.
+        constexpr cplx_t getAmplitude(dimension_t basisIndex) const noexcept
+        {
+            return m_stateVector.amplitude(basisIndex);
+        }
+
+        /// @brief Get the final state vector, decompressed (small registers only).
+        constexpr StateVector<BasisStateCount> getStateVector() const noexcept
+        {
+            return m_stateVector.toStateVector();
+        }
+
+        /// @brief Get the probabilities of measuring the basis states, decoded block by block (small registers only).
+        constexpr probability_vector_t<BasisStateCount> getProbabilities() const noexcept
+        {
+            return m_stateVector.getProbabilities();
+        }
+
+        /// @brief Upper bound on the distance between the stored and the exact final state.
+        constexpr float_t getAccumulatedError() const noexcept
+        {
+            return m_stateVector.getAccumulatedError();
+        }
+
+        /// @brief Squared norm of the stored state.
+        constexpr float_t getNormSquared() const noexcept
+        {
+            return m_stateVector.getNormSquared();
+        }
+
+        /// @brief Rescale the stored state to unit norm.
+        constexpr void renormalize() noexcept
+        {
+            m_stateVector.renormalize();
+        }
+    };
+}
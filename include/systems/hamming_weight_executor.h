@@ -0,0 +1,72 @@
+#pragma once
+#include <stdexcept>
+
+#include "solvers/hamming_weight_gate_solver.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Executor running a particle-number conserving circuit in its fixed-weight subspace.
+
+    /// @brief Forward declaration of QuantumCircuit for friend declaration.
+    template<index_t QBitCount>
+    class QuantumCircuit;
+
+    /// @brief Executor that keeps only the C(QBitCount, Weight) amplitudes of one Hamming-weight sector.
+    /// @tparam QBitCount  Number of qubits in the circuit.
+    /// @tparam Weight     Number of |1⟩ qubits of the initial state, preserved by every gate.
+    ///
+    /// Every gate is checked with `conservesHammingWeight` before it runs; a gate failing the
+    /// check would leave the subspace, and is rejected with std::invalid_argument.
+    template<dimension_t QBitCount, dimension_t Weight>
+    class HammingWeightExecutor
+    {
+        /// @brief The subspace state vector of the circuit.
+        HammingWeightStateVector<QBitCount, Weight> m_stateVector;
+
+        /// @brief Construct executor and immediately execute provided gates from a basis state of weight Weight.
+        /// @throws std::invalid_argument if the initial basis state is not in the subspace, or if a
+        ///         gate does not conserve the Hamming weight.
+        template<RecordableGate... Gates>
+        constexpr HammingWeightExecutor(dimension_t initialBasisState, const Gates& ... gates)
+            : m_stateVector(HammingWeightStateVector<QBitCount, Weight>::basisState(initialBasisState))
+        {
+            constexpr dimension_t MaxQBitCount = recorded_max_qbit_count_v<Gates...>;
+            const auto apply = [&](const GateRecord<MaxQBitCount>& gate)
+                {
+                    if (!QCC::conservesHammingWeight(gate))
+                        throw std::invalid_argument("a gate does not conserve the Hamming weight");
+                    applyHammingWeightGate(m_stateVector, gate);
+                };
+            (apply(recordGate<MaxQBitCount>(gates)), ...);
+        }
+
+        friend class QuantumCircuit<QBitCount>;
+
+    public:
+        /// @brief Get the final state in the subspace, indexed by combinatorial rank.
+        constexpr const HammingWeightStateVector<QBitCount, Weight>& getSubspaceStateVector() const noexcept
+        {
+            return m_stateVector;
+        }
+
+        /// @brief Get the final amplitude of a basis state; zero for other weights.
+        /// @throws std::invalid_argument if the index is outside the register.
+        constexpr cplx_t getAmplitude(dimension_t basisIndex) const
+        {
+            return m_stateVector.amplitude(basisIndex);
+        }
+
+        /// @brief Get the probabilities of the subspace basis states, indexed by combinatorial rank.
+        constexpr std::vector<float_t> getProbabilities() const
+        {
+            return m_stateVector.getProbabilities();
+        }
+
+        /// @brief Get the final state embedded into the full state vector (small registers only).
+        constexpr StateVector<ConstexprMath::pow2(QBitCount)> getStateVector() const
+        {
+            return m_stateVector.toStateVector();
+        }
+    };
+}
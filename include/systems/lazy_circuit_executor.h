@@ -0,0 +1,234 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "solvers/circuit_optimizer.h"
+#include "solvers/layer_scheduler.h"
+#include "solvers/observable.h"
+#include "wavefunction/state_vector.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Executor that records a circuit and only evaluates it when a result is queried.
+    ///
+    /**
+     * @details
+     * `QuantumCircuitExecutor` runs every gate in its constructor, so the circuit cannot be
+     * rewritten afterwards. `LazyCircuitExecutor` records the gates instead (see
+     * solvers/circuit_record.h) and evaluates them per query:
+     *  - the recording is optimised for the query (light-cone pruning to the queried qubits,
+     *    fusion of nested gates, cancellation of identities, see solvers/circuit_optimizer.h);
+     *  - the leading gates that map basis states to basis states (X, CX, Toffoli, SWAP,
+     *    phases) are tracked on the single amplitude of the initial basis state, and the state
+     *    vector is only swept from the first gate that creates a superposition on;
+     *  - the remaining gates are grouped into layers of disjoint gates, each applied in one
+     *    fused sweep (see solvers/layer_scheduler.h), and the layers run through the
+     *    cache-blocked scheduler; diagonal records are applied as per-amplitude phases.
+     *
+     * Queries are const and do not cache their result, so every query only pays for what it
+     * needs; keep the returned state if it is used several times. The recording and the
+     * optimised records of the queries are kept on the heap, since every record is as wide
+     * as the widest gate of the circuit.
+     */
+
+    /// @brief Forward declaration of QuantumCircuit for friend declaration.
+    template<index_t QBitCount>
+    class QuantumCircuit;
+
+    namespace Detail
+    {
+        /// @brief SplitMix64 step: advance the state and return the next pseudo-random word.
+        constexpr std::uint64_t splitMix64(std::uint64_t& state) noexcept
+        {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /// @brief Uniform real number in [0, 1) from the 53 high bits of a random word.
+        constexpr float_t uniformFromBits(std::uint64_t bits) noexcept
+        {
+            return static_cast<float_t>(bits >> 11) * (1.0 / 9007199254740992.0);
+        }
+    }
+
+    /// @brief Lazy executor: records the gates and evaluates them per query.
+    /// @tparam QBitCount         Number of qubits in the circuit.
+    /// @tparam MaxGateQBitCount  Width of the widest recorded gate.
+    /// @tparam GateCount         Number of recorded gates.
+    template<dimension_t QBitCount, dimension_t MaxGateQBitCount, dimension_t GateCount>
+        requires (QBitCount > 0 && QBitCount <= sizeof(dimension_t) * 8)
+    class LazyCircuitExecutor
+    {
+    public:
+        /// @brief Precompute 2^QBitCount for convenience
+        static constexpr dimension_t BasisStateCount = ConstexprMath::pow2(QBitCount);
+
+        using record_t = CircuitRecord<MaxGateQBitCount, GateCount>;
+
+    private:
+        /// @brief Support mask covering the whole register (shifted down from all ones: 2^64 - 1 does not fit).
+        static constexpr dimension_t AllQBits = ~dimension_t{ 0 } >> (sizeof(dimension_t) * 8 - QBitCount);
+
+        /// @brief The recorded, unoptimised circuit (on the heap).
+        std::vector<record_t> m_record = std::vector<record_t>(1);
+
+        /// @brief Record the gates without executing them.
+        template<RecordableGate... Gates>
+        constexpr explicit LazyCircuitExecutor(const Gates& ... gates)
+        {
+            m_record[0].append(gates...);
+        }
+
+        friend class QuantumCircuit<QBitCount>;
+
+        /// @brief Optimise the recorded circuit for a query on the given qubits, into heap storage.
+        constexpr std::vector<OptimizedCircuit<MaxGateQBitCount, GateCount>> optimizeOnHeap(dimension_t qbitMask) const
+        {
+            std::vector<OptimizedCircuit<MaxGateQBitCount, GateCount>> Optimized(1);
+            optimizeCircuit(m_record[0], qbitMask, Optimized[0]);
+            return Optimized;
+        }
+
+        /// @brief Evaluate a recorded circuit on |0...0>.
+        static constexpr StateVector<BasisStateCount> evaluate(const record_t& circuit)
+        {
+            // Track the basis-state-preserving prefix on a single amplitude
+            dimension_t Index = 0;
+            cplx_t Amplitude = cplx_t::fromReal(1.0);
+            dimension_t FirstDenseGate = 0;
+            while (FirstDenseGate < circuit.GateCount && circuit.Gates[FirstDenseGate].IsPhasePermutation)
+            {
+                circuit.Gates[FirstDenseGate].applyToBasisState(Index, Amplitude);
+                ++FirstDenseGate;
+            }
+
+            StateVector<BasisStateCount> State{};
+            State.m_StateVector[Index] = Amplitude;
+
+            executeLayered(State, circuit, FirstDenseGate, circuit.GateCount);
+            return State;
+        }
+
+        /// @brief Probabilities of the listed qubits (bit q of the index is qubit QBits[q]), all qubits if empty.
+        template<dimension_t... QBits>
+        constexpr probability_vector_t<ConstexprMath::pow2(sizeof...(QBits) == 0 ? QBitCount : sizeof...(QBits))>
+            probabilitiesOf() const
+        {
+            if constexpr (sizeof...(QBits) == 0)
+                return getProbabilities();
+            else
+                return getMarginalProbabilities<QBits...>();
+        }
+
+    public:
+        /// @brief Get the recorded circuit, as given.
+        constexpr const record_t& getRecord() const noexcept
+        {
+            return m_record[0];
+        }
+
+        /// @brief Optimise the recorded circuit for a query on the given qubits.
+        /// @param qbitMask  Qubits whose reduced state the query needs (default: the full state).
+        ///
+        /// Returns the record by value; the queries below keep theirs on the heap instead.
+        constexpr OptimizedCircuit<MaxGateQBitCount, GateCount> optimize(dimension_t qbitMask = AllQBits) const
+        {
+            return optimizeCircuit(m_record[0], qbitMask);
+        }
+
+        /// @brief Report of what the optimisation removes when the full state is queried.
+        constexpr CircuitOptimizationReport getOptimizationReport() const
+        {
+            return optimizeOnHeap(AllQBits)[0].Report;
+        }
+
+        /// @brief Evaluate the full final state vector.
+        constexpr StateVector<BasisStateCount> getStateVector() const
+        {
+            return evaluate(optimizeOnHeap(AllQBits)[0].Record);
+        }
+
+        /// @brief Evaluate the probabilities of all basis states.
+        constexpr probability_vector_t<BasisStateCount> getProbabilities() const
+        {
+            return getStateVector().getProbabilities();
+        }
+
+        /**
+         * @brief     Evaluate the marginal probabilities of a few qubits.
+         *
+         * @tparam QBits  The measured qubits; bit q of the result index is qubit QBits[q].
+         *
+         * Only the gates in the backward light cone of the measured qubits are executed.
+         */
+        template<dimension_t... QBits>
+            requires (sizeof...(QBits) > 0 && ((QBits < QBitCount) && ...))
+        constexpr probability_vector_t<ConstexprMath::pow2(sizeof...(QBits))> getMarginalProbabilities() const
+        {
+            constexpr qbit_list_t<sizeof...(QBits)> Measured{ QBits... };
+            constexpr dimension_t MeasuredMask = ((dimension_t(1) << QBits) | ...);
+
+            const StateVector<BasisStateCount> State = evaluate(optimizeOnHeap(MeasuredMask)[0].Record);
+
+            probability_vector_t<ConstexprMath::pow2(sizeof...(QBits))> Marginals{};
+            for (dimension_t i = 0; i < BasisStateCount; ++i)
+            {
+                dimension_t Outcome = 0;
+                for (dimension_t q = 0; q < Measured.size(); ++q)
+                    Outcome |= ((i >> Measured[q]) & 1) << q;
+                Marginals[Outcome] += State.m_StateVector[i].normSquared();
+            }
+            return Marginals;
+        }
+
+        /**
+         * @brief     Draw measurement outcomes in the computational basis.
+         *
+         * @tparam SampleCount  Number of outcomes to draw.
+         * @tparam QBits        The measured qubits (bit q of an outcome is qubit QBits[q]); all qubits if empty.
+         * @param seed          Seed of the deterministic SplitMix64 generator.
+         * @return              The sampled outcomes.
+         */
+        template<dimension_t SampleCount, dimension_t... QBits>
+        constexpr std::array<index_t, SampleCount> sample(std::uint64_t seed = 0) const
+        {
+            const auto Probabilities = probabilitiesOf<QBits...>();
+
+            // Cumulative distribution, then one binary search per sample
+            auto Cumulative = Probabilities;
+            for (dimension_t i = 1; i < Cumulative.size(); ++i)
+                Cumulative[i] += Cumulative[i - 1];
+
+            std::array<index_t, SampleCount> Samples{};
+            std::uint64_t RandomState = seed;
+            for (index_t& Sample : Samples)
+            {
+                const float_t u = Detail::uniformFromBits(Detail::splitMix64(RandomState)) * Cumulative.back();
+
+                dimension_t Low = 0;
+                dimension_t High = Cumulative.size() - 1;
+                while (Low < High)
+                {
+                    const dimension_t Mid = (Low + High) / 2;
+                    if (Cumulative[Mid] > u)
+                        High = Mid;
+                    else
+                        Low = Mid + 1;
+                }
+                Sample = Low;
+            }
+            return Samples;
+        }
+
+        /// @brief Evaluate ⟨ψ|O|ψ⟩, executing only the gates in the light cone of the observable's qubits.
+        template<ObservableLike ObservableType>
+        constexpr float_t expectationValue(const ObservableType& observable) const
+        {
+            const StateVector<BasisStateCount> State = evaluate(optimizeOnHeap(observableSupportMask(observable) & AllQBits)[0].Record);
+            return observable.expectationValue(State);
+        }
+    };
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "solvers/unitary_builder.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Executor running one circuit on a batch of input states at once (multi-RHS).
+
+    /// @brief Forward declaration of QuantumCircuit for friend declaration.
+    template<index_t QBitCount>
+    class QuantumCircuit;
+
+    /// @brief Batch of computational basis states, one basis index per batch member.
+    /// @tparam QBitCount  Number of qubits.
+    /// @tparam BatchSize  Number of batch members.
+    /// @param basisIndices  The basis state |basisIndices[b]> of every member b.
+    template<dimension_t QBitCount, dimension_t BatchSize>
+    constexpr BatchedStateVector<ConstexprMath::pow2(QBitCount), BatchSize>
+        makeBasisInputs(const std::array<dimension_t, BatchSize>& basisIndices) noexcept
+    {
+        BatchedStateVector<ConstexprMath::pow2(QBitCount), BatchSize> Inputs{};
+        for (dimension_t b = 0; b < BatchSize; ++b)
+        {
+            Inputs.m_Amplitudes[basisIndices[b]][b] = cplx_t::fromReal(1.0);
+        }
+        return Inputs;
+    }
+
+    /// @brief Executor that runs a circuit on BatchSize input states in one batch-interleaved pass per gate.
+    /// @tparam QBitCount  Number of qubits in the circuit.
+    /// @tparam BatchSize  Number of input (and resulting) state vectors.
+    /// @tparam Gates      Gate-like callables; gates exposing their matrix use the batched kernel.
+    ///
+    /// The states are stored [index][batch], so every gate matrix element is loaded once and
+    /// applied to BatchSize contiguous amplitudes (see batched_gate_solver.h), instead of
+    /// streaming the whole state once per input.
+    template<dimension_t QBitCount, dimension_t BatchSize, typename... Gates>
+    class MultiStateExecutor
+    {
+        /// @brief Precompute 2^QBitCount for convenience
+        static constexpr dimension_t BasisStateCount = ConstexprMath::pow2(QBitCount);
+
+        /// @brief The state vectors of all batch members, stored [index][batch].
+        BatchedStateVector<BasisStateCount, BatchSize> m_stateVectors;
+
+        /// @brief Construct executor and immediately execute provided gates on every input state.
+        /// @param inputs  The input states, stored [index][batch].
+        /// @param gates   Gates to apply in order.
+        constexpr MultiStateExecutor(const BatchedStateVector<BasisStateCount, BatchSize>& inputs, const Gates& ... gates)
+            : m_stateVectors(inputs)
+        {
+            (applyGateToColumns(m_stateVectors, gates), ...);
+        }
+
+        friend class QuantumCircuit<QBitCount>;
+
+    public:
+        /// @brief Get the final state vector of one batch member.
+        /// @param batch  Index of the input state.
+        constexpr StateVector<BasisStateCount> getStateVector(dimension_t batch) const noexcept
+        {
+            return m_stateVectors.getStateVector(batch);
+        }
+
+        /// @brief Get the final state vectors of the whole batch in batch-interleaved layout.
+        constexpr const BatchedStateVector<BasisStateCount, BatchSize>& getBatchedStateVector() const noexcept
+        {
+            return m_stateVectors;
+        }
+    };
+}
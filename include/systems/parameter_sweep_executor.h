@@ -0,0 +1,107 @@
+#pragma once
+#include <tuple>
+#include <type_traits>
+
+#include "solvers/batched_gate_solver.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Executor running one circuit structure over a batch of parameter sets at once.
+
+    /// @brief Forward declaration of QuantumCircuit for friend declaration.
+    template<index_t QBitCount>
+    class QuantumCircuit;
+
+    /// @brief Concept for gates that depend on the parameter set of each batch member.
+    template<typename GateType, dimension_t StateCount, dimension_t BatchSize, dimension_t ParameterCount>
+    concept ParametrizedBatchGate =
+        requires(const GateType g, BatchedStateVector<StateCount, BatchSize>& state,
+            const parameter_sets_t<BatchSize, ParameterCount>& parameterSets)
+    {
+        g.applyBatched(state, parameterSets);
+    };
+
+    /// @brief Concept for gates with a fixed matrix, applied identically to every batch member.
+    template<typename GateType>
+    concept FixedMatrixGate =
+        requires(const GateType g)
+    {
+        g.getGateMatrix();
+        g.getAffectedBits();
+    };
+
+    /// @brief Concept for gates accepted by the batched executors.
+    template<typename GateType, dimension_t StateCount, dimension_t BatchSize, dimension_t ParameterCount>
+    concept BatchGateLike =
+        ParametrizedBatchGate<GateType, StateCount, BatchSize, ParameterCount> || FixedMatrixGate<GateType>;
+
+    /// @brief Apply one gate to every member of a batch.
+    /// @param state          The batch of global state vectors, updated in place.
+    /// @param gate           The gate to apply.
+    /// @param parameterSets  One parameter set per batch member (ignored by fixed gates).
+    template<dimension_t StateCount, dimension_t BatchSize, dimension_t ParameterCount, typename GateType>
+        requires BatchGateLike<GateType, StateCount, BatchSize, ParameterCount>
+    constexpr void applyBatchedGate(BatchedStateVector<StateCount, BatchSize>& state, const GateType& gate,
+        const parameter_sets_t<BatchSize, ParameterCount>& parameterSets) noexcept
+    {
+        if constexpr (ParametrizedBatchGate<GateType, StateCount, BatchSize, ParameterCount>)
+        {
+            gate.applyBatched(state, parameterSets);
+        }
+        else
+        {
+            constexpr dimension_t GateQBitCount =
+                std::tuple_size_v<std::remove_cvref_t<decltype(gate.getAffectedBits())>>;
+            applyBatchedGateMatrix<GateQBitCount>(state, gate.getGateMatrix(), gate.getAffectedBits());
+        }
+    }
+
+    /// @brief Executor that runs a circuit for BatchSize parameter sets in one batch-interleaved pass per gate.
+    /// @tparam QBitCount       Number of qubits in the circuit.
+    /// @tparam BatchSize       Number of parameter sets (and resulting state vectors).
+    /// @tparam ParameterCount  Number of parameters in each set.
+    /// @tparam Gates           Fixed gates (`QuantumGateOp`) and swept gates (`SweptGateOp`).
+    template<dimension_t QBitCount, dimension_t BatchSize, dimension_t ParameterCount, typename... Gates>
+    class ParameterSweepExecutor
+    {
+        /// @brief Precompute 2^QBitCount for convenience
+        static constexpr dimension_t BasisStateCount = ConstexprMath::pow2(QBitCount);
+
+        /// @brief The state vectors of all batch members, stored [index][batch].
+        BatchedStateVector<BasisStateCount, BatchSize> m_stateVectors;
+
+        /// @brief Construct executor and immediately execute provided gates for every parameter set.
+        /// @param parameterSets  One parameter set per batch member.
+        /// @param gates          Gates to apply in order.
+        constexpr ParameterSweepExecutor(const parameter_sets_t<BatchSize, ParameterCount>& parameterSets,
+            const Gates& ... gates)
+            : m_stateVectors{}
+        {
+            // Initialize every member to the |0...0> computational basis state
+            for (dimension_t b = 0; b < BatchSize; ++b)
+            {
+                m_stateVectors[0][b] = cplx_t::fromReal(1.0);
+            }
+
+            // Apply the provided gates in sequence
+            (applyBatchedGate(m_stateVectors, gates, parameterSets), ...);
+        }
+
+        friend class QuantumCircuit<QBitCount>;
+
+    public:
+        /// @brief Get the final state vector of one batch member.
+        /// @param batch  Index of the parameter set.
+        constexpr StateVector<BasisStateCount> getStateVector(dimension_t batch) const noexcept
+        {
+            return m_stateVectors.getStateVector(batch);
+        }
+
+        /// @brief Get the final state vectors of the whole batch in batch-interleaved layout.
+        constexpr const BatchedStateVector<BasisStateCount, BatchSize>& getBatchedStateVector() const noexcept
+        {
+            return m_stateVectors;
+        }
+    };
+}
@@ -1,9 +1,32 @@
 ﻿#pragma once
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 #include "wavefunction/qbits.h"
 #include "solvers/quantum_gate_solver.h"
+#include "solvers/parametric_gate_solver.h"
+#include "solvers/permutation_gate_solver.h"
+#include "solvers/phase_oracle_solver.h"
+#include "solvers/pauli_rotation_solver.h"
+#include "solvers/fourier_transform_solver.h"
+#include "solvers/phase_estimation_solver.h"
+#include "solvers/sub_circuit.h"
+#include "solvers/partial_trace.h"
+#include "solvers/state_metrics.h"
+#include "solvers/unitary_builder.h"
+#include "solvers/gate_scheduler.h"
+#include "solvers/adjoint_gradient.h"
+#include "solvers/backend_cost_model.h"
+#include "systems/parameter_sweep_executor.h"
+#include "systems/multi_state_executor.h"
+#include "systems/compressed_circuit_executor.h"
+#include "systems/hamming_weight_executor.h"
+#include "systems/circuit_prefix_cache.h"
+#include "systems/lazy_circuit_executor.h"
+#include "systems/schrodinger_feynman_executor.h"
+#include "systems/tensor_network_executor.h"
+#include "systems/circuit_stepper.h"
 
 #include "quantum_gates/common_gates.h"
 #include "quantum_gates/iqft_gate.h"
@@ -45,6 +68,9 @@ namespace KetCat::QCC
         /// @brief The internal global state vector (amplitudes for 2^QBitCount basis states).
         StateVector<BasisStateCount> m_stateVector;
 
+        /// @brief How the gates were executed, and why.
+        BackendDecision m_backendDecision = unrecordedCircuitDecision();
+
 
         /// @brief Construct executor and immediately execute provided gates.
         /// @param gates  Variadic list of gate-like callables to apply in order.
@@ -57,28 +83,70 @@ namespace KetCat::QCC
             executeCircuit(gates...);
         }
 
+        /// @brief Construct executor and execute provided gates, resuming from the longest cached prefix.
+        /// @param cache  Prefix cache consulted before and updated during execution.
+        /// @param gates  Variadic list of gate-like callables to apply in order.
+        QuantumCircuitExecutor(CircuitPrefixCache<QBitCount>& cache, const Gates& ... gates)
+        {
+            cache.execute(m_stateVector, gates...);
+        }
+
         friend class QuantumCircuit<QBitCount>;
 
     public:
-        /// @brief Recursively apply gates: head then recurse on tail.
-        /// @tparam Gate  First gate type.
-        /// @tparam Rest  Remaining gate types.
-        /// @param gate   Gate callable to apply.
-        /// @param rest   Remaining gate callables.
-        template<typename Gate, typename... Rest>
-        constexpr void executeCircuit(const Gate& gate, const Rest&... rest)
+        /// @brief Apply a sequence of gates to the current state vector.
+        /// @tparam CircuitGates  Gate-like callables to apply.
+        /// @param gates          Gate callables to apply, in order.
+        ///
+        /// The sequence is handed to the cache-blocked scheduler, which groups runs of gates
+        /// acting on low qubits and applies them tile by tile in place instead of streaming
+        /// the whole state through memory once per gate. When every gate exposes its matrix,
+        /// the sequence is summarised first (widths, supports and matrix classes, no matrices)
+        /// and the cost model (see solvers/backend_cost_model.h) picks the cheapest way to run
+        /// it: tracking a single basis state, cache-blocked execution gate by gate, or layers
+        /// of disjoint gates applied in single fused sweeps. The first two run the gates as
+        /// given; only the layered backend records the sequence, as its layers are views into
+        /// gate records. The decision is kept and can be read back with `getBackendDecision`.
+        template<QuantumGateLike... CircuitGates>
+        constexpr void executeCircuit(const CircuitGates&... gates)
         {
-            static_assert(QuantumGateLike<Gate>);
+            if constexpr ((SteppableGate<CircuitGates> && ...))
+            {
+                m_backendDecision = selectBackend<QBitCount>(CircuitSummary<sizeof...(CircuitGates)>::fromGates(gates...));
 
-            // Apply the gate to the current state vector (gate returns a new vector)
-            m_stateVector = gate(m_stateVector);
+                switch (m_backendDecision.Backend)
+                {
+                case SimulationBackend::BasisStateTracking:
+                    if (trackBasisState(m_stateVector, gates...))
+                        break;
+                    [[fallthrough]];
+                case SimulationBackend::Layered:
+                {
+                    constexpr dimension_t MaxGateQBitCount = std::max({ dimension_t{ 1 }, stepped_qbit_count_v<CircuitGates>... });
 
-            // Recurse for the remaining gates
-            executeCircuit(rest...);
+                    // Every record is as wide as the widest gate (64 KiB each next to a 6-qubit gate): heap
+                    std::vector<SteppedCircuit<MaxGateQBitCount, sizeof...(CircuitGates)>> Circuit(1);
+                    Circuit[0].append(gates...);
+                    executeLayered(m_stateVector, Circuit[0].Record, 0, Circuit[0].Record.GateCount);
+                    break;
+                }
+                case SimulationBackend::CacheBlocked:
+                    executeCacheBlocked(m_stateVector, gates...);
+                    break;
+                }
+            }
+            else
+            {
+                m_backendDecision = unrecordedCircuitDecision();
+                executeCacheBlocked(m_stateVector, gates...);
+            }
         }
 
-        /// @brief Base case for recursion: no gates left to apply.
-        constexpr void executeCircuit() {}
+        /// @brief Get the backend the last executed gate sequence ran on, with the estimates behind the choice.
+        constexpr const BackendDecision& getBackendDecision() const noexcept
+        {
+            return m_backendDecision;
+        }
 
 		/// @brief Get the final state vector after executing all gates.
         constexpr const StateVector<BasisStateCount>& getStateVector() const noexcept
@@ -101,5 +169,224 @@ namespace KetCat::QCC
         {
             return QuantumCircuitExecutor<QBitCount, Gates...>(gates...);
         }
+
+        /// @brief Report which backend `withGates` would run the gate sequence on, without executing it.
+        /// @tparam Gates  Gates exposing their matrix and qubits (and `Barrier` markers).
+        /// @param gates   Instances of the gates.
+        /// @return        The `BackendDecision`: circuit profile, per-backend estimates, choice and reason.
+        ///                Unlike the decision of `withGates`, its profile also counts the Clifford gates.
+        ///
+        /// Example: checking that an arithmetic circuit only tracks a basis state
+        ///   constexpr auto Decision = QuantumCircuit<10>().inspectBackend(gates...);
+        ///   static_assert(Decision.Backend == SimulationBackend::BasisStateTracking);
+        template<SteppableGate... Gates>
+        constexpr BackendDecision inspectBackend(const Gates& ... gates) const
+        {
+            constexpr dimension_t MaxGateQBitCount = std::max({ dimension_t{ 1 }, stepped_qbit_count_v<Gates>... });
+            std::vector<SteppedCircuit<MaxGateQBitCount, sizeof...(Gates)>> Circuit(1);
+            Circuit[0].append(gates...);
+
+            BackendDecision Decision = selectBackend<QBitCount>(Circuit[0].Record);
+            Decision.Profile.CliffordGateCount = countCliffordGates(Circuit[0].Record);
+            return Decision;
+        }
+
+        /// @brief Create an executor with the provided gate sequence, reusing cached prefix states.
+        /// @tparam Gates  Gate-like callables to include in the circuit.
+        /// @param cache   Prefix cache; the run resumes from the longest prefix whose state it holds.
+        /// @param gates   Instances of the gate-like callables (passed by reference-to-const).
+        /// @return        A `QuantumCircuitExecutor` holding the same final state as `withGates` would.
+        ///
+        /// Example: re-running a circuit after editing its last gate only executes the edited tail
+        ///   CircuitPrefixCache<8> Cache;
+        ///   auto Run = QuantumCircuit<8>().withGatesCached(Cache, gates..., ParametricGate<Gates::RZ>(theta).toBits(0));
+        template<QuantumGateLike... Gates>
+        QuantumCircuitExecutor<QBitCount, Gates...> withGatesCached(CircuitPrefixCache<QBitCount>& cache,
+            const Gates& ... gates) const
+        {
+            return QuantumCircuitExecutor<QBitCount, Gates...>(cache, gates...);
+        }
+
+        /// @brief Record the gate sequence without executing it; it is optimised and evaluated per query.
+        /// @tparam Gates  Gates exposing their matrix and qubits (`QuantumGateOp`, `ParametricGateOp`).
+        /// @param gates   Instances of the gates (their matrices are copied into the recording).
+        /// @return        A `LazyCircuitExecutor` answering state, probability, sampling and expectation queries.
+        ///
+        /// Example: the marginals of qubit 0 skip every gate outside its light cone
+        ///   auto Lazy = QuantumCircuit<8>().withGatesDeferred(gates...);
+        ///   auto P0 = Lazy.getMarginalProbabilities<0>();
+        template<RecordableGate... Gates>
+        constexpr LazyCircuitExecutor<QBitCount, recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>
+            withGatesDeferred(const Gates& ... gates) const
+        {
+            return LazyCircuitExecutor<QBitCount, recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>(gates...);
+        }
+
+        /// @brief Record the gate sequence for Schrödinger–Feynman evaluation across a cut of the register.
+        /// @tparam CutQBitCount  Number of qubits in the low half; gates crossing the cut are split into paths.
+        /// @param gates          Instances of the gates exposing their matrix and qubits.
+        /// @return               A `SchrodingerFeynmanExecutor` answering amplitude and sampling queries
+        ///                       with two half-size state vectors per path.
+        /// @throws std::overflow_error if the number of paths does not fit in dimension_t.
+        ///
+        /// Example: amplitudes of a 40-qubit circuit with three CX across the middle (8 paths)
+        ///   auto Split = QuantumCircuit<40>().withGatesSchrodingerFeynman<20>(gates...);
+        ///   auto A = Split.getAmplitudes(std::array<dimension_t, 2>{ 0, 0xFFFFF });
+        template<dimension_t CutQBitCount, RecordableGate... Gates>
+            requires (CutQBitCount > 0 && CutQBitCount < QBitCount)
+        constexpr SchrodingerFeynmanExecutor<QBitCount, CutQBitCount, recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>
+            withGatesSchrodingerFeynman(const Gates& ... gates) const
+        {
+            return SchrodingerFeynmanExecutor<QBitCount, CutQBitCount, recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>(gates...);
+        }
+
+        /// @brief Record the gate sequence for amplitude queries by tensor-network contraction.
+        /// @param gates  Instances of the gates exposing their matrix and qubits.
+        /// @return       A `TensorNetworkExecutor` computing ⟨x|C|0⟩ without forming the state vector.
+        ///
+        /// Example: two amplitudes of a 50-qubit circuit, no intermediate above 2^16 amplitudes
+        ///   auto Network = QuantumCircuit<50>().withGatesTensorNetwork(gates...);
+        ///   auto A = Network.getAmplitudes(std::array<dimension_t, 2>{ 0, 1 }, 16);
+        template<RecordableGate... Gates>
+        constexpr TensorNetworkExecutor<QBitCount, recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>
+            withGatesTensorNetwork(const Gates& ... gates) const
+        {
+            return TensorNetworkExecutor<QBitCount, recorded_max_qbit_count_v<Gates...>, sizeof...(Gates)>(gates...);
+        }
+
+        /// @brief Execute the gate sequence step by step, yielding a view of the state at every step.
+        /// @tparam Gates     Recordable gates and `Barrier` markers.
+        /// @param mode       Suspend after every gate or only at barriers.
+        /// @param stopToken  Cancels the remaining steps once a stop is requested.
+        /// @param gates      Instances of the gates (recorded before the first step; need not outlive the generator).
+        /// @return           A `CircuitStepGenerator` producing `CircuitStep`s in range-based for loops.
+        ///
+        /// Example: printing the phase register after each stage
+        ///   for (const auto& Step : QuantumCircuit<8>().withGatesStepwise(StepMode::Barriers, {}, gates..., Barrier{ "modmul 2" }, ...))
+        ///       VisuProbaTable<256>().update<0, 1, 2>(Step.getStateVector());
+        template<SteppableGate... Gates>
+        CircuitStepGenerator<ConstexprMath::pow2(QBitCount)>
+            withGatesStepwise(StepMode mode, std::stop_token stopToken, const Gates& ... gates) const
+        {
+            constexpr dimension_t MaxGateQBitCount = std::max({ dimension_t{ 1 }, stepped_qbit_count_v<Gates>... });
+
+            // Recorded in place on the heap; the coroutine frame takes over the storage
+            std::vector<SteppedCircuit<MaxGateQBitCount, sizeof...(Gates)>> Circuit(1);
+            Circuit[0].append(gates...);
+            return executeStepwise<QBitCount>(std::move(Circuit), mode, std::move(stopToken));
+        }
+
+        /// @brief Execute the gate sequence step by step (without external cancellation).
+        template<SteppableGate... Gates>
+        CircuitStepGenerator<ConstexprMath::pow2(QBitCount)>
+            withGatesStepwise(StepMode mode, const Gates& ... gates) const
+        {
+            return withGatesStepwise(mode, std::stop_token{}, gates...);
+        }
+
+        /// @brief Create an executor running the gate sequence once for every parameter set.
+        /// @tparam BatchSize       Number of parameter sets.
+        /// @tparam ParameterCount  Number of parameters in each set.
+        /// @tparam Gates           Fixed gates and `SweptGateOp` gates reading from the parameter sets.
+        /// @param parameterSets    One parameter set per batch member.
+        /// @param gates            Instances of the gates (passed by reference-to-const).
+        /// @return                 A `ParameterSweepExecutor` holding one final state per parameter set.
+        ///
+        /// Example: sweeping the angle of a rotation without one instantiation per value
+        ///   QuantumCircuit<1>().withParameterSweep(Thetas, SweptGate<1, Gates::RotationY>(0).toBits(0));
+        template<dimension_t BatchSize, dimension_t ParameterCount, typename... Gates>
+            requires (BatchGateLike<Gates, ConstexprMath::pow2(QBitCount), BatchSize, ParameterCount> && ...)
+        constexpr ParameterSweepExecutor<QBitCount, BatchSize, ParameterCount, Gates...>
+            withParameterSweep(const parameter_sets_t<BatchSize, ParameterCount>& parameterSets,
+                const Gates& ... gates) const
+        {
+            return ParameterSweepExecutor<QBitCount, BatchSize, ParameterCount, Gates...>(parameterSets, gates...);
+        }
+
+        /// @brief Create an executor running the gate sequence on every member of a batch of input states.
+        /// @tparam BatchSize  Number of input states.
+        /// @tparam Gates      Gate-like callables to include in the circuit.
+        /// @param inputs      The input states, stored [index][batch].
+        /// @param gates       Instances of the gate-like callables (passed by reference-to-const).
+        /// @return            A `MultiStateExecutor` holding one final state per input.
+        template<dimension_t BatchSize, QuantumGateLike... Gates>
+        constexpr MultiStateExecutor<QBitCount, BatchSize, Gates...>
+            withInputStates(const BatchedStateVector<ConstexprMath::pow2(QBitCount), BatchSize>& inputs,
+                const Gates& ... gates) const
+        {
+            return MultiStateExecutor<QBitCount, BatchSize, Gates...>(inputs, gates...);
+        }
+
+        /// @brief Create an executor running the gate sequence on a batch of computational basis inputs.
+        /// @param basisIndices  The basis state |basisIndices[b]> each batch member starts in.
+        /// @param gates         Instances of the gate-like callables (passed by reference-to-const).
+        ///
+        /// Example: a reversible adder on four inputs at once
+        ///   auto Run = QuantumCircuit<4>().withBasisInputs(std::array<dimension_t, 4>{ 0, 3, 5, 9 }, gates...);
+        ///   auto Out = Run.getStateVector(2);  // circuit applied to |5>
+        template<dimension_t BatchSize, QuantumGateLike... Gates>
+        constexpr MultiStateExecutor<QBitCount, BatchSize, Gates...>
+            withBasisInputs(const std::array<dimension_t, BatchSize>& basisIndices, const Gates& ... gates) const
+        {
+            return MultiStateExecutor<QBitCount, BatchSize, Gates...>(makeBasisInputs<QBitCount>(basisIndices), gates...);
+        }
+
+        /// @brief Create an executor running the gate sequence on a block-compressed state.
+        /// @tparam Format  The amplitude format, `SharedExponentFormat` by default.
+        /// @param gates    Instances of the gates exposing their matrix and qubits.
+        /// @return         A `CompressedCircuitExecutor` holding the final state and its error bound.
+        ///
+        /// Example: a 4x smaller state for a memory-bound run, checked against its error budget
+        ///   auto Run = QuantumCircuit<30>().withGatesCompressed(gates...);  // about 4.1 GiB of blocks, on the heap
+        ///   if (Run.getAccumulatedError() > 1E-3) ...
+        ///   auto A = Run.getAmplitude(0);
+        template<AmplitudeFormat Format = SharedExponentFormat, RecordableGate... Gates>
+        constexpr CompressedCircuitExecutor<QBitCount, Format> withGatesCompressed(const Gates& ... gates) const
+        {
+            return CompressedCircuitExecutor<QBitCount, Format>(gates...);
+        }
+
+        /// @brief Create an executor running a particle-number conserving circuit in its fixed-weight subspace.
+        /// @tparam Weight           Number of |1⟩ qubits, preserved by every gate.
+        /// @param initialBasisState The basis state the circuit starts in (with Weight bits set).
+        /// @param gates             Instances of the gates exposing their matrix and qubits.
+        /// @return                  A `HammingWeightExecutor` holding C(QBitCount, Weight) amplitudes.
+        /// @throws std::invalid_argument if the initial state is outside the register or has another
+        ///         weight, or if a gate does not conserve the weight; in a constant expression this
+        ///         is a compile error.
+        ///
+        /// Example: five electrons in thirty spin orbitals, 142 506 amplitudes instead of 2^30
+        ///   auto Run = QuantumCircuit<30>().withGatesInSubspace<5>(0b11111, givensRotations...);
+        ///   auto A = Run.getAmplitude(0b1011100000);
+        template<dimension_t Weight, RecordableGate... Gates>
+            requires (Weight <= QBitCount)
+        constexpr HammingWeightExecutor<QBitCount, Weight>
+            withGatesInSubspace(dimension_t initialBasisState, const Gates& ... gates) const
+        {
+            return HammingWeightExecutor<QBitCount, Weight>(initialBasisState, gates...);
+        }
+
+        /// @brief Compute the unitary of the gate sequence, propagating all basis columns together.
+        /// @tparam Gates  Gate-like callables to include in the circuit.
+        /// @param gates   Instances of the gate-like callables, applied in order.
+        /// @return        U with U[i][j] = ⟨i| gates |j⟩.
+        ///
+        /// Example: checking that a rewritten circuit is equivalent to the original
+        ///   static_assert(matricesEqual(QuantumCircuit<3>().unitaryOf(original...), QuantumCircuit<3>().unitaryOf(rewritten...)));
+        template<QuantumGateLike... Gates>
+        constexpr matrix_t<ConstexprMath::pow2(QBitCount)> unitaryOf(const Gates& ... gates) const noexcept
+        {
+            return buildUnitary<QBitCount>(gates...);
+        }
+
+        /// @brief Evaluate ⟨H⟩ and its gradient with respect to every circuit parameter (adjoint method).
+        /// @param observable  The Hermitian observable H, e.g. `Observable<1, Gates::Z>().onBits(0)`.
+        /// @param gates       The circuit; parametric gates (`ParametricGateOp`) are differentiated.
+        /// @return            An `AdjointGradientResult` with the expectation value and the gradient.
+        template<ObservableLike ObservableType, InvertibleGate... Gates>
+        constexpr auto adjointGradient(const ObservableType& observable, const Gates& ... gates) const
+        {
+            return QCC::adjointGradient<QBitCount>(observable, gates...);
+        }
     };
 }
\ No newline at end of file
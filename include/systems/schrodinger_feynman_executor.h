@@ -0,0 +1,279 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "solvers/gate_cut.h"
+#include "systems/lazy_circuit_executor.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Schrödinger–Feynman hybrid executor for circuits wider than memory but shallow across a cut.
+    ///
+    /**
+     * @details
+     * The register is cut into a low half (the CutQBitCount lowest qubits) and a high half.
+     * Every gate crossing the cut is decomposed into a sum of products of low-half and
+     * high-half factors (see solvers/gate_cut.h). Picking one term per crossing gate gives a
+     * *path*; along a path the two halves evolve independently, as two ordinary state
+     * vectors of 2^CutQBitCount and 2^(QBitCount - CutQBitCount) amplitudes run through the
+     * usual gate kernels, and the final state is the sum over paths of their tensor products:
+     *   ψ(x_high, x_low) = Σ_p ψ_high,p(x_high) ψ_low,p(x_low).
+     *
+     * The number of paths is the product of the Schmidt ranks of the crossing gates (2 for
+     * a CX, 4 for a SWAP), so the method pays off when few gates cross the cut; a circuit
+     * whose path count does not fit in `dimension_t` is rejected with std::overflow_error.
+     * Paths are independent: `getAmplitudes` splits its path range over hardware threads,
+     * and also takes an explicit range so callers can distribute the path sum further and
+     * add the partial results. Half states are heap-allocated: amplitude queries keep one
+     * pair per thread, with no more threads than paths and no more pairs than fit in a
+     * memory budget (`SchrodingerFeynmanMemoryBudget` by default); `sample` keeps the half
+     * states of all paths.
+     *
+     * Paths are enumerated in mixed radix over the crossing gates, the first crossing gate
+     * varying fastest.
+     */
+
+    /// @brief Default bound, in bytes, on the per-thread working memory of `SchrodingerFeynmanExecutor::getAmplitudes`.
+    constexpr dimension_t SchrodingerFeynmanMemoryBudget = dimension_t(256) << 20;
+
+    /// @brief Schrödinger–Feynman executor: records the gates and sums over Schmidt paths per query.
+    /// @tparam QBitCount         Number of qubits in the circuit.
+    /// @tparam CutQBitCount      Number of qubits in the low half.
+    /// @tparam MaxGateQBitCount  Width of the widest recorded gate.
+    /// @tparam GateCount         Number of recorded gates.
+    template<dimension_t QBitCount, dimension_t CutQBitCount, dimension_t MaxGateQBitCount, dimension_t GateCount>
+        requires (CutQBitCount > 0 && CutQBitCount < QBitCount)
+    class SchrodingerFeynmanExecutor
+    {
+    public:
+        /// @brief Number of amplitudes of the low half.
+        static constexpr dimension_t LowStateCount = ConstexprMath::pow2(CutQBitCount);
+
+        /// @brief Number of amplitudes of the high half.
+        static constexpr dimension_t HighStateCount = ConstexprMath::pow2(QBitCount - CutQBitCount);
+
+        using low_state_t = StateVector<LowStateCount>;
+        using high_state_t = StateVector<HighStateCount>;
+
+    private:
+        /// @brief The gates, decomposed across the cut (on the heap: one record per term, 16 KiB each for 5-qubit gates).
+        std::vector<CutGate<MaxGateQBitCount>> m_gates{};
+
+        /// @brief Number of paths (product of the term counts).
+        dimension_t m_pathCount = 1;
+
+        /// @brief Record and decompose the gates.
+        /// @throws std::overflow_error if the number of paths does not fit in dimension_t.
+        template<RecordableGate... Gates>
+        constexpr explicit SchrodingerFeynmanExecutor(const Gates& ... gates)
+        {
+            m_gates.reserve(GateCount);
+            (m_gates.push_back(cutGate(recordGate<MaxGateQBitCount>(gates), CutQBitCount)), ...);
+            for (const CutGate<MaxGateQBitCount>& Gate : m_gates)
+            {
+                if (m_pathCount > std::numeric_limits<dimension_t>::max() / Gate.TermCount)
+                    throw std::overflow_error("too many gates cross the cut: the path count overflows");
+                m_pathCount *= Gate.TermCount;
+            }
+        }
+
+        friend class QuantumCircuit<QBitCount>;
+
+    public:
+        /// @brief Number of Schmidt paths summed over.
+        constexpr dimension_t getPathCount() const noexcept
+        {
+            return m_pathCount;
+        }
+
+        /**
+         * @brief     Evolve both halves of the register along one path, starting from |0...0>.
+         *
+         * @param path  The path index, in [0, getPathCount()).
+         * @param low   Reset in place, then set to the low-half state of the path.
+         * @param high  Reset in place, then set to the high-half state of the path.
+         */
+        constexpr void evolvePath(dimension_t path, low_state_t& low, high_state_t& high) const noexcept
+        {
+            low.m_StateVector.fill(cplx_t{});
+            high.m_StateVector.fill(cplx_t{});
+            low.m_StateVector[0] = cplx_t::fromReal(1.0);
+            high.m_StateVector[0] = cplx_t::fromReal(1.0);
+
+            for (const CutGate<MaxGateQBitCount>& Gate : m_gates)
+            {
+                const dimension_t Term = path % Gate.TermCount;
+                path /= Gate.TermCount;
+                Gate.LowTerms[Term].applyInPlace(low);
+                Gate.HighTerms[Term].applyInPlace(high);
+            }
+        }
+
+        /**
+         * @brief     Compute selected amplitudes ⟨x|C|0⟩, summed over a range of paths.
+         *
+         * @param basisIndices  The basis states x.
+         * @param firstPath     First path of the range.
+         * @param lastPath      One past the last path of the range (clamped to the path count).
+         * @param memoryBudget  Bound, in bytes, on the working memory of the threads.
+         * @return              The partial amplitudes; summing the results of disjoint ranges
+         *                      covering all paths gives the exact amplitudes.
+         *
+         * The range is split into contiguous sub-ranges, one per worker (serially in constant
+         * evaluation); the partial sums are added in sub-range order, so the result does not
+         * depend on thread scheduling. Every worker holds a pair of half states and Count
+         * partial amplitudes on the heap, so the peak memory is
+         *   workers × ((2^cut + 2^(n - cut) + Count) × sizeof(cplx_t)),
+         * with workers = min(hardware threads, paths, memoryBudget / that pair), and at least
+         * one worker whatever the budget.
+         */
+        template<dimension_t Count>
+        constexpr std::array<cplx_t, Count> getAmplitudes(const std::array<dimension_t, Count>& basisIndices,
+            dimension_t firstPath = 0, dimension_t lastPath = ~dimension_t{ 0 },
+            dimension_t memoryBudget = SchrodingerFeynmanMemoryBudget) const
+        {
+            lastPath = lastPath < m_pathCount ? lastPath : m_pathCount;
+            firstPath = firstPath < lastPath ? firstPath : lastPath;
+            const dimension_t PathCount = lastPath - firstPath;
+
+            dimension_t WorkerCount = 1;
+            if !consteval
+            {
+                constexpr dimension_t WorkerBytes = sizeof(low_state_t) + sizeof(high_state_t) + sizeof(std::array<cplx_t, Count>);
+                const dimension_t MaxWorkerCount = std::min(PathCount, memoryBudget / WorkerBytes);
+                WorkerCount = std::clamp<dimension_t>(std::thread::hardware_concurrency(), 1, std::max<dimension_t>(MaxWorkerCount, 1));
+            }
+
+            // Contiguous sub-ranges; the first PathCount % WorkerCount workers take one more path
+            const auto firstPathOf = [&](dimension_t worker)
+                {
+                    return firstPath + PathCount / WorkerCount * worker + std::min(worker, PathCount % WorkerCount);
+                };
+
+            std::vector<low_state_t> Lows(WorkerCount);
+            std::vector<high_state_t> Highs(WorkerCount);
+            std::vector<std::array<cplx_t, Count>> Partials(WorkerCount);
+            const auto work = [&](dimension_t worker)
+                {
+                    for (dimension_t Path = firstPathOf(worker); Path < firstPathOf(worker + 1); ++Path)
+                    {
+                        evolvePath(Path, Lows[worker], Highs[worker]);
+                        for (dimension_t i = 0; i < Count; ++i)
+                        {
+                            Partials[worker][i] += Highs[worker].m_StateVector[basisIndices[i] >> CutQBitCount]
+                                * Lows[worker].m_StateVector[basisIndices[i] & (LowStateCount - 1)];
+                        }
+                    }
+                };
+
+            if (WorkerCount == 1)
+            {
+                work(0);
+            }
+            else
+            {
+                std::vector<std::jthread> Workers{};
+                Workers.reserve(WorkerCount - 1);
+                for (dimension_t w = 1; w < WorkerCount; ++w)
+                    Workers.emplace_back(work, w);
+                work(0);
+            }
+
+            std::array<cplx_t, Count> Amplitudes{};
+            for (const std::array<cplx_t, Count>& Partial : Partials)
+                for (dimension_t i = 0; i < Count; ++i)
+                    Amplitudes[i] += Partial[i];
+            return Amplitudes;
+        }
+
+        /// @brief Compute one amplitude ⟨x|C|0⟩ over all paths.
+        constexpr cplx_t getAmplitude(dimension_t basisIndex) const
+        {
+            return getAmplitudes(std::array<dimension_t, 1>{ basisIndex })[0];
+        }
+
+        /**
+         * @brief     Draw measurement outcomes of all qubits in the computational basis.
+         *
+         * @tparam SampleCount  Number of outcomes to draw.
+         * @param seed          Seed of the deterministic SplitMix64 generator.
+         * @return              The sampled basis indices.
+         *
+         * Exact two-stage sampling: the high half is drawn from its marginal
+         *   P(x_high) = Σ_pq conj(h_p(x_high)) h_q(x_high) ⟨l_p|l_q⟩,
+         * then the low half from the conditional state Σ_p h_p(x_high) l_p. Keeps the half
+         * states of all paths, i.e. getPathCount() × (2^cut + 2^(n - cut)) amplitudes.
+         */
+        template<dimension_t SampleCount>
+        std::array<index_t, SampleCount> sample(std::uint64_t seed = 0) const
+        {
+            std::vector<low_state_t> Lows(m_pathCount);
+            std::vector<high_state_t> Highs(m_pathCount);
+            for (dimension_t Path = 0; Path < m_pathCount; ++Path)
+                evolvePath(Path, Lows[Path], Highs[Path]);
+
+            // Gram matrix of the low states
+            std::vector<cplx_t> Gram(m_pathCount * m_pathCount);
+            for (dimension_t p = 0; p < m_pathCount; ++p)
+                for (dimension_t q = p; q < m_pathCount; ++q)
+                {
+                    cplx_t Sum{};
+                    for (dimension_t i = 0; i < LowStateCount; ++i)
+                        Sum += Lows[p].m_StateVector[i].conj() * Lows[q].m_StateVector[i];
+                    Gram[p * m_pathCount + q] = Sum;
+                    Gram[q * m_pathCount + p] = Sum.conj();
+                }
+
+            std::vector<float_t> HighCumulative(HighStateCount);
+            for (dimension_t x = 0; x < HighStateCount; ++x)
+            {
+                float_t Probability = 0.0;
+                for (dimension_t p = 0; p < m_pathCount; ++p)
+                    for (dimension_t q = 0; q < m_pathCount; ++q)
+                        Probability += (Highs[p].m_StateVector[x].conj() * Highs[q].m_StateVector[x] * Gram[p * m_pathCount + q]).re;
+                HighCumulative[x] = (x > 0 ? HighCumulative[x - 1] : 0.0) + Probability;
+            }
+
+            const auto draw = [](const std::vector<float_t>& cumulative, float_t u)
+                {
+                    dimension_t Low = 0;
+                    dimension_t High = cumulative.size() - 1;
+                    const float_t Target = u * cumulative.back();
+                    while (Low < High)
+                    {
+                        const dimension_t Mid = (Low + High) / 2;
+                        if (cumulative[Mid] > Target)
+                            High = Mid;
+                        else
+                            Low = Mid + 1;
+                    }
+                    return Low;
+                };
+
+            std::array<index_t, SampleCount> Samples{};
+            std::uint64_t RandomState = seed;
+            std::vector<float_t> LowCumulative(LowStateCount);
+            for (index_t& Sample : Samples)
+            {
+                const dimension_t XHigh = draw(HighCumulative, Detail::uniformFromBits(Detail::splitMix64(RandomState)));
+
+                for (dimension_t x = 0; x < LowStateCount; ++x)
+                {
+                    cplx_t Amplitude{};
+                    for (dimension_t p = 0; p < m_pathCount; ++p)
+                        Amplitude += Highs[p].m_StateVector[XHigh] * Lows[p].m_StateVector[x];
+                    LowCumulative[x] = (x > 0 ? LowCumulative[x - 1] : 0.0) + Amplitude.normSquared();
+                }
+                const dimension_t XLow = draw(LowCumulative, Detail::uniformFromBits(Detail::splitMix64(RandomState)));
+
+                Sample = (XHigh << CutQBitCount) | XLow;
+            }
+            return Samples;
+        }
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+
+#include "solvers/tensor_network.h"
+
+namespace KetCat::QCC
+{
+    /// @file
+    /// @brief Executor computing single amplitudes ⟨x|C|0⟩ by tensor-network contraction.
+
+    /// @brief Forward declaration of QuantumCircuit for friend declaration.
+    template<index_t QBitCount>
+    class QuantumCircuit;
+
+    /// @brief Tensor-network executor: records the gates and contracts one network per queried amplitude.
+    /// @tparam QBitCount         Number of qubits in the circuit.
+    /// @tparam MaxGateQBitCount  Width of the widest recorded gate.
+    /// @tparam GateCount         Number of recorded gates.
+    ///
+    /// Memory is bounded by the largest intermediate tensor, 2^maxRank amplitudes, instead
+    /// of the 2^QBitCount of the state vector; see solvers/tensor_network.h.
+    template<dimension_t QBitCount, dimension_t MaxGateQBitCount, dimension_t GateCount>
+    class TensorNetworkExecutor
+    {
+    public:
+        using record_t = CircuitRecord<MaxGateQBitCount, GateCount>;
+
+    private:
+        /// @brief The recorded circuit (on the heap: every record is as wide as the widest gate).
+        std::vector<record_t> m_record = std::vector<record_t>(1);
+
+        /// @brief Record the gates without executing them.
+        template<RecordableGate... Gates>
+        constexpr explicit TensorNetworkExecutor(const Gates& ... gates)
+        {
+            m_record[0].append(gates...);
+        }
+
+        friend class QuantumCircuit<QBitCount>;
+
+    public:
+        /// @brief Get the network of ⟨x|C|0⟩.
+        constexpr TensorNetwork getTensorNetwork(dimension_t basisIndex) const
+        {
+            return buildTensorNetwork<QBitCount>(m_record[0], basisIndex);
+        }
+
+        /// @brief Get the contraction plan used for every amplitude (order, sliced edges, largest intermediate).
+        /// @param maxRank  Bound on the number of legs of any intermediate tensor.
+        constexpr ContractionPlan getContractionPlan(dimension_t maxRank = TensorNetworkMaxRank) const
+        {
+            return planContraction(getTensorNetwork(0), maxRank);
+        }
+
+        /// @brief Compute the amplitudes ⟨x|C|0⟩ of selected basis states, sharing one contraction plan.
+        /// @param basisIndices  The basis states x.
+        /// @param maxRank       Bound on the number of legs of any intermediate tensor.
+        template<dimension_t Count>
+        constexpr std::array<cplx_t, Count> getAmplitudes(const std::array<dimension_t, Count>& basisIndices,
+            dimension_t maxRank = TensorNetworkMaxRank) const
+        {
+            const ContractionPlan Plan = getContractionPlan(maxRank);
+
+            std::array<cplx_t, Count> Amplitudes{};
+            for (dimension_t i = 0; i < Count; ++i)
+                Amplitudes[i] = contractNetwork(getTensorNetwork(basisIndices[i]), Plan);
+            return Amplitudes;
+        }
+
+        /// @brief Compute one amplitude ⟨x|C|0⟩.
+        constexpr cplx_t getAmplitude(dimension_t basisIndex, dimension_t maxRank = TensorNetworkMaxRank) const
+        {
+            return getAmplitudes(std::array<dimension_t, 1>{ basisIndex }, maxRank)[0];
+        }
+    };
+}
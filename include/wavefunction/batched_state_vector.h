@@ -0,0 +1,71 @@
+#pragma once
+#include "core_types.h"
+#include "state_vector.h"
+
+namespace KetCat
+{
+	/// @brief A batch of state vectors of the same Hilbert space stored in batch-interleaved layout.
+	/// @tparam HilbertDim  Dimension of the Hilbert space (number of basis states).
+	/// @tparam BatchSize   Number of state vectors in the batch.
+	///
+	/// @details
+	/// The amplitudes are stored as [index][batch]: the BatchSize amplitudes belonging to the
+	/// same basis state are contiguous. A gate kernel therefore loads a matrix element once and
+	/// applies it to BatchSize neighbouring amplitudes, which the compiler can vectorize.
+	template<dimension_t HilbertDim, dimension_t BatchSize>
+	struct BatchedStateVector
+	{
+		/// Underlying amplitudes, one row of BatchSize amplitudes per basis state
+		std::array<state_vector_t<BatchSize>, HilbertDim> m_Amplitudes;
+
+	public:
+		/// @brief Indexing operator
+		/// @return Reference to the row of amplitudes of the given basis state across the batch
+		constexpr state_vector_t<BatchSize>& operator[](dimension_t index) noexcept
+		{
+			return m_Amplitudes[index];
+		}
+
+		/// @brief Indexing operator (const)
+		/// @return Const reference to the row of amplitudes of the given basis state across the batch
+		constexpr const state_vector_t<BatchSize>& operator[](dimension_t index) const noexcept
+		{
+			return m_Amplitudes[index];
+		}
+
+		/// @brief Extract one member of the batch as an ordinary state vector.
+		/// @param batch  Position in the batch (0 ≤ batch < BatchSize).
+		constexpr StateVector<HilbertDim> getStateVector(dimension_t batch) const noexcept
+		{
+			StateVector<HilbertDim> Result{};
+			for (dimension_t i = 0; i < HilbertDim; ++i)
+			{
+				Result.m_StateVector[i] = m_Amplitudes[i][batch];
+			}
+			return Result;
+		}
+
+		/// @brief Overwrite one member of the batch with an ordinary state vector.
+		/// @param batch  Position in the batch (0 ≤ batch < BatchSize).
+		/// @param state  The state vector to store.
+		constexpr void setStateVector(dimension_t batch, const StateVector<HilbertDim>& state) noexcept
+		{
+			for (dimension_t i = 0; i < HilbertDim; ++i)
+			{
+				m_Amplitudes[i][batch] = state.m_StateVector[i];
+			}
+		}
+
+		/// @brief Get the probabilities of measuring the basis states for one member of the batch.
+		/// @param batch  Position in the batch (0 ≤ batch < BatchSize).
+		constexpr probability_vector_t<HilbertDim> getProbabilities(dimension_t batch) const noexcept
+		{
+			probability_vector_t<HilbertDim> Probabilities{};
+			for (dimension_t i = 0; i < HilbertDim; ++i)
+			{
+				Probabilities[i] = m_Amplitudes[i][batch].normSquared();
+			}
+			return Probabilities;
+		}
+	};
+}
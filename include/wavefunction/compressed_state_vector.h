@@ -0,0 +1,316 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <vector>
+
+#include "core_types.h"
+#include "state_vector.h"
+
+namespace KetCat
+{
+	/// @file
+	/// @brief Lossy, block-compressed amplitude storage for memory-bound simulations.
+	///
+	/**
+	 * @details
+	 * A double-precision amplitude takes 16 bytes. The formats below store one in about 4
+	 * bytes, so a register four times larger (two more qubits) fits the same memory, at the
+	 * price of a bounded rounding error every time amplitudes are written back:
+	 *  - `SharedExponentFormat`: blocks of `BlockSize` amplitudes share one power-of-two
+	 *    exponent, every component keeps a 16-bit signed mantissa. The error is at most
+	 *    2^-15 of the largest component of the block, which suits the smooth, similar-sized
+	 *    amplitudes of most circuits.
+	 *  - `BFloat16Format`: every component is a bfloat16 (8-bit exponent, 8-bit mantissa),
+	 *    i.e. a relative error of 2^-9 per component but no dynamic-range coupling inside a
+	 *    block.
+	 *
+	 * `CompressedStateVector` never holds the whole state uncompressed: amplitudes are
+	 * decoded one chunk at a time into a small ordinary state vector, worked on there and
+	 * encoded back (see compressed_gate_solver.h). Every encode measures what it lost, so the
+	 * state reports a bound on its accumulated error and the norm it currently holds; drift of
+	 * that norm away from 1 is removed by `renormalize()`.
+	 *
+	 * The blocks live on the heap (66 bytes per 16 amplitudes in the shared-exponent format,
+	 * about 4.1 GiB at n = 30), so a compressed state can be used inside constant evaluation
+	 * but not stored in a constexpr variable. `toStateVector` and `getProbabilities` return full-size arrays and are meant
+	 * for small registers; `amplitude` decodes a single block.
+	 */
+
+	/// @brief Block floating-point format: one shared exponent and 16-bit mantissas per block.
+	struct SharedExponentFormat
+	{
+		/// Number of complex amplitudes sharing one exponent.
+		static constexpr dimension_t BlockSize = 16;
+
+		/// Number of mantissa bits below the sign.
+		static constexpr int MantissaBits = 15;
+
+		/// Smallest shared exponent: keeps the decode step 2^(Exponent - MantissaBits) a normal double.
+		static constexpr int MinExponent = -1022 + MantissaBits;
+
+		struct Block
+		{
+			std::array<std::int16_t, 2 * BlockSize> Mantissas{};
+			std::int16_t Exponent = 0;
+		};
+
+		/// @brief 2^exponent for exponents in the normal double range [-1022, 1023].
+		static constexpr float_t powerOfTwo(int exponent) noexcept
+		{
+			return std::bit_cast<float_t>(static_cast<std::uint64_t>(exponent + 1023) << 52);
+		}
+
+		/// @brief Encode BlockSize amplitudes.
+		static constexpr void encode(const cplx_t* amplitudes, Block& block) noexcept
+		{
+			float_t MaxAbs = 0.0;
+			for (dimension_t i = 0; i < BlockSize; ++i)
+			{
+				MaxAbs = ConstexprMath::abs(amplitudes[i].re) > MaxAbs ? ConstexprMath::abs(amplitudes[i].re) : MaxAbs;
+				MaxAbs = ConstexprMath::abs(amplitudes[i].im) > MaxAbs ? ConstexprMath::abs(amplitudes[i].im) : MaxAbs;
+			}
+
+			// Smallest E with MaxAbs < 2^E, read from the double's exponent field (subnormals flush to zero)
+			const int BiasedExponent = static_cast<int>((std::bit_cast<std::uint64_t>(MaxAbs) >> 52) & 0x7FF);
+			if (BiasedExponent == 0)
+			{
+				block = Block{};
+				return;
+			}
+			// Blocks below 2^MinExponent share the smallest exponent; their mantissas just get smaller
+			block.Exponent = static_cast<std::int16_t>(BiasedExponent - 1022 > MinExponent ? BiasedExponent - 1022 : MinExponent);
+
+			const float_t Scale = powerOfTwo(MantissaBits - block.Exponent);
+			constexpr float_t MaxMantissa = (1 << MantissaBits) - 1;
+			const auto quantise = [&](float_t x)
+				{
+					float_t Scaled = x * Scale;
+					Scaled = Scaled >= 0.0 ? Scaled + 0.5 : Scaled - 0.5;
+					Scaled = Scaled > MaxMantissa ? MaxMantissa : (Scaled < -MaxMantissa ? -MaxMantissa : Scaled);
+					return static_cast<std::int16_t>(Scaled);
+				};
+			for (dimension_t i = 0; i < BlockSize; ++i)
+			{
+				block.Mantissas[2 * i] = quantise(amplitudes[i].re);
+				block.Mantissas[2 * i + 1] = quantise(amplitudes[i].im);
+			}
+		}
+
+		/// @brief Decode BlockSize amplitudes.
+		static constexpr void decode(const Block& block, cplx_t* amplitudes) noexcept
+		{
+			const float_t Step = powerOfTwo(block.Exponent - MantissaBits);
+			for (dimension_t i = 0; i < BlockSize; ++i)
+			{
+				amplitudes[i] = cplx_t(block.Mantissas[2 * i] * Step, block.Mantissas[2 * i + 1] * Step);
+			}
+		}
+	};
+
+	/// @brief bfloat16 format: the upper half of an IEEE single per component.
+	struct BFloat16Format
+	{
+		/// Number of complex amplitudes per block (blocks only set the coding granularity).
+		static constexpr dimension_t BlockSize = 16;
+
+		struct Block
+		{
+			std::array<std::uint16_t, 2 * BlockSize> Components{};
+		};
+
+		/// @brief Round a double to bfloat16, to nearest even.
+		static constexpr std::uint16_t toBFloat16(float_t x) noexcept
+		{
+			std::uint32_t Bits = std::bit_cast<std::uint32_t>(static_cast<float>(x));
+			Bits += 0x7FFF + ((Bits >> 16) & 1);
+			return static_cast<std::uint16_t>(Bits >> 16);
+		}
+
+		/// @brief Widen a bfloat16 to double.
+		static constexpr float_t fromBFloat16(std::uint16_t x) noexcept
+		{
+			return std::bit_cast<float>(static_cast<std::uint32_t>(x) << 16);
+		}
+
+		/// @brief Encode BlockSize amplitudes.
+		static constexpr void encode(const cplx_t* amplitudes, Block& block) noexcept
+		{
+			for (dimension_t i = 0; i < BlockSize; ++i)
+			{
+				block.Components[2 * i] = toBFloat16(amplitudes[i].re);
+				block.Components[2 * i + 1] = toBFloat16(amplitudes[i].im);
+			}
+		}
+
+		/// @brief Decode BlockSize amplitudes.
+		static constexpr void decode(const Block& block, cplx_t* amplitudes) noexcept
+		{
+			for (dimension_t i = 0; i < BlockSize; ++i)
+			{
+				amplitudes[i] = cplx_t(fromBFloat16(block.Components[2 * i]), fromBFloat16(block.Components[2 * i + 1]));
+			}
+		}
+	};
+
+	/// @brief Concept for compressed amplitude formats.
+	template<typename Format>
+	concept AmplitudeFormat =
+		requires(const cplx_t* in, cplx_t* out, typename Format::Block& block)
+	{
+		{ Format::BlockSize } -> std::convertible_to<dimension_t>;
+		Format::encode(in, block);
+		Format::decode(block, out);
+	};
+
+	/// @brief State vector whose amplitudes are stored block-compressed.
+	/// @tparam HilbertDim  Dimension of the Hilbert space (a multiple of the block size).
+	/// @tparam Format      The amplitude format, e.g. `SharedExponentFormat`.
+	template<dimension_t HilbertDim, AmplitudeFormat Format = SharedExponentFormat>
+		requires (HilbertDim % Format::BlockSize == 0)
+	struct CompressedStateVector
+	{
+		/// @brief Number of amplitudes encoded together.
+		static constexpr dimension_t BlockSize = Format::BlockSize;
+
+		/// @brief Number of blocks.
+		static constexpr dimension_t BlockCount = HilbertDim / BlockSize;
+
+		/// Underlying compressed blocks, on the heap
+		std::vector<typename Format::Block> m_Blocks = std::vector<typename Format::Block>(BlockCount);
+
+		/// Squared norm of the stored (decoded) state, as measured by the last full pass.
+		float_t m_NormSquared = 0.0;
+
+		/// Bound on ‖stored - exact‖ accumulated over all encodes (triangle inequality).
+		float_t m_AccumulatedError = 0.0;
+
+	public:
+		/// @brief Compress an ordinary state vector.
+		static constexpr CompressedStateVector fromStateVector(const StateVector<HilbertDim>& state)
+		{
+			CompressedStateVector Compressed{};
+			float_t NormSquared = 0.0, ErrorSquared = 0.0;
+			Compressed.encode(0, HilbertDim, state.m_StateVector.data(), NormSquared, ErrorSquared);
+			Compressed.recordPass(NormSquared, ErrorSquared);
+			return Compressed;
+		}
+
+		/// @brief The computational basis state |index>, stored exactly.
+		static constexpr CompressedStateVector basisState(dimension_t index)
+		{
+			std::array<cplx_t, BlockSize> Block{};
+			Block[index % BlockSize] = cplx_t::fromReal(1.0);
+
+			CompressedStateVector Compressed{};
+			float_t NormSquared = 0.0, ErrorSquared = 0.0;
+			Compressed.encode(index - index % BlockSize, BlockSize, Block.data(), NormSquared, ErrorSquared);
+			Compressed.recordPass(NormSquared, ErrorSquared);
+			return Compressed;
+		}
+
+		/// @brief Decode count amplitudes starting at first (both multiples of the block size).
+		constexpr void decode(dimension_t first, dimension_t count, cplx_t* amplitudes) const noexcept
+		{
+			for (dimension_t b = 0; b < count / BlockSize; ++b)
+			{
+				Format::decode(m_Blocks[first / BlockSize + b], amplitudes + b * BlockSize);
+			}
+		}
+
+		/**
+		 * @brief     Encode count amplitudes starting at first (both multiples of the block size).
+		 *
+		 * @param normSquared   Incremented by the squared norm of the stored amplitudes.
+		 * @param errorSquared  Incremented by the squared distance between stored and given amplitudes.
+		 */
+		constexpr void encode(dimension_t first, dimension_t count, const cplx_t* amplitudes,
+			float_t& normSquared, float_t& errorSquared) noexcept
+		{
+			for (dimension_t b = 0; b < count / BlockSize; ++b)
+			{
+				typename Format::Block& Block = m_Blocks[first / BlockSize + b];
+				const cplx_t* Exact = amplitudes + b * BlockSize;
+				Format::encode(Exact, Block);
+
+				std::array<cplx_t, BlockSize> Stored{};
+				Format::decode(Block, Stored.data());
+				for (dimension_t i = 0; i < BlockSize; ++i)
+				{
+					normSquared += Stored[i].normSquared();
+					errorSquared += (Stored[i] - Exact[i]).normSquared();
+				}
+			}
+		}
+
+		/// @brief Close a pass that re-encoded the whole state: update the norm and the error bound.
+		constexpr void recordPass(float_t normSquared, float_t errorSquared) noexcept
+		{
+			m_NormSquared = normSquared;
+			m_AccumulatedError += ConstexprMath::sqrt(errorSquared);
+		}
+
+		/// @brief Squared norm of the stored state; drifts from 1 by rounding.
+		constexpr float_t getNormSquared() const noexcept
+		{
+			return m_NormSquared;
+		}
+
+		/// @brief Upper bound on the distance ‖stored - exact‖ caused by compression so far.
+		constexpr float_t getAccumulatedError() const noexcept
+		{
+			return m_AccumulatedError;
+		}
+
+		/// @brief Rescale the stored state to unit norm.
+		template<dimension_t ChunkSize = (HilbertDim < 1024 ? HilbertDim : 1024)>
+		constexpr void renormalize() noexcept
+		{
+			if (m_NormSquared == 0.0)
+				return;
+
+			const float_t Factor = 1.0 / ConstexprMath::sqrt(m_NormSquared);
+			float_t NormSquared = 0.0, ErrorSquared = 0.0;
+			std::array<cplx_t, ChunkSize> Chunk{};
+			for (dimension_t First = 0; First < HilbertDim; First += ChunkSize)
+			{
+				decode(First, ChunkSize, Chunk.data());
+				for (cplx_t& Amplitude : Chunk)
+					Amplitude = Amplitude * Factor;
+				encode(First, ChunkSize, Chunk.data(), NormSquared, ErrorSquared);
+			}
+			recordPass(NormSquared, ErrorSquared);
+		}
+
+		/// @brief Decode the amplitude of one basis state.
+		constexpr cplx_t amplitude(dimension_t basisIndex) const noexcept
+		{
+			std::array<cplx_t, BlockSize> Block{};
+			decode(basisIndex - basisIndex % BlockSize, BlockSize, Block.data());
+			return Block[basisIndex % BlockSize];
+		}
+
+		/// @brief Decompress the whole state into an ordinary state vector (small registers only).
+		constexpr StateVector<HilbertDim> toStateVector() const noexcept
+		{
+			StateVector<HilbertDim> State{};
+			decode(0, HilbertDim, State.m_StateVector.data());
+			return State;
+		}
+
+		/// @brief Get the probabilities of measuring the basis states, streamed block by block (small registers only).
+		constexpr probability_vector_t<HilbertDim> getProbabilities() const noexcept
+		{
+			probability_vector_t<HilbertDim> Probabilities{};
+			std::array<cplx_t, BlockSize> Block{};
+			for (dimension_t b = 0; b < BlockCount; ++b)
+			{
+				decode(b * BlockSize, BlockSize, Block.data());
+				for (dimension_t i = 0; i < BlockSize; ++i)
+					Probabilities[b * BlockSize + i] = Block[i].normSquared();
+			}
+			return Probabilities;
+		}
+	};
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "core_types.h"
+#include "state_vector.h"
+
+namespace KetCat
+{
+	/// @file
+	/// @brief State vectors restricted to a fixed Hamming weight (particle number).
+	///
+	/**
+	 * @details
+	 * Circuits made only of gates that preserve the number of |1⟩ qubits (fermionic
+	 * swaps, Givens rotations, phases, ...) never leave the C(n, k)-dimensional subspace of
+	 * basis states with k bits set. `HammingWeightStateVector` stores just that subspace,
+	 * e.g. 142 506 amplitudes instead of 2^30 for n = 30, k = 5.
+	 *
+	 * Basis states are indexed by the combinatorial number system: the state whose set bits
+	 * are c_1 < c_2 < ... < c_k has rank Σ_i C(c_i, i). Ranks follow the numeric order of the
+	 * basis indices, so rank 0 is the state with the k lowest qubits set.
+	 *
+	 * Basis indices and ranks are checked before they index the tables: an index outside the
+	 * register or the subspace, or a rank past the subspace, throws std::invalid_argument
+	 * (a compile error in constant evaluation).
+	 *
+	 * The amplitudes live on the heap, as the blocks of `CompressedStateVector` do: the
+	 * subspace is still large (C(30, 6) = 593 775 amplitudes, about 9.5 MB), so a subspace
+	 * state can be used inside constant evaluation but not stored in a constexpr variable.
+	 */
+
+	/// @brief Binomial coefficient C(n, k).
+	constexpr dimension_t binomial(dimension_t n, dimension_t k) noexcept
+	{
+		if (k > n)
+			return 0;
+
+		dimension_t Result = 1;
+		for (dimension_t i = 1; i <= k; ++i)
+			Result = Result * (n - k + i) / i;
+		return Result;
+	}
+
+	/// @brief State vector over the basis states of QBitCount qubits with exactly Weight bits set.
+	/// @tparam QBitCount  Number of qubits.
+	/// @tparam Weight     Number of |1⟩ qubits (particles).
+	template<dimension_t QBitCount, dimension_t Weight>
+		requires (Weight <= QBitCount)
+	struct HammingWeightStateVector
+	{
+		/// @brief Number of basis states of the subspace.
+		static constexpr dimension_t SubspaceDim = binomial(QBitCount, Weight);
+
+		/// Underlying amplitudes, indexed by rank (SubspaceDim of them, on the heap)
+		std::vector<cplx_t> m_Amplitudes = std::vector<cplx_t>(SubspaceDim);
+
+	public:
+		/// @brief True if the basis index lies in the register and has Weight bits set.
+		static constexpr bool isInSubspace(dimension_t basisIndex) noexcept
+		{
+			return isInRegister(basisIndex) && static_cast<dimension_t>(std::popcount(basisIndex)) == Weight;
+		}
+
+		/// @brief Rank of a basis index of the given weight in the subspace.
+		/// @throws std::invalid_argument if the index is not in the subspace.
+		static constexpr dimension_t rankOf(dimension_t basisIndex)
+		{
+			if (!isInSubspace(basisIndex))
+				throw std::invalid_argument("basis index is not in the Hamming-weight subspace");
+
+			dimension_t Rank = 0;
+			for (dimension_t i = 1; basisIndex != 0; ++i)
+			{
+				const dimension_t Bit = static_cast<dimension_t>(std::countr_zero(basisIndex));
+				Rank += BinomialTable[Bit][i];
+				basisIndex &= basisIndex - 1;
+			}
+			return Rank;
+		}
+
+		/// @brief Basis index of the subspace state with the given rank.
+		/// @throws std::invalid_argument if the rank is not below SubspaceDim.
+		static constexpr dimension_t basisIndexOf(dimension_t rank)
+		{
+			if (rank >= SubspaceDim)
+				throw std::invalid_argument("rank is past the Hamming-weight subspace");
+
+			// Greedily pick the highest bit c_i with C(c_i, i) <= rank, from i = Weight down
+			dimension_t BasisIndex = 0;
+			dimension_t Bit = QBitCount;
+			for (dimension_t i = Weight; i > 0; --i)
+			{
+				do
+					--Bit;
+				while (BinomialTable[Bit][i] > rank);
+
+				BasisIndex |= dimension_t(1) << Bit;
+				rank -= BinomialTable[Bit][i];
+			}
+			return BasisIndex;
+		}
+
+		/// @brief The basis state |basisIndex>.
+		/// @throws std::invalid_argument if the index is not in the subspace.
+		static constexpr HammingWeightStateVector basisState(dimension_t basisIndex)
+		{
+			HammingWeightStateVector State{};
+			State.m_Amplitudes[rankOf(basisIndex)] = cplx_t::fromReal(1.0);
+			return State;
+		}
+
+		/// @brief Amplitude of a basis state; zero for other weights.
+		/// @throws std::invalid_argument if the index is outside the register.
+		constexpr cplx_t amplitude(dimension_t basisIndex) const
+		{
+			if (!isInRegister(basisIndex))
+				throw std::invalid_argument("basis index is outside the register");
+			if (static_cast<dimension_t>(std::popcount(basisIndex)) != Weight)
+				return cplx_t::zero();
+			return m_Amplitudes[rankOf(basisIndex)];
+		}
+
+		/// @brief Get the probabilities of the subspace basis states, indexed by rank.
+		constexpr std::vector<float_t> getProbabilities() const
+		{
+			std::vector<float_t> Probabilities(SubspaceDim);
+			for (dimension_t r = 0; r < SubspaceDim; ++r)
+				Probabilities[r] = m_Amplitudes[r].normSquared();
+			return Probabilities;
+		}
+
+		/// @brief Embed the state into the full 2^QBitCount-dimensional state vector (small registers only).
+		constexpr StateVector<ConstexprMath::pow2(QBitCount)> toStateVector() const
+		{
+			StateVector<ConstexprMath::pow2(QBitCount)> State{};
+			for (dimension_t r = 0; r < SubspaceDim; ++r)
+				State.m_StateVector[basisIndexOf(r)] = m_Amplitudes[r];
+			return State;
+		}
+
+	private:
+		/// @brief True if the basis index is below 2^QBitCount.
+		static constexpr bool isInRegister(dimension_t basisIndex) noexcept
+		{
+			return QBitCount >= std::numeric_limits<dimension_t>::digits || (basisIndex >> QBitCount) == 0;
+		}
+
+		/// @brief C(n, i) for n <= QBitCount and i <= Weight.
+		static constexpr std::array<std::array<dimension_t, Weight + 1>, QBitCount + 1> BinomialTable = []
+			{
+				std::array<std::array<dimension_t, Weight + 1>, QBitCount + 1> Table{};
+				for (dimension_t n = 0; n <= QBitCount; ++n)
+					for (dimension_t i = 0; i <= Weight; ++i)
+						Table[n][i] = binomial(n, i);
+				return Table;
+			}();
+	};
+}
@@ -5,27 +5,44 @@ namespace KetCat
 {
 	/// @brief Represents a quantum state vector in a Hilbert space of given dimension.
 	/// @tparam HilbertDim  Dimension of the Hilbert space (number of basis states).
-	template <dimension_t HilbertDim>
+	/// @tparam Real        Precision of the stored amplitudes (`float` halves the memory footprint).
+	///
+	/// @details
+	/// Sums over the amplitudes (norms, probabilities) are formed in `accumulator_t<Real>`,
+	/// i.e. at least in double precision, so single-precision states do not lose their
+	/// normalisation to rounding in the accumulator.
+	template <dimension_t HilbertDim, precision_type Real = float_t>
 	struct StateVector
 	{
+		/// Complex type of the amplitudes
+		using complex_type = complex_t<Real>;
+
 		/// Underlying state vector array
-		state_vector_t<HilbertDim> m_StateVector;
+		state_vector_t<HilbertDim, Real> m_StateVector;
 
 	public:
 		/// @brief Indexing operator
 		/// @return Reference to a complex number at the given state index
-		constexpr cplx_t& operator[](dimension_t index) noexcept
+		constexpr complex_type& operator[](dimension_t index) noexcept
 		{
 			return m_StateVector.at(index);
 		}
 
 		/// @brief Indexing operator (const)
 		/// @return Const reference to a complex number at the given state index
-		constexpr const cplx_t& operator[](dimension_t index) const noexcept
+		constexpr const complex_type& operator[](dimension_t index) const noexcept
 		{
 			return m_StateVector.at(index);
 		}
 
+		/// @brief |ψᵢ|² of one amplitude, computed in the accumulator precision.
+		static constexpr accumulator_t<Real> amplitudeNormSquared(const complex_type& c) noexcept
+		{
+			const accumulator_t<Real> Re = c.re;
+			const accumulator_t<Real> Im = c.im;
+			return Re * Re + Im * Im;
+		}
+
 		/// @brief Get the probabilities of measuring the selected basis states.
 		constexpr probability_vector_t<HilbertDim> getProbabilities() const noexcept
 		{
@@ -33,7 +50,7 @@ namespace KetCat
 
 			for (int i = 0; i < HilbertDim; ++i)
 			{
-				Probabilities[i] = m_StateVector[i].normSquared();
+				Probabilities[i] = static_cast<float_t>(amplitudeNormSquared(m_StateVector[i]));
 			}
 
 			return Probabilities;
@@ -43,15 +60,15 @@ namespace KetCat
 		/// with wavefunction functors to keep |ψ|² = 1).
 		constexpr void normalize() noexcept
 		{
-			float_t normSquared = 0.0;
+			accumulator_t<Real> normSquared = 0.0;
 
-			for (cplx_t& c : m_StateVector)
+			for (complex_type& c : m_StateVector)
 			{
-				normSquared += c.normSquared();
+				normSquared += amplitudeNormSquared(c);
 			}
 
-			const float_t norm = ConstexprMath::sqrt(normSquared);
-			for (cplx_t& c : m_StateVector)
+			const Real norm = static_cast<Real>(ConstexprMath::sqrt(normSquared));
+			for (complex_type& c : m_StateVector)
 			{
 				c = c / norm;
 			}
@@ -81,12 +98,12 @@ namespace KetCat
 		/// 
 		constexpr void normalize_with_dx(double dx) noexcept
 		{
-			double Norm2 = 0.0;
+			accumulator_t<Real> Norm2 = 0.0;
 
 			// Accumulate Σ |ψᵢ|²  
-			for (const cplx_t& c : m_StateVector)
+			for (const complex_type& c : m_StateVector)
 			{
-				Norm2 += c.normSquared();
+				Norm2 += amplitudeNormSquared(c);
 			}
 
 			// Convert into discrete integral: Σ |ψᵢ|² · Δx
@@ -95,10 +112,10 @@ namespace KetCat
 			// Guard against division by zero
 			if (Norm2 > 0.0)
 			{
-				const double Inv = 1.0 / ConstexprMath::sqrt(Norm2);
+				const Real Inv = static_cast<Real>(1.0 / ConstexprMath::sqrt(Norm2));
 
 				// Rescale all amplitudes so that Σ |ψᵢ|² · Δx = 1
-				for (cplx_t& c : m_StateVector)
+				for (complex_type& c : m_StateVector)
 				{
 					c = c * Inv;
 				}
@@ -108,12 +125,12 @@ namespace KetCat
 		/// @brief Multiply this state vector by a matrix.
 		/// @param mat  The matrix to multiply with (HilbertDim x HilbertDim).
 		/// @return The resulting state vector.
-		constexpr StateVector<HilbertDim> matMul(const matrix_t<HilbertDim>& mat) const noexcept
+		constexpr StateVector matMul(const matrix_t<HilbertDim, Real>& mat) const noexcept
 		{
-			StateVector<HilbertDim> Result;
+			StateVector Result;
 			for (dimension_t i = 0; i < HilbertDim; ++i)
 			{
-				cplx_t Sum = cplx_t::zero();
+				complex_type Sum = complex_type::zero();
 				for (dimension_t j = 0; j < HilbertDim; ++j)
 				{
 					Sum = Sum + mat[i][j] * m_StateVector[j];
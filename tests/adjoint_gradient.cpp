@@ -0,0 +1,93 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	constexpr KetCat::dimension_t ParameterCount = 13;
+	using parameters_t = std::array<KetCat::float_t, ParameterCount>;
+
+	// A fixed ansatz on four qubits: every parametric gate kind, with H and CX in between
+	template<typename Visitor>
+	decltype(auto) withAnsatz(const parameters_t& p, const std::array<KetCat::dimension_t, 4>& q, Visitor&& visit)
+	{
+		return visit(
+			QuantumGate<1, Gates::H>().toBits(q[0]),
+			ParametricGate<Gates::RY>(p[0]).toBits(q[1]),
+			ParametricGate<Gates::RX>(p[1]).toBits(q[2]),
+			QuantumGate<2, Gates::CX>().toBits(q[0], q[1]),
+			ParametricGate<Gates::U3>(p[2], p[3], p[4]).toBits(q[3]),
+			ParametricGate<Gates::CPhase>(p[5]).toBits(q[1], q[3]),
+			ParametricGate<Gates::RZ>(p[6]).toBits(q[0]),
+			QuantumGate<2, Gates::CX>().toBits(q[2], q[0]),
+			ParametricGate<Gates::RY>(p[7]).toBits(q[2]),
+			ParametricGate<Gates::U3>(p[8], p[9], p[10]).toBits(q[1]),
+			ParametricGate<Gates::CPhase>(p[11]).toBits(q[0], q[2]),
+			ParametricGate<Gates::RX>(p[12]).toBits(q[3]));
+	}
+
+	// ⟨ψ|Z_a + X_b / 2|ψ⟩ on the naive reference state
+	KetCat::float_t naiveEnergy(const parameters_t& p, const std::array<KetCat::dimension_t, 4>& q)
+	{
+		const auto State = withAnsatz(p, q, [](const auto&... gates) { return Checks::referenceState<16>(0, gates...); });
+
+		KetCat::float_t Energy = 0.0;
+		for (KetCat::dimension_t i = 0; i < 16; ++i)
+		{
+			Energy += ((i >> q[0]) & 1 ? -1.0 : 1.0) * State[i].normSquared();
+			Energy += 0.5 * (State[i].conj() * State[i ^ (KetCat::dimension_t(1) << q[2])]).re;
+		}
+		return Energy;
+	}
+
+	bool checkAdjointGradient()
+	{
+		// Differentiate ⟨Z + X/2⟩ with respect to the 13 angles of a random 4-qubit ansatz with the
+		// adjoint method, and check every component against central finite differences of the
+		// naive reference.
+
+		std::cout << "Adjoint gradient against central finite differences (4 qubits, 13 parameters)\n";
+
+		// Step of the differences: truncation O(h²) and rounding O(ε/h) both stay far below the tolerance
+		constexpr KetCat::float_t Step = 1E-4;
+		constexpr KetCat::float_t Tolerance = 1E-6;
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			const auto Q = Checks::shuffledQBits<4>(Engine);
+			parameters_t Parameters{};
+			for (KetCat::float_t& Angle : Parameters)
+				Angle = Checks::randomAngle(Engine);
+
+			const auto Energy = Observable<1, Gates::Z>().onBits(Q[0]) + Observable<1, Gates::X>().onBits(Q[2]) * 0.5;
+			const auto Result = withAnsatz(Parameters, Q, [&](const auto&... gates)
+				{
+					return QuantumCircuit<4>().adjointGradient(Energy, gates...);
+				});
+
+			KetCat::float_t Deviation = std::abs(Result.ExpectationValue - naiveEnergy(Parameters, Q));
+			for (KetCat::dimension_t k = 0; k < ParameterCount; ++k)
+			{
+				parameters_t Plus = Parameters, Minus = Parameters;
+				Plus[k] += Step;
+				Minus[k] -= Step;
+				const KetCat::float_t Difference = (naiveEnergy(Plus, Q) - naiveEnergy(Minus, Q)) / (2.0 * Step);
+				Deviation = std::max(Deviation, std::abs(Result.Gradient[k] - Difference));
+			}
+
+			const bool SeedPassed = Deviation <= Tolerance;
+			std::cout << "Seed " << Seed << ": <H> = " << std::fixed << std::setprecision(6) << Result.ExpectationValue
+				<< ", largest deviation from the finite differences " << std::scientific << std::setprecision(2) << Deviation
+				<< (SeedPassed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+			Passed &= SeedPassed;
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkAdjointGradient);
+}
@@ -0,0 +1,35 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkCacheBlockedCircuit()
+	{
+		// Run random 6-qubit circuits with the cache-blocked scheduler on tiles of only 2 qubits,
+		// so that most gates have to be regrouped, remapped or swept, and check every final state
+		// against the naive reference.
+
+		std::cout << "Cache-blocked execution on 2-qubit tiles (6 qubits)\n";
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3, 4, 5 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<6, 4>(Engine, [&](const auto&... gates)
+				{
+					KetCat::StateVector<64> Blocked = QBitState<6>()();
+					executeCacheBlocked<2>(Blocked, gates...);
+
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed), Blocked,
+						Checks::referenceState<64>(0, gates...));
+				});
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkCacheBlockedCircuit);
+}
@@ -0,0 +1,77 @@
+#include <utility>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkCircuitStepper()
+	{
+		// Execute two random 4-qubit circuits separated by a barrier step by step, and check the
+		// state at the barrier and at the end against the naive reference of the gates run so far.
+
+		std::cout << "Step-wise execution of a random 4-qubit circuit\n";
+
+		bool Passed = true;
+		Checks::random_engine_t Engine(1);
+		Checks::withRandomCircuit<4, 1>(Engine, [&](const auto&... first)
+			{
+				Checks::withRandomCircuit<4, 1>(Engine, [&](const auto&... second)
+					{
+						const KetCat::StateVector<16> AtBarrier = Checks::referenceState<16>(0, first...);
+						const KetCat::StateVector<16> AtEnd = Checks::referenceState<16>(0, first..., second...);
+
+						for (const auto& Step : QuantumCircuit<4>().withGatesStepwise(StepMode::Barriers,
+							first..., Barrier{ "first half" }, second...))
+						{
+							const std::string Label = Step.Label.empty() ? "end" : std::string(Step.Label);
+							std::cout << "After gate " << Step.GateIndex << " (" << Label << ")\n";
+
+							Passed &= Checks::checkAgainstReference(Label, Step.getStateVector(),
+								Step.GateIndex == sizeof...(first) ? AtBarrier : AtEnd);
+						}
+					});
+			});
+
+		// An empty circuit still reports its end step, on |0...0>
+		KetCat::dimension_t EmptyStepCount = 0;
+		for (const auto& Step : QuantumCircuit<2>().withGatesStepwise(StepMode::Barriers))
+		{
+			++EmptyStepCount;
+			Passed &= Step.GateIndex == 0 && Step.Label.empty();
+			Passed &= Checks::checkAgainstReference("empty circuit", Step.getStateVector(), Checks::referenceState<4>(0));
+		}
+		std::cout << "Empty circuit: " << EmptyStepCount << " step" << (EmptyStepCount == 1 ? " (ok)\n" : "s (FAILED)\n");
+		Passed &= EmptyStepCount == 1;
+
+		// The circuit of wide_gate_circuit.cpp, a 5-qubit IQFT and 400 Hadamards, with a barrier after
+		// the IQFT: its recording holds megabytes of records, which must stay off the stack.
+		std::cout << "\nStep-wise execution of a 5-qubit IQFT and 400 Hadamards (8 qubits)\n";
+
+		constexpr auto IQFT5 = Gates::make_IQFT_matrix<5>();
+		const auto IQFT = QuantumGate<5, IQFT5>().toBits(0, 1, 2, 3, 4);
+		const auto H7 = QuantumGate<1, Gates::H>().toBits(7);
+
+		Passed &= [&]<std::size_t... Index>(std::index_sequence<Index...>)
+		{
+			const KetCat::StateVector<256> AtBarrier = Checks::referenceState<256>(0, IQFT);
+			const KetCat::StateVector<256> AtEnd = Checks::referenceState<256>(0, IQFT, ((void)Index, H7)...);
+
+			bool WidePassed = true;
+			for (const auto& Step : QuantumCircuit<8>().withGatesStepwise(StepMode::Barriers,
+				IQFT, Barrier{ "IQFT" }, ((void)Index, H7)...))
+			{
+				const std::string Label = Step.Label.empty() ? "end" : std::string(Step.Label);
+				WidePassed &= Checks::checkAgainstReference(Label, Step.getStateVector(), Step.GateIndex == 1 ? AtBarrier : AtEnd);
+			}
+			return WidePassed;
+		}(std::make_index_sequence<400>{});
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkCircuitStepper);
+}
@@ -0,0 +1,69 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// SWAP as three alternating CX, and the FFT-based inverse QFT against its dense matrix, at compile time
+	constexpr auto CX01 = QuantumGate<2, Gates::CX>().toBits(0, 1);
+	constexpr auto CX10 = QuantumGate<2, Gates::CX>().toBits(1, 0);
+	static_assert(matricesEqual(QuantumCircuit<2>().unitaryOf(CX01, CX10, CX01), Gates::SWAP));
+	static_assert(matricesEqual(QuantumCircuit<2>().unitaryOf(InverseQFT<2>().toBits(0, 1)), Gates::make_IQFT_matrix<2>()));
+
+	// Check every column j of the unitaries of random circuits ending in inverseFFT against the reference run from |j>
+	template<KetCat::dimension_t QBitCount>
+	bool checkUnitaries(const auto& inverseFFT, const auto& inverseMatrix)
+	{
+		constexpr KetCat::dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<QBitCount, 2>(Engine, [&](const auto&... gates)
+				{
+					const auto U = QuantumCircuit<QBitCount>().unitaryOf(gates..., inverseFFT);
+
+					KetCat::float_t Deviation = 0.0;
+					for (KetCat::dimension_t Column = 0; Column < Dim; ++Column)
+					{
+						KetCat::StateVector<Dim> UColumn{};
+						for (KetCat::dimension_t Row = 0; Row < Dim; ++Row)
+							UColumn[Row] = U[Row][Column];
+
+						Deviation = std::max(Deviation, Checks::largestDeviation(UColumn,
+							Checks::referenceState<Dim>(Column, gates..., inverseMatrix)));
+					}
+
+					const bool SeedPassed = Deviation <= Checks::ReferenceTolerance;
+					std::cout << "Seed " << Seed << ": largest deviation of the " << Dim << " columns from the reference " << std::scientific
+						<< std::setprecision(2) << Deviation << (SeedPassed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+					Passed &= SeedPassed;
+				});
+		}
+		return Passed;
+	}
+
+	bool checkCircuitUnitary()
+	{
+		// Build the unitary of random 5-qubit circuits ending in an FFT-based inverse QFT (two
+		// column panels, batched and column-by-column gates), then of 8-qubit circuits (sixteen
+		// panels, split over threads), and check every column against the naive reference.
+
+		constexpr auto IQFT3 = Gates::make_IQFT_matrix<3>();
+		const auto InverseFFT = InverseQFT<3>().toBits(3, 0, 4);
+		const auto InverseMatrix = QuantumGate<3, IQFT3>().toBits(3, 0, 4);
+
+		std::cout << "Circuit unitaries, column by column (5 qubits)\n";
+		bool Passed = checkUnitaries<5>(InverseFFT, InverseMatrix);
+
+		std::cout << "\nCircuit unitaries, column by column (8 qubits)\n";
+		Passed &= checkUnitaries<8>(InverseFFT, InverseMatrix);
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkCircuitUnitary);
+}
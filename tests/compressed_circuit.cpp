@@ -0,0 +1,48 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkCompressedCircuit()
+	{
+		// Run random 12-qubit circuits on block-compressed states in both formats and compare
+		// them with the naive reference: the distance must stay within the reported bound.
+
+		std::cout << "Compressed state vectors (12 qubits)\n";
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<12, 3>(Engine, [&](const auto&... gates)
+				{
+					const auto Reference = Checks::referenceState<4096>(0, gates...);
+
+					const auto report = [&](const char* name, const auto& run)
+						{
+							const KetCat::StateVector<4096> State = run.getStateVector();
+							KetCat::float_t DistanceSquared = 0.0;
+							for (KetCat::dimension_t i = 0; i < State.m_StateVector.size(); ++i)
+								DistanceSquared += (State.m_StateVector[i] - Reference.m_StateVector[i]).normSquared();
+
+							const KetCat::float_t Distance = ConstexprMath::sqrt(DistanceSquared);
+							const bool WithinBound = Distance <= run.getAccumulatedError() + Checks::ReferenceTolerance;
+							std::cout << "Seed " << Seed << ", " << name << ": distance to the reference " << std::scientific
+								<< std::setprecision(2) << Distance << ", reported bound " << run.getAccumulatedError()
+								<< (WithinBound ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+							return WithinBound;
+						};
+
+					Passed &= report("shared exponent", QuantumCircuit<12>().withGatesCompressed(gates...));
+					Passed &= report("bfloat16", QuantumCircuit<12>().withGatesCompressed<KetCat::BFloat16Format>(gates...));
+				});
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkCompressedCircuit);
+}
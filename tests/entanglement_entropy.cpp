@@ -0,0 +1,184 @@
+#include <utility>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// ρ_A[i][j] = Σ_b ψ(i, b) ψ*(j, b), summing over every basis state whose kept bits read i, for the reference
+	template<KetCat::dimension_t QBitCount, KetCat::dimension_t StateCount>
+	KetCat::matrix_t<ConstexprMath::pow2(QBitCount)> naivePartialTrace(const KetCat::StateVector<StateCount>& state,
+		const KetCat::qbit_list_t<QBitCount>& keptBits)
+	{
+		const auto keptIndex = [&](KetCat::dimension_t index)
+			{
+				KetCat::dimension_t Local = 0;
+				for (KetCat::dimension_t q = 0; q < QBitCount; ++q)
+					Local |= ((index >> keptBits[q]) & 1) << q;
+				return Local;
+			};
+
+		KetCat::dimension_t KeptMask = 0;
+		for (const KetCat::dimension_t q : keptBits)
+			KeptMask |= KetCat::dimension_t(1) << q;
+
+		KetCat::matrix_t<ConstexprMath::pow2(QBitCount)> Rho{};
+		for (KetCat::dimension_t Row = 0; Row < StateCount; ++Row)
+			for (KetCat::dimension_t Column = 0; Column < StateCount; ++Column)
+			{
+				if ((Row & ~KeptMask) == (Column & ~KeptMask))
+					Rho[keptIndex(Row)][keptIndex(Column)] += state[Row] * state[Column].conj();
+			}
+		return Rho;
+	}
+
+	// Tr(ρ^k) by repeated naive matrix products
+	template<KetCat::dimension_t Dim>
+	KetCat::float_t naiveTracePower(const KetCat::matrix_t<Dim>& rho, KetCat::dimension_t power)
+	{
+		KetCat::matrix_t<Dim> Power = rho;
+		for (KetCat::dimension_t k = 1; k < power; ++k)
+		{
+			KetCat::matrix_t<Dim> Next{};
+			for (KetCat::dimension_t i = 0; i < Dim; ++i)
+				for (KetCat::dimension_t j = 0; j < Dim; ++j)
+					for (KetCat::dimension_t l = 0; l < Dim; ++l)
+						Next[i][j] += Power[i][l] * rho[l][j];
+			Power = Next;
+		}
+
+		KetCat::float_t Trace = 0.0;
+		for (KetCat::dimension_t i = 0; i < Dim; ++i)
+			Trace += Power[i][i].re;
+		return Trace;
+	}
+
+	bool checkValue(std::string_view label, KetCat::float_t value, KetCat::float_t expected)
+	{
+		const KetCat::float_t Deviation = std::abs(value - expected);
+		const bool Passed = Deviation <= Checks::ReferenceTolerance;
+		std::cout << label << ": " << std::setprecision(12) << value << ", expected " << expected
+			<< (Passed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		return Passed;
+	}
+
+	// Compare ρ_A with the naive partial trace, and its spectrum with the power sums Σ λ^k = Tr(ρ^k), k = 1 .. Dim
+	template<KetCat::dimension_t QBitCount, KetCat::dimension_t StateCount>
+	bool checkReducedState(const std::string& label, const KetCat::StateVector<StateCount>& state,
+		const KetCat::qbit_list_t<QBitCount>& keptBits)
+	{
+		constexpr KetCat::dimension_t Dim = ConstexprMath::pow2(QBitCount);
+
+		const auto Rho = reducedDensityMatrix(state, keptBits);
+		const auto Reference = naivePartialTrace(state, keptBits);
+
+		KetCat::float_t Deviation = 0.0;
+		for (KetCat::dimension_t i = 0; i < Dim; ++i)
+			for (KetCat::dimension_t j = 0; j < Dim; ++j)
+				Deviation = std::max(Deviation, std::sqrt((Rho[i][j] - Reference[i][j]).normSquared()));
+
+		const auto Spectrum = hermitianEigenvalues(Rho);
+		for (KetCat::dimension_t k = 1; k <= Dim; ++k)
+		{
+			KetCat::float_t PowerSum = 0.0;
+			for (const KetCat::float_t Lambda : Spectrum)
+				PowerSum += std::pow(Lambda, static_cast<KetCat::float_t>(k));
+			Deviation = std::max(Deviation, std::abs(PowerSum - naiveTracePower(Reference, k)));
+		}
+
+		const bool Passed = Deviation <= Checks::ReferenceTolerance;
+		std::cout << label << ": largest deviation of ρ and its spectrum from the reference " << std::scientific
+			<< std::setprecision(2) << Deviation << (Passed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		return Passed;
+	}
+
+	bool checkMatrix(const std::string& label, const KetCat::matrix_t<4>& rho, const KetCat::matrix_t<4>& expected)
+	{
+		KetCat::float_t Deviation = 0.0;
+		for (KetCat::dimension_t i = 0; i < 4; ++i)
+			for (KetCat::dimension_t j = 0; j < 4; ++j)
+				Deviation = std::max(Deviation, std::sqrt((rho[i][j] - expected[i][j]).normSquared()));
+
+		const bool Passed = Deviation <= Checks::ReferenceTolerance;
+		std::cout << label << ": largest deviation of ρ from the closed form " << std::scientific << std::setprecision(2)
+			<< Deviation << (Passed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		return Passed;
+	}
+
+	bool checkEntanglementEntropy()
+	{
+		// A Bell pair shares exactly one bit of entanglement; then the reduced density matrices of
+		// random 5-qubit states are checked against the naive partial trace, their spectra against
+		// Tr(ρ^k), and the entropies of complementary registers against each other. Last, a 16-qubit
+		// state, whose panels are split into ranges, is checked against its closed form.
+
+		std::cout << "Entanglement of a Bell pair (2 qubits)\n";
+
+		constexpr auto BellPair = QuantumCircuit<2>().withGates(
+			QuantumGate<1, Gates::H>().toBits(0),
+			QuantumGate<2, Gates::CX>().toBits(0, 1));
+		const auto BellState = BellPair.getStateVector();
+		const auto BellSpectrum = hermitianEigenvalues(reducedDensityMatrix<1>(BellState, { 0 }));
+
+		bool Passed = true;
+		Passed &= checkValue("von Neumann entropy", vonNeumannEntropy(BellSpectrum), 1.0);
+		Passed &= checkValue("Renyi-2 entropy", renyiEntropy(BellSpectrum, 2.0), 1.0);
+		Passed &= checkReducedState<1>("Bell pair, qubit 1", BellState, { 1 });
+
+		std::cout << "\nReduced states of random circuits (5 qubits)\n";
+
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<5, 2>(Engine, [&](const auto&... gates)
+				{
+					const std::string Label = "Seed " + std::to_string(Seed);
+					const auto State = QuantumCircuit<5>().withGates(gates...).getStateVector();
+
+					Passed &= checkReducedState<2>(Label + ", qubits (3, 0)", State, { 3, 0 });
+					Passed &= checkReducedState<3>(Label + ", qubits (4, 1, 2)", State, { 4, 1, 2 });
+
+					// A pure state has the same entropies on both sides of a cut
+					Passed &= checkValue(Label + ", S(3, 0) - S(4, 1, 2)",
+						entanglementEntropy<2>(State, { 3, 0 }) - entanglementEntropy<3>(State, { 4, 1, 2 }), 0.0);
+					Passed &= checkValue(Label + ", Renyi-2 S(3, 0) against -log2 Tr(ρ²)", renyiEntanglementEntropy<2>(State, { 3, 0 }, 2.0),
+						-std::log2(naiveTracePower(naivePartialTrace<2>(State, { 3, 0 }), 2)));
+				});
+		}
+
+		std::cout << "\nReduced states of eight rotated pairs (16 qubits, 16 panel ranges)\n";
+
+		// RY(θ_q) on q then CX(q, q + 8): pair q holds cos(θ_q / 2) |00> + sin(θ_q / 2) |11>
+		constexpr std::array<KetCat::float_t, 8> Thetas{ 0.3, 1.1, 2.0, 0.7, 2.9, 1.6, 0.4, 2.3 };
+		const auto Pairs = [&]<std::size_t... Index>(std::index_sequence<Index...>)
+		{
+			return QuantumCircuit<16>().withGates(ParametricGate<Gates::RY>(Thetas[Index]).toBits(Index)...,
+				QuantumGate<2, Gates::CX>().toBits(Index, Index + 8)...);
+		}(std::make_index_sequence<8>{});
+		const auto PairState = Pairs.getStateVector();
+
+		const auto cosine = [&](KetCat::dimension_t q) { return std::cos(Thetas[q] / 2.0); };
+		const auto sine = [&](KetCat::dimension_t q) { return std::sin(Thetas[q] / 2.0); };
+		const auto real = [](KetCat::float_t value) { return KetCat::cplx_t(value, 0.0); };
+
+		// Two halves of different pairs: a product of two diagonal mixtures
+		KetCat::matrix_t<4> Mixed{};
+		for (KetCat::dimension_t i = 0; i < 4; ++i)
+			Mixed[i][i] = real(((i & 1) ? sine(2) * sine(2) : cosine(2) * cosine(2)) * ((i & 2) ? sine(5) * sine(5) : cosine(5) * cosine(5)));
+		Passed &= checkMatrix("Qubits (2, 5)", reducedDensityMatrix<2>(PairState, { 2, 5 }), Mixed);
+
+		// Both halves of a pair: the pure state of the pair
+		KetCat::matrix_t<4> Pure{};
+		Pure[0][0] = real(cosine(6) * cosine(6));
+		Pure[0][3] = Pure[3][0] = real(cosine(6) * sine(6));
+		Pure[3][3] = real(sine(6) * sine(6));
+		Passed &= checkMatrix("Qubits (6, 14)", reducedDensityMatrix<2>(PairState, { 6, 14 }), Pure);
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkEntanglementEntropy);
+}
@@ -0,0 +1,124 @@
+#include <stdexcept>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// Givens rotation mixing |01> and |10>: moves a particle between two orbitals
+	constexpr KetCat::matrix_t<4> givensRotation(KetCat::float_t theta) noexcept
+	{
+		const KetCat::cplx_t Zero(0.0, 0.0), One(1.0, 0.0);
+		const KetCat::cplx_t C(ConstexprMath::cos(theta), 0.0), S(ConstexprMath::sin(theta), 0.0);
+		return KetCat::matrix_t<4>{ {
+			{ One, Zero, Zero, Zero },
+			{ Zero, C, Zero - S, Zero },
+			{ Zero, S, C, Zero },
+			{ Zero, Zero, Zero, One }
+		} };
+	}
+
+	// The Givens rotation as a parametric kind, so the random layers can draw its angle at runtime
+	struct Givens
+	{
+		static constexpr KetCat::dimension_t QBitCount = 2;
+		static constexpr KetCat::dimension_t ParameterCount = 1;
+		static constexpr bool IsDiagonal = false;
+
+		static constexpr KetCat::matrix_t<4> matrix(const std::array<KetCat::float_t, ParameterCount>& angles) noexcept
+		{
+			return givensRotation(angles[0]);
+		}
+
+		static constexpr KetCat::matrix_t<4> derivative(const std::array<KetCat::float_t, ParameterCount>& angles, KetCat::dimension_t) noexcept
+		{
+			// Only the |01>, |10> block depends on the angle: its derivative is the block at θ + π/2
+			KetCat::matrix_t<4> Result = givensRotation(angles[0] + ConstexprMath::Pi / 2.0);
+			Result[0][0] = KetCat::cplx_t(0.0, 0.0);
+			Result[3][3] = KetCat::cplx_t(0.0, 0.0);
+			return Result;
+		}
+	};
+
+	bool checkHammingWeightCircuit()
+	{
+		// Three particles in six orbitals: random circuits of particle-conserving gates run on the
+		// C(6, 3) = 20 amplitudes of the weight-3 subspace instead of 64. The embedded result is
+		// checked against the naive reference started from the same basis state, and a gate
+		// leaving the subspace must be rejected.
+
+		std::cout << "Weight-3 subspace simulation (6 qubits, 20 amplitudes)\n";
+
+		const auto layer = [](Checks::random_engine_t& engine, auto&& visitLayer)
+			{
+				const auto Q = Checks::shuffledQBits<6>(engine);
+				const KetCat::float_t Theta = Checks::randomAngle(engine), Theta2 = Checks::randomAngle(engine);
+				const KetCat::float_t PhaseAngle = Checks::randomAngle(engine), RotationAngle = Checks::randomAngle(engine);
+
+				const auto GivensA = ParametricGate<Givens>(Theta).toBits(Q[0], Q[1]);
+				const auto SWAP = QuantumGate<2, Gates::SWAP>().toBits(Q[2], Q[3]);
+				const auto CPhase = ParametricGate<Gates::CPhase>(PhaseAngle).toBits(Q[4], Q[0]);
+				const auto GivensB = ParametricGate<Givens>(Theta2).toBits(Q[3], Q[5]);
+				const auto RZ = ParametricGate<Gates::RZ>(RotationAngle).toBits(Q[1]);
+
+				return visitLayer(GivensA, SWAP, CPhase, GivensB, RZ);
+			};
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomLayers<3>(Engine, layer, [&](const auto&... gates)
+				{
+					const auto Subspace = QuantumCircuit<6>().withGatesInSubspace<3>(0b000111, gates...);
+
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed), Subspace.getStateVector(), Checks::referenceState<64>(0b000111, gates...));
+				});
+		}
+
+
+		// Six particles in thirty orbitals: C(30, 6) = 593 775 amplitudes (about 9.5 MB), which must
+		// stay off the stack. Two Givens rotations move the top particle up two orbitals; the
+		// amplitudes follow in closed form, and the total probability stays 1.
+		std::cout << "\nWeight-6 subspace simulation (30 qubits, 593775 amplitudes)\n";
+
+		constexpr KetCat::float_t ThetaA = 0.3, ThetaB = 1.1;
+		const auto Large = QuantumCircuit<30>().withGatesInSubspace<6>(0b111111,
+			ParametricGate<Givens>(ThetaA).toBits(5, 6), ParametricGate<Givens>(ThetaB).toBits(6, 7));
+
+		const auto Probabilities = Large.getProbabilities();
+		const KetCat::float_t Total = std::accumulate(Probabilities.begin(), Probabilities.end(), KetCat::float_t{ 0.0 });
+		const KetCat::float_t Deviation = std::max({ std::abs(Total - 1.0),
+			std::sqrt((Large.getAmplitude(0b00111111) - KetCat::cplx_t(std::cos(ThetaA), 0.0)).normSquared()),
+			std::sqrt((Large.getAmplitude(0b01011111) - KetCat::cplx_t(std::sin(ThetaA) * std::cos(ThetaB), 0.0)).normSquared()),
+			std::sqrt((Large.getAmplitude(0b10011111) - KetCat::cplx_t(std::sin(ThetaA) * std::sin(ThetaB), 0.0)).normSquared()) });
+
+		const bool LargePassed = Deviation <= Checks::ReferenceTolerance;
+		std::cout << "Largest deviation from the closed form " << std::scientific << std::setprecision(2) << Deviation
+			<< (LargePassed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		Passed &= LargePassed;
+
+
+		// A Hadamard moves |1> into |0> + |1>, out of the weight-1 subspace: the executor must reject it
+		std::cout << "\nA Hadamard in the weight-1 subspace (4 qubits)\n";
+
+		bool Rejected = false;
+		try
+		{
+			(void)QuantumCircuit<4>().withGatesInSubspace<1>(0b0001, QuantumGate<1, Gates::H>().toBits(0));
+		}
+		catch (const std::invalid_argument&)
+		{
+			Rejected = true;
+		}
+		std::cout << "Rejected with std::invalid_argument: " << (Rejected ? "yes (ok)\n" : "no (FAILED)\n");
+		Passed &= Rejected;
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkHammingWeightCircuit);
+}
@@ -0,0 +1,38 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkLayeredCircuit()
+	{
+		// Regroup random 6-qubit circuits into layers of gates on disjoint qubits, run every
+		// layer as one sweep and check the final states against the naive reference.
+
+		std::cout << "Layered execution of random 6-qubit circuits\n";
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3, 4, 5 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<6, 3>(Engine, [&](const auto&... gates)
+				{
+					const auto Record = CircuitRecord<recorded_max_qbit_count_v<std::remove_cvref_t<decltype(gates)>...>,
+						sizeof...(gates)>::fromGates(gates...);
+					const auto Layers = buildLayers(Record, 0, Record.GateCount);
+
+					KetCat::StateVector<64> Layered = QBitState<6>()();
+					executeLayered(Layered, Record, 0, Record.GateCount);
+
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed) + ", " + std::to_string(Record.GateCount)
+						+ " gates in " + std::to_string(Layers.LayerCount) + " layers", Layered, Checks::referenceState<64>(0, gates...));
+				});
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkLayeredCircuit);
+}
@@ -0,0 +1,82 @@
+#include <utility>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkLazyCircuit()
+	{
+		// Record random 8-qubit circuits, padded with pairs of gates that cancel, without running
+		// them; let the lazy executor optimise them per query, and check the state and the
+		// marginals of qubits 0..2 against the naive reference.
+
+		std::cout << "Lazy (deferred) evaluation of random 8-qubit circuits\n";
+
+		constexpr auto IQFT3 = Gates::make_IQFT_matrix<3>();
+
+		constexpr auto H1 = QuantumGate<1, Gates::H>().toBits(1);
+		constexpr auto CX04 = QuantumGate<2, Gates::CX>().toBits(0, 4);
+		constexpr auto RZ5 = ParametricGate<Gates::RZ>(0.4).toBits(5);
+		constexpr auto RZ5Inverse = ParametricGate<Gates::RZ>(-0.4).toBits(5);
+		constexpr auto IQFT012 = QuantumGate<3, IQFT3>().toBits(0, 1, 2);
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<8, 3>(Engine, [&](const auto&... gates)
+				{
+					const auto Lazy = QuantumCircuit<8>().withGatesDeferred(H1, H1, gates..., CX04, CX04, RZ5, RZ5Inverse, IQFT012);
+					const auto Reference = Checks::referenceState<256>(0, H1, H1, gates..., CX04, CX04, RZ5, RZ5Inverse, IQFT012);
+
+					const CircuitOptimizationReport Report = Lazy.getOptimizationReport();
+					std::cout << "Seed " << Seed << ": " << Report.OriginalGateCount << " recorded gates, " << Report.CancelledGates
+						<< " cancelled, " << Report.FusedGates << " fused, " << Report.PrunedGates << " pruned\n";
+
+					Passed &= Checks::checkAgainstReference("  state", Lazy.getStateVector(), Reference);
+
+					// Marginals of the phase register, computed only from the gates in its light cone
+					const auto Marginals = Lazy.template getMarginalProbabilities<0, 1, 2>();
+					KetCat::float_t LargestDifference = 0.0;
+					for (KetCat::dimension_t Outcome = 0; Outcome < Marginals.size(); ++Outcome)
+					{
+						KetCat::float_t Sum = 0.0;
+						for (KetCat::dimension_t i = Outcome; i < Reference.m_StateVector.size(); i += Marginals.size())
+							Sum += Reference.m_StateVector[i].normSquared();
+						LargestDifference = std::max(LargestDifference, std::abs(Sum - Marginals[Outcome]));
+					}
+
+					const bool MarginalsPassed = LargestDifference <= Checks::ReferenceTolerance;
+					std::cout << "  marginals: largest deviation from the reference " << std::scientific << std::setprecision(2)
+						<< LargestDifference << (MarginalsPassed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+					Passed &= MarginalsPassed;
+				});
+		}
+
+		// The circuit of wide_gate_circuit.cpp, a 5-qubit IQFT and 400 Hadamards: the recording and
+		// its optimised copies hold megabytes of records, which must stay off the stack.
+		std::cout << "\nLazy evaluation of a 5-qubit IQFT and 400 Hadamards (8 qubits)\n";
+
+		constexpr auto IQFT5 = Gates::make_IQFT_matrix<5>();
+		const auto IQFT = QuantumGate<5, IQFT5>().toBits(0, 1, 2, 3, 4);
+		const auto H7 = QuantumGate<1, Gates::H>().toBits(7);
+
+		Passed &= [&]<std::size_t... Index>(std::index_sequence<Index...>)
+		{
+			const auto Lazy = QuantumCircuit<8>().withGatesDeferred(IQFT, ((void)Index, H7)...);
+
+			const CircuitOptimizationReport Report = Lazy.getOptimizationReport();
+			std::cout << Report.OriginalGateCount << " recorded gates, " << Report.CancelledGates << " cancelled\n";
+
+			return Checks::checkAgainstReference("  state", Lazy.getStateVector(), Checks::referenceState<256>(0, IQFT, ((void)Index, H7)...));
+		}(std::make_index_sequence<400>{});
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkLazyCircuit);
+}
@@ -0,0 +1,33 @@
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+int main(int argc, char* argv[])
+{
+	// Run the checks named on the command line (all of them without arguments); CTest passes
+	// one name per test. Unknown names fail, so a renamed file cannot silently skip its check.
+
+	const std::vector<std::string_view> Names(argv + 1, argv + argc);
+
+	bool Passed = true;
+	for (const std::string_view Name : Names)
+	{
+		const bool Known = std::ranges::any_of(Checks::registeredChecks(),
+			[&](const Checks::RegisteredCheck& check) { return check.Name == Name; });
+		if (!Known)
+		{
+			std::cout << "Unknown check: " << Name << "\n";
+			Passed = false;
+		}
+	}
+
+	for (const Checks::RegisteredCheck& Check : Checks::registeredChecks())
+	{
+		if (!Names.empty() && std::ranges::find(Names, Check.Name) == Names.end())
+			continue;
+
+		std::cout << "== " << Check.Name << "\n";
+		Passed &= Check.Run();
+	}
+	return Passed ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// The permutation matrix of f on Q target qubits behind C controls (controls first), written out naively for the reference
+	template<KetCat::dimension_t ControlCount, KetCat::dimension_t TargetCount, typename Function>
+	Checks::MatrixGate<ControlCount + TargetCount> permutationMatrix(const Function& f,
+		const KetCat::qbit_list_t<ControlCount + TargetCount>& qbits)
+	{
+		constexpr KetCat::dimension_t Dim = ConstexprMath::pow2(ControlCount + TargetCount);
+		constexpr KetCat::dimension_t Controls = ConstexprMath::pow2(ControlCount) - 1;
+
+		Checks::MatrixGate<ControlCount + TargetCount> Gate{};
+		Gate.AffectedBits = qbits;
+		for (KetCat::dimension_t Column = 0; Column < Dim; ++Column)
+		{
+			const KetCat::dimension_t Row = (Column & Controls) == Controls
+				? (Column & Controls) | (f(Column >> ControlCount) << ControlCount)
+				: Column;
+			Gate.Matrix[Row][Column] = KetCat::cplx_t(1.0, 0.0);
+		}
+		return Gate;
+	}
+
+	bool checkModularArithmetic()
+	{
+		// Put constant adders, modular multipliers and adders (controlled and uncontrolled) and a
+		// comparator into random 6-qubit circuits, and check the result against the naive
+		// reference applying every arithmetic gate as a permutation matrix.
+
+		std::cout << "Reversible arithmetic as permutation gates (6 qubits)\n";
+
+		constexpr Gates::Addition<3, 5> Add5{};
+		constexpr Gates::ModularMultiplication<2, 7> Times2Mod7{};
+		constexpr Gates::ModularMultiplication<4, 5> Times4Mod5{};
+		constexpr Gates::ModularAddition<3, 7> Plus3Mod7{};
+		constexpr Gates::LessThan<3, 5> Below5{};
+
+		const auto Adder = PermutationGate<3, Add5>().toBits(4, 1, 2);
+		const auto Multiplier = PermutationGate<3, Times4Mod5>().toBits(0, 3, 5);
+		const auto ControlledMultiplier = PermutationGate<3, Times2Mod7, 1>().toBits(5, 0, 3, 4);
+		const auto DoublyControlledAdder = PermutationGate<3, Plus3Mod7, 2>().toBits(0, 5, 1, 2, 3);
+		const auto Comparator = PermutationGate<4, Below5>().toBits(2, 4, 0, 1);
+
+		const auto AdderMatrix = permutationMatrix<0, 3>(Add5, { 4, 1, 2 });
+		const auto MultiplierMatrix = permutationMatrix<0, 3>(Times4Mod5, { 0, 3, 5 });
+		const auto ControlledMultiplierMatrix = permutationMatrix<1, 3>(Times2Mod7, { 5, 0, 3, 4 });
+		const auto DoublyControlledAdderMatrix = permutationMatrix<2, 3>(Plus3Mod7, { 0, 5, 1, 2, 3 });
+		const auto ComparatorMatrix = permutationMatrix<0, 4>(Below5, { 2, 4, 0, 1 });
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<6, 1>(Engine, [&](const auto&... gates)
+				{
+					const auto Run = QuantumCircuit<6>().withGates(gates..., Adder, ControlledMultiplier,
+						DoublyControlledAdder, Multiplier, Comparator, gates...);
+
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed), Run.getStateVector(),
+						Checks::referenceState<64>(0, gates..., AdderMatrix, ControlledMultiplierMatrix,
+							DoublyControlledAdderMatrix, MultiplierMatrix, ComparatorMatrix, gates...));
+				});
+		}
+
+		// On a basis state the gates act classically: control 5 set, |3> on (0, 3, 4) becomes |6>
+		const auto Classical = QuantumCircuit<6>().withGates(
+			QuantumGate<1, Gates::X>().toBits(5),
+			QuantumGate<1, Gates::X>().toBits(0),
+			QuantumGate<1, Gates::X>().toBits(3),
+			ControlledMultiplier);
+		const KetCat::float_t Probability = Classical.getStateVector().getProbabilities()[0b111000];
+		const bool ClassicalPassed = std::abs(Probability - 1.0) <= Checks::ReferenceTolerance;
+		std::cout << "2 · 3 mod 7 = 6: probability " << Probability << (ClassicalPassed ? " (ok)\n" : " (FAILED)\n");
+		Passed &= ClassicalPassed;
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkModularArithmetic);
+}
@@ -0,0 +1,54 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// |x> -> |x + 5 mod 8> written out as a permutation matrix, for the reference
+	constexpr KetCat::matrix_t<8> AddFiveMatrix = []
+		{
+			KetCat::matrix_t<8> Matrix{};
+			for (KetCat::dimension_t y = 0; y < 8; ++y)
+				for (KetCat::dimension_t x = 0; x < 8; ++x)
+					Matrix[y][x] = KetCat::cplx_t(y == (x + 5) % 8 ? 1.0 : 0.0, 0.0);
+			return Matrix;
+		}();
+
+	bool checkMultiState()
+	{
+		// Run random 4-qubit circuits ending with a reversible adder on four random basis inputs
+		// at once, and check every output against the naive reference started from that input.
+
+		std::cout << "One circuit on a batch of 4 basis inputs (4 qubits)\n";
+
+		constexpr auto Add5 = PermutationGate<3, Gates::Addition<3, 5>{}>().toBits(1, 2, 3);
+		constexpr auto Add5Matrix = QuantumGate<3, AddFiveMatrix>().toBits(1, 2, 3);
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+
+			std::array<KetCat::dimension_t, 4> Inputs{};
+			for (KetCat::dimension_t& Input : Inputs)
+				Input = std::uniform_int_distribution<KetCat::dimension_t>(0, 15)(Engine);
+
+			Checks::withRandomCircuit<4, 2>(Engine, [&](const auto&... gates)
+				{
+					const auto Batch = QuantumCircuit<4>().withBasisInputs(Inputs, gates..., Add5);
+
+					for (KetCat::dimension_t b = 0; b < Inputs.size(); ++b)
+					{
+						Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed) + ", input |" + std::to_string(Inputs[b]) + ">",
+							Batch.getStateVector(b), Checks::referenceState<16>(Inputs[b], gates..., Add5Matrix));
+					}
+				});
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkMultiState);
+}
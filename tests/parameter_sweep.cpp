@@ -0,0 +1,50 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkParameterSweep()
+	{
+		// Sweep the two rotation angles around a random 3-qubit circuit over four random
+		// parameter sets in one batched run, and check every member of the batch against the
+		// naive reference of the same circuit at those angles.
+
+		std::cout << "Parameter sweep over 4 angle pairs (3 qubits)\n";
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+
+			parameter_sets_t<4, 2> Angles{};
+			for (auto& Set : Angles)
+				Set = { Checks::randomAngle(Engine), Checks::randomAngle(Engine) };
+
+			Checks::withRandomCircuit<3, 1>(Engine, [&](const auto&... gates)
+				{
+					const auto Sweep = QuantumCircuit<3>().withParameterSweep(Angles,
+						SweptGate<1, Gates::RotationY>(0).toBits(2),
+						gates...,
+						SweptGate<1, Gates::RotationY>(1).toBits(1));
+
+					for (KetCat::dimension_t b = 0; b < Angles.size(); ++b)
+					{
+						const auto Reference = Checks::referenceState<8>(0,
+							ParametricGate<Gates::RY>(Angles[b][0]).toBits(2),
+							gates...,
+							ParametricGate<Gates::RY>(Angles[b][1]).toBits(1));
+
+						Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed) + ", set " + std::to_string(b),
+							Sweep.getStateVector(b), Reference);
+					}
+				});
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkParameterSweep);
+}
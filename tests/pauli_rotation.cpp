@@ -0,0 +1,83 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// exp(-iθP) = cos θ I - i sin θ P written out with P as the Kronecker product of its letters, for the reference
+	template<KetCat::dimension_t QBitCount>
+	Checks::MatrixGate<QBitCount> pauliExponential(KetCat::float_t theta, const char (&letters)[QBitCount + 1],
+		const KetCat::qbit_list_t<QBitCount>& qbits)
+	{
+		const auto sigma = [](char letter, KetCat::dimension_t row, KetCat::dimension_t column)
+			{
+				switch (letter)
+				{
+				case 'X':
+					return KetCat::cplx_t(row != column ? 1.0 : 0.0, 0.0);
+				case 'Y':
+					return KetCat::cplx_t(0.0, row == column ? 0.0 : (row == 1 ? 1.0 : -1.0));
+				case 'Z':
+					return KetCat::cplx_t(row != column ? 0.0 : (row == 0 ? 1.0 : -1.0), 0.0);
+				default:
+					return KetCat::cplx_t(row == column ? 1.0 : 0.0, 0.0);
+				}
+			};
+
+		constexpr KetCat::dimension_t Dim = ConstexprMath::pow2(QBitCount);
+		Checks::MatrixGate<QBitCount> Gate{};
+		Gate.AffectedBits = qbits;
+		for (KetCat::dimension_t Row = 0; Row < Dim; ++Row)
+			for (KetCat::dimension_t Column = 0; Column < Dim; ++Column)
+			{
+				KetCat::cplx_t P(1.0, 0.0);
+				for (KetCat::dimension_t q = 0; q < QBitCount; ++q)
+					P = P * sigma(letters[q], (Row >> q) & 1, (Column >> q) & 1);
+
+				const KetCat::cplx_t Identity(Row == Column ? std::cos(theta) : 0.0, 0.0);
+				Gate.Matrix[Row][Column] = Identity + KetCat::cplx_t(0.0, -std::sin(theta)) * P;
+			}
+		return Gate;
+	}
+
+	bool checkPauliRotation()
+	{
+		// Put rotations about multi-qubit Pauli strings (mixed X / Y / Z, Y only, Z only, with an
+		// identity letter) into random 5-qubit circuits, and check the result against the naive
+		// reference applying every exponential as a dense matrix.
+
+		std::cout << "Pauli-string rotations exp(-iθP) (5 qubits)\n";
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			const KetCat::float_t A = Checks::randomAngle(Engine), B = Checks::randomAngle(Engine);
+			const KetCat::float_t C = Checks::randomAngle(Engine), D = Checks::randomAngle(Engine);
+
+			const auto XZY = PauliRotation<3>(A, "XZY").toBits(0, 3, 4);
+			const auto YY = PauliRotation<2>(B, "YY").toBits(2, 1);
+			const auto ZZZZ = PauliRotation<4>(C, "ZZZZ").toBits(4, 1, 0, 3);
+			const auto XIY = PauliRotation<3>(D, "XIY").toBits(1, 2, 3);
+
+			const auto XZYMatrix = pauliExponential<3>(A, "XZY", { 0, 3, 4 });
+			const auto YYMatrix = pauliExponential<2>(B, "YY", { 2, 1 });
+			const auto ZZZZMatrix = pauliExponential<4>(C, "ZZZZ", { 4, 1, 0, 3 });
+			const auto XIYMatrix = pauliExponential<3>(D, "XIY", { 1, 2, 3 });
+
+			Checks::withRandomCircuit<5, 1>(Engine, [&](const auto&... gates)
+				{
+					const auto Run = QuantumCircuit<5>().withGates(gates..., XZY, YY, ZZZZ, XIY);
+
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed), Run.getStateVector(),
+						Checks::referenceState<32>(0, gates..., XZYMatrix, YYMatrix, ZZZZMatrix, XIYMatrix));
+				});
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkPauliRotation);
+}
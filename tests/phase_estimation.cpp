@@ -0,0 +1,76 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkPhaseEstimation()
+	{
+		// Check the FFT-based Fourier transforms against the dense IQFT matrix (and its adjoint)
+		// after random 5-qubit circuits, then estimate an exact eigenphase with 5 phase qubits.
+
+		std::cout << "FFT-based QFT and inverse QFT against make_IQFT_matrix (5 qubits)\n";
+
+		constexpr auto IQFT3 = Gates::make_IQFT_matrix<3>();
+		constexpr auto IQFT5 = Gates::make_IQFT_matrix<5>();
+
+		// QFT = IQFT†
+		Checks::MatrixGate<3> QFT3Matrix{};
+		QFT3Matrix.AffectedBits = { 0, 3, 1 };
+		for (KetCat::dimension_t Row = 0; Row < 8; ++Row)
+			for (KetCat::dimension_t Column = 0; Column < 8; ++Column)
+				QFT3Matrix.Matrix[Row][Column] = IQFT3[Column][Row].conj();
+
+		const auto InverseFFT3 = InverseQFT<3>().toBits(4, 1, 2);
+		const auto InverseFFT5 = InverseQFT<5>().toBits(2, 0, 4, 1, 3);
+		const auto FFT3 = QFT<3>().toBits(0, 3, 1);
+
+		const auto InverseMatrix3 = QuantumGate<3, IQFT3>().toBits(4, 1, 2);
+		const auto InverseMatrix5 = QuantumGate<5, IQFT5>().toBits(2, 0, 4, 1, 3);
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<5, 1>(Engine, [&](const auto&... gates)
+				{
+					const std::string Label = "Seed " + std::to_string(Seed);
+
+					Passed &= Checks::checkAgainstReference(Label + ", InverseQFT<3>",
+						QuantumCircuit<5>().withGates(gates..., InverseFFT3).getStateVector(),
+						Checks::referenceState<32>(0, gates..., InverseMatrix3));
+
+					Passed &= Checks::checkAgainstReference(Label + ", InverseQFT<5>",
+						QuantumCircuit<5>().withGates(gates..., InverseFFT5).getStateVector(),
+						Checks::referenceState<32>(0, gates..., InverseMatrix5));
+
+					Passed &= Checks::checkAgainstReference(Label + ", QFT<3>",
+						QuantumCircuit<5>().withGates(gates..., FFT3).getStateVector(),
+						Checks::referenceState<32>(0, gates..., QFT3Matrix));
+				});
+		}
+
+		// diag(1, e^{2πi·11/32}) on qubit 5, prepared in its eigenstate |1>: the 5-qubit phase
+		// register must read 11 with probability 1.
+		std::cout << "\nPhase estimation of the eigenphase 11/32 (5 phase qubits, 6 qubits)\n";
+
+		constexpr KetCat::float_t Eigenphase = 11.0 / 32.0;
+		const auto Phase = ParametricGate<Gates::U3>(0.0, 0.0, 2.0 * ConstexprMath::Pi * Eigenphase).toBits(5);
+
+		const auto Estimate = QuantumCircuit<6>().withGates(
+			QuantumGate<1, Gates::X>().toBits(5),
+			PhaseEstimation<5, 1>(Phase).toBits(0, 1, 2, 3, 4));
+
+		const KetCat::float_t PeakProbability = Estimate.getStateVector().getProbabilities()[11 | (1 << 5)];
+		const bool PeakPassed = std::abs(PeakProbability - 1.0) <= Checks::ReferenceTolerance;
+		std::cout << "P(phase register = 11) = " << std::setprecision(12) << PeakProbability
+			<< (PeakPassed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		Passed &= PeakPassed;
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkPhaseEstimation);
+}
@@ -0,0 +1,70 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// The marked values of the Grover oracle, and the phase function of the second oracle
+	constexpr auto Marked = [](KetCat::dimension_t x) { return x == 2 || x == 5; };
+	constexpr auto Phase = [](KetCat::dimension_t x) { return 0.7 * static_cast<KetCat::float_t>(x); };
+
+	// Both oracles written out as diagonal matrices, evaluating the functions directly, for the reference
+	constexpr KetCat::matrix_t<8> MarkedMatrix = []
+		{
+			KetCat::matrix_t<8> Matrix{};
+			for (KetCat::dimension_t y = 0; y < 8; ++y)
+				for (KetCat::dimension_t x = 0; x < 8; ++x)
+					Matrix[y][x] = KetCat::cplx_t(y != x ? 0.0 : (Marked(x) ? -1.0 : 1.0), 0.0);
+			return Matrix;
+		}();
+
+	constexpr KetCat::matrix_t<4> PhaseMatrix = []
+		{
+			KetCat::matrix_t<4> Matrix{};
+			for (KetCat::dimension_t y = 0; y < 4; ++y)
+				for (KetCat::dimension_t x = 0; x < 4; ++x)
+					Matrix[y][x] = y != x ? KetCat::cplx_t(0.0, 0.0) : KetCat::cplx_t(ConstexprMath::cos(Phase(x)), ConstexprMath::sin(Phase(x)));
+			return Matrix;
+		}();
+
+	bool checkPhaseOracle()
+	{
+		// Put random 5-qubit circuits around a sign-flip oracle on qubits (4, 0, 2) and a phase
+		// oracle on qubits (3, 1), and check the result against the naive reference applying both
+		// oracles as diagonal matrices.
+
+		std::cout << "Phase oracles from constexpr functions (5 qubits)\n";
+
+		constexpr auto Oracle = PhaseOracle<3, Marked>().toBits(4, 0, 2);
+		constexpr auto OracleMatrix = QuantumGate<3, MarkedMatrix>().toBits(4, 0, 2);
+		constexpr auto PhaseOracleGate = PhaseFunctionOracle<2, Phase>().toBits(3, 1);
+		constexpr auto PhaseOracleMatrix = QuantumGate<2, PhaseMatrix>().toBits(3, 1);
+
+		const auto H = [](KetCat::dimension_t q) { return QuantumGate<1, Gates::H>().toBits(q); };
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<5, 1>(Engine, [&](const auto&... gates)
+				{
+					const auto Run = QuantumCircuit<5>().withGates(H(0), H(1), H(2), H(3), H(4),
+						Oracle, gates..., PhaseOracleGate, H(1), H(3));
+
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed), Run.getStateVector(),
+						Checks::referenceState<32>(0, H(0), H(1), H(2), H(3), H(4),
+							OracleMatrix, gates..., PhaseOracleMatrix, H(1), H(3)));
+				});
+		}
+
+		// The table lists only the values whose phase is not one
+		std::cout << "Marked values: " << PhaseOracle<3, Marked>::Table.ActiveCount << " of 8\n";
+		Passed &= PhaseOracle<3, Marked>::Table.ActiveCount == 2;
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkPhaseOracle);
+}
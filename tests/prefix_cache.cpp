@@ -0,0 +1,67 @@
+#include <sstream>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkPrefixCache()
+	{
+		// Re-run random 6-qubit circuits whose last rotation angle changes between runs. The
+		// prefix cache restores the state before the edited gate instead of re-executing the
+		// whole circuit; every run is checked against the naive reference. Then an entry forged
+		// under the key of a circuit, with another verification hash, must not be restored.
+
+		std::cout << "Prefix-cached re-execution of random 6-qubit circuits\n";
+
+		CircuitPrefixCache<6> Cache(8, 4);
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<6, 2>(Engine, [&](const auto&... gates)
+				{
+					for (const KetCat::float_t Theta : { 0.1, 0.2, 0.3 })
+					{
+						const auto RZ1 = ParametricGate<Gates::RZ>(Theta).toBits(1);
+						const auto Cached = QuantumCircuit<6>().withGatesCached(Cache, gates..., RZ1);
+
+						std::ostringstream Label;
+						Label << "Seed " << Seed << ", theta = " << std::fixed << std::setprecision(1) << Theta;
+						Passed &= Checks::checkAgainstReference(Label.str(), Cached.getStateVector(),
+							Checks::referenceState<64>(0, gates..., RZ1));
+					}
+				});
+		}
+
+		const CircuitPrefixCacheStats& Stats = Cache.getStats();
+		std::cout << "Cache hits: " << Stats.Hits << ", misses: " << Stats.Misses
+			<< ", skipped gates: " << Stats.SkippedGates << ", executed gates: " << Stats.ExecutedGates << "\n";
+
+		std::cout << "\nForged entry with a colliding key\n";
+
+		Checks::random_engine_t Engine(3);
+		Checks::withRandomCircuit<6, 2>(Engine, [&](const auto&... gates)
+			{
+				const auto PrefixHashes = circuitPrefixHashes<6>(gates...);
+				const KetCat::dimension_t Length = PrefixHashes.HashableLength;
+
+				CircuitPrefixCache<6> Forged(8, 0);
+				Forged.store(PrefixHashes.Hashes[Length], PrefixHashes.Checks[Length] ^ 1, KetCat::StateVector<64>{});
+				const auto Run = QuantumCircuit<6>().withGatesCached(Forged, gates...);
+
+				const bool Ignored = Forged.getStats().Hits == 0;
+				std::cout << "Forged entry ignored: " << (Ignored ? "yes (ok)\n" : "no (FAILED)\n");
+				Passed &= Ignored;
+				Passed &= Checks::checkAgainstReference("Forged entry", Run.getStateVector(), Checks::referenceState<64>(0, gates...));
+			});
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkPrefixCache);
+}
@@ -0,0 +1,58 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// Physical index of a logical basis index stored in the given layout
+	KetCat::dimension_t physicalIndex(const QubitLayout<8>& layout, KetCat::dimension_t logicalIndex)
+	{
+		KetCat::dimension_t Index = 0;
+		for (KetCat::dimension_t q = 0; q < 8; ++q)
+			Index |= ((logicalIndex >> q) & 1) << layout.physical(q);
+		return Index;
+	}
+
+	bool checkQubitLayout()
+	{
+		// Move a state with distinct amplitudes between random layouts of 8 qubits (and through an
+		// 8-cycle, the longest), and check that every logical amplitude lands where the target
+		// layout stores it; the in-place pass must not lose or duplicate any amplitude.
+
+		std::cout << "In-place qubit permutations between random layouts (8 qubits)\n";
+
+		KetCat::StateVector<256> Logical{};
+		for (KetCat::dimension_t i = 0; i < 256; ++i)
+			Logical.m_StateVector[i] = KetCat::cplx_t(static_cast<KetCat::float_t>(i), 1.0);
+
+		QubitLayout<8> Cycle{};
+		for (KetCat::dimension_t q = 0; q < 8; ++q)
+			Cycle.LogicalToPhysical[q] = (q + 1) % 8;
+
+		Checks::random_engine_t Engine(1);
+		std::vector<QubitLayout<8>> Layouts{ QubitLayout<8>{}, Cycle };
+		for (KetCat::dimension_t l = 0; l < 6; ++l)
+			Layouts.push_back(QubitLayout<8>{ Checks::shuffledQBits<8>(Engine) });
+		Layouts.push_back(QubitLayout<8>{});
+
+		bool Passed = true;
+		KetCat::StateVector<256> State = Logical;
+		for (KetCat::dimension_t l = 1; l < Layouts.size(); ++l)
+		{
+			permuteQubits(State, Layouts[l - 1], Layouts[l]);
+
+			bool Placed = true;
+			for (KetCat::dimension_t i = 0; i < 256; ++i)
+				Placed &= State.m_StateVector[physicalIndex(Layouts[l], i)].re == Logical.m_StateVector[i].re;
+
+			std::cout << "Layout " << l << ": every amplitude in place: " << (Placed ? "yes (ok)\n" : "no (FAILED)\n");
+			Passed &= Placed;
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkQubitLayout);
+}
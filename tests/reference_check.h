@@ -0,0 +1,251 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "systems/quantum_circuit.h"
+
+namespace KetCat::QCC::Checks
+{
+	/// @file
+	/// @brief Shared code of the checks: registration, a naive reference simulator and random circuits.
+	///
+	/**
+	 * @details
+	 * The executors of the library share their kernels, records and schedulers with withGates,
+	 * so comparing them with withGates would not catch a bug in that shared code. The reference
+	 * below only uses the matrix and the qubits of every gate and applies them as a plain
+	 * matrix-vector product over all basis states, out of place; it shares nothing with the
+	 * executors beyond the gate definitions.
+	 *
+	 * Every tests/*.cpp file registers one check with `registerCheck`; the `ketcat_checks`
+	 * executable runs the check named on its command line, and CTest runs every file's check
+	 * as a separate test.
+	 */
+
+	/// @brief A check of the test executable: the name of the file defining it and the function running it.
+	struct RegisteredCheck
+	{
+		std::string Name;
+		std::function<bool()> Run;
+	};
+
+	/// @brief All registered checks, in registration order.
+	inline std::vector<RegisteredCheck>& registeredChecks()
+	{
+		static std::vector<RegisteredCheck> All{};
+		return All;
+	}
+
+	/**
+	 * @brief     Register a check under the name of the calling file, without directory and extension.
+	 *
+	 * @param check     Prints its comparisons and returns whether all of them passed.
+	 * @return          true, so that the registration can initialise a namespace-scope constant.
+	 */
+	inline bool registerCheck(std::function<bool()> check, std::source_location location = std::source_location::current())
+	{
+		const std::string_view Path = location.file_name();
+		const std::string_view File = Path.substr(Path.find_last_of("/\\") + 1);
+		registeredChecks().push_back({ std::string(File.substr(0, File.find('.'))), std::move(check) });
+		return true;
+	}
+
+	/// @brief Largest amplitude deviation the checks accept from the reference.
+	constexpr float_t ReferenceTolerance = 1E-9;
+
+	/// @brief Apply one gate to a state with the naive out-of-place matrix-vector product.
+	template<dimension_t StateCount, typename GateType>
+	void applyReference(StateVector<StateCount>& state, const GateType& gate)
+	{
+		const auto& Matrix = gate.getGateMatrix();
+		const auto& Bits = gate.getAffectedBits();
+		const dimension_t Dim = Matrix.size();
+
+		StateVector<StateCount> Result{};
+		for (dimension_t Index = 0; Index < StateCount; ++Index)
+		{
+			// Split the basis index into the local column and the untouched bits
+			dimension_t Column = 0, Rest = Index;
+			for (dimension_t q = 0; q < Bits.size(); ++q)
+			{
+				Column |= ((Index >> Bits[q]) & 1) << q;
+				Rest &= ~(dimension_t(1) << Bits[q]);
+			}
+
+			for (dimension_t Row = 0; Row < Dim; ++Row)
+			{
+				dimension_t Target = Rest;
+				for (dimension_t q = 0; q < Bits.size(); ++q)
+					Target |= ((Row >> q) & 1) << Bits[q];
+				Result[Target] += Matrix[Row][Column] * state[Index];
+			}
+		}
+		state = Result;
+	}
+
+	/**
+	 * @brief     A gate given only by its matrix and qubits, for the reference.
+	 *
+	 * Operations applied without a matrix (Pauli rotations, Fourier transforms, phase
+	 * estimation) are checked against their matrix written out naively; a runtime matrix
+	 * cannot be a template argument of QuantumGate, so it is carried here instead.
+	 */
+	template<dimension_t QBitCount>
+	struct MatrixGate
+	{
+		matrix_t<ConstexprMath::pow2(QBitCount)> Matrix{};
+		qbit_list_t<QBitCount> AffectedBits{};
+
+		const matrix_t<ConstexprMath::pow2(QBitCount)>& getGateMatrix() const noexcept
+		{
+			return Matrix;
+		}
+
+		const qbit_list_t<QBitCount>& getAffectedBits() const noexcept
+		{
+			return AffectedBits;
+		}
+	};
+
+	/// @brief Reference state of a circuit started from the given basis state.
+	template<dimension_t StateCount, typename... GateTypes>
+	StateVector<StateCount> referenceState(dimension_t basisIndex, const GateTypes&... gates)
+	{
+		StateVector<StateCount> State{};
+		State[basisIndex] = cplx_t(1.0, 0.0);
+		(applyReference(State, gates), ...);
+		return State;
+	}
+
+	/// @brief Largest absolute difference between the amplitudes of two states.
+	template<dimension_t StateCount>
+	float_t largestDeviation(const StateVector<StateCount>& state, const StateVector<StateCount>& reference)
+	{
+		float_t Largest = 0.0;
+		for (dimension_t i = 0; i < StateCount; ++i)
+			Largest = std::max(Largest, std::sqrt((state[i] - reference[i]).normSquared()));
+		return Largest;
+	}
+
+	/// @brief Print the deviation of a state from its reference and return whether it is within tolerance.
+	template<dimension_t StateCount>
+	bool checkAgainstReference(std::string_view label, const StateVector<StateCount>& state,
+		const StateVector<StateCount>& reference, float_t tolerance = ReferenceTolerance)
+	{
+		const float_t Deviation = largestDeviation(state, reference);
+		const bool Passed = Deviation <= tolerance;
+		std::cout << label << ": largest deviation from the reference " << std::scientific << std::setprecision(2)
+			<< Deviation << (Passed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		return Passed;
+	}
+
+	/// @brief Random generator of a check; the seeds are fixed so that every run checks the same circuits.
+	using random_engine_t = std::mt19937_64;
+
+	/// @brief Random angle in [-π, π).
+	inline float_t randomAngle(random_engine_t& engine)
+	{
+		return std::uniform_real_distribution<float_t>(-ConstexprMath::Pi, ConstexprMath::Pi)(engine);
+	}
+
+	/// @brief Random ordering of the qubits 0 .. QBitCount-1, so that gates drawn from it act on distinct qubits.
+	template<dimension_t QBitCount>
+	std::array<dimension_t, QBitCount> shuffledQBits(random_engine_t& engine)
+	{
+		std::array<dimension_t, QBitCount> QBits{};
+		std::iota(QBits.begin(), QBits.end(), dimension_t{ 0 });
+		std::shuffle(QBits.begin(), QBits.end(), engine);
+		return QBits;
+	}
+
+	/// @brief CX after a Hadamard on both qubits: a dense entangling gate, unlike CX, CPhase and SWAP.
+	constexpr matrix_t<4> HadamardCX = []
+		{
+			matrix_t<4> Result{};
+			for (dimension_t Row = 0; Row < 4; ++Row)
+				for (dimension_t Column = 0; Column < 4; ++Column)
+					for (dimension_t k = 0; k < 4; ++k)
+						Result[Row][Column] += Gates::CX[Row][k] * Gates::H[k & 1][Column & 1] * Gates::H[k >> 1][Column >> 1];
+			return Result;
+		}();
+
+	/**
+	 * @brief     Build a circuit of random layers and pass its gates to a visitor.
+	 *
+	 * @tparam LayerCount  Number of layers.
+	 * @param engine       Random generator the layers are drawn from.
+	 * @param layer        Called as layer(engine, visitLayer): draws one layer and calls
+	 *                     visitLayer with its gates.
+	 * @param visit        Called with the gates of the circuit, in order; its result is returned.
+	 *
+	 * The gates are locals of the recursion (QuantumGateOp cannot be copied), hence the visitors.
+	 */
+	template<dimension_t LayerCount, typename LayerBuilder, typename Visitor>
+	decltype(auto) withRandomLayers(random_engine_t& engine, const LayerBuilder& layer, Visitor&& visit)
+	{
+		if constexpr (LayerCount == 0)
+		{
+			return visit();
+		}
+		else
+		{
+			return layer(engine, [&](const auto&... current) -> decltype(auto)
+				{
+					return withRandomLayers<LayerCount - 1>(engine, layer, [&](const auto&... rest) -> decltype(auto)
+						{
+							return visit(current..., rest...);
+						});
+				});
+		}
+	}
+
+	/**
+	 * @brief     Build a random circuit and pass its gates to a visitor.
+	 *
+	 * @tparam QBitCount   Number of qubits of the circuit (at least 3).
+	 * @tparam LayerCount  Number of random layers.
+	 * @param engine       Random generator the angles and qubits are drawn from.
+	 * @param visit        Called with the gates of the circuit, in order; its result is returned.
+	 *
+	 * Every layer is two U3 rotations, a CX, a CPhase, a SWAP, a Toffoli and a HadamardCX on
+	 * random qubits, so the circuit mixes dense, diagonal and permutation gates of all widths
+	 * up to 3.
+	 */
+	template<dimension_t QBitCount, dimension_t LayerCount, typename Visitor>
+	decltype(auto) withRandomCircuit(random_engine_t& engine, Visitor&& visit)
+	{
+		static_assert(QBitCount >= 3, "the random layers contain a Toffoli gate");
+
+		const auto layer = [](random_engine_t& engine, auto&& visitLayer) -> decltype(auto)
+			{
+				const auto Q = shuffledQBits<QBitCount>(engine);
+				const float_t Theta = randomAngle(engine), Phi = randomAngle(engine), Lambda = randomAngle(engine);
+				const float_t Theta2 = randomAngle(engine), Phi2 = randomAngle(engine), Lambda2 = randomAngle(engine);
+				const float_t PhaseAngle = randomAngle(engine);
+				const auto ToffoliQ = shuffledQBits<QBitCount>(engine);
+
+				const auto U3a = ParametricGate<Gates::U3>(Theta, Phi, Lambda).toBits(Q[0]);
+				const auto U3b = ParametricGate<Gates::U3>(Theta2, Phi2, Lambda2).toBits(Q[1]);
+				const auto CX = QuantumGate<2, Gates::CX>().toBits(Q[0], Q[2]);
+				const auto CPhase = ParametricGate<Gates::CPhase>(PhaseAngle).toBits(Q[1], Q[2]);
+				const auto SWAP = QuantumGate<2, Gates::SWAP>().toBits(Q[2], Q[0]);
+				const auto Toffoli = QuantumGate<3, Gates::TOFFOLI>().toBits(ToffoliQ[0], ToffoliQ[1], ToffoliQ[2]);
+				const auto Entangler = QuantumGate<2, HadamardCX>().toBits(ToffoliQ[2], ToffoliQ[0]);
+
+				return visitLayer(U3a, U3b, CX, CPhase, SWAP, Toffoli, Entangler);
+			};
+		return withRandomLayers<LayerCount>(engine, layer, visit);
+	}
+}
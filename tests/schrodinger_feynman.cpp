@@ -0,0 +1,70 @@
+#include <utility>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkSchrodingerFeynman()
+	{
+		// Cut random 10-qubit registers into two 5-qubit halves, evaluate every amplitude as a
+		// sum over Schmidt paths of half-size states, and check them against the naive reference,
+		// with the default memory budget and with none.
+
+		std::cout << "Schrodinger-Feynman evaluation across a 5 | 5 cut (10 qubits)\n";
+
+		std::array<KetCat::dimension_t, 1024> BasisIndices{};
+		for (KetCat::dimension_t i = 0; i < BasisIndices.size(); ++i)
+			BasisIndices[i] = i;
+
+		bool Passed = true;
+		KetCat::StateVector<1024> State{};
+		for (const std::uint64_t Seed : { 1, 5, 7, 10 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<10, 2>(Engine, [&](const auto&... gates)
+				{
+					const auto Split = QuantumCircuit<10>().withGatesSchrodingerFeynman<5>(gates...);
+					State.m_StateVector = Split.getAmplitudes(BasisIndices);
+
+					const auto Reference = Checks::referenceState<1024>(0, gates...);
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed) + ", "
+						+ std::to_string(Split.getPathCount()) + " paths", State, Reference);
+
+					// A budget below one pair of half states still runs, on a single worker
+					State.m_StateVector = Split.getAmplitudes(BasisIndices, 0, Split.getPathCount(), 0);
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed) + ", no memory budget", State, Reference);
+				});
+		}
+
+
+		// A 5-qubit IQFT across a 4 | 4 cut followed by 10 Hadamards: every cut gate holds records
+		// as wide as the IQFT, which must stay off the stack.
+		std::cout << "\nSchrodinger-Feynman evaluation of a 5-qubit IQFT and 10 Hadamards across a 4 | 4 cut (8 qubits)\n";
+
+		constexpr auto IQFT5 = Gates::make_IQFT_matrix<5>();
+		const auto IQFT = QuantumGate<5, IQFT5>().toBits(0, 1, 2, 3, 4);
+		const auto H7 = QuantumGate<1, Gates::H>().toBits(7);
+
+		std::array<KetCat::dimension_t, 256> WideIndices{};
+		for (KetCat::dimension_t i = 0; i < WideIndices.size(); ++i)
+			WideIndices[i] = i;
+
+		Passed &= [&]<std::size_t... Index>(std::index_sequence<Index...>)
+		{
+			const auto Split = QuantumCircuit<8>().withGatesSchrodingerFeynman<4>(IQFT, ((void)Index, H7)...);
+
+			KetCat::StateVector<256> WideState{};
+			WideState.m_StateVector = Split.getAmplitudes(WideIndices);
+			return Checks::checkAgainstReference(std::to_string(Split.getPathCount()) + " paths", WideState,
+				Checks::referenceState<256>(0, IQFT, ((void)Index, H7)...));
+		}(std::make_index_sequence<10>{});
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkSchrodingerFeynman);
+}
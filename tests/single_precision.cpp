@@ -0,0 +1,113 @@
+#include "systems/quantum_circuit.h"
+#include "systems/particle_in_a_box.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// A non-Clifford rotation, so that the states carry more than the amplitudes ±1/√2^k
+	constexpr auto RotationY07 = Gates::RotationY(0.7);
+
+	// Largest amplitude difference between a single- and a double-precision state, relative to the largest amplitude
+	template<KetCat::dimension_t Dim>
+	KetCat::float_t relativeDeviation(const KetCat::StateVector<Dim, float>& single, const KetCat::StateVector<Dim>& reference)
+	{
+		KetCat::float_t Largest = 0.0, Scale = 0.0;
+		for (KetCat::dimension_t i = 0; i < Dim; ++i)
+		{
+			const KetCat::cplx_t Widened(single[i].re, single[i].im);
+			Largest = std::max(Largest, std::sqrt((Widened - reference[i]).normSquared()));
+			Scale = std::max(Scale, std::sqrt(reference[i].normSquared()));
+		}
+		return Largest / Scale;
+	}
+
+	bool checkPrecision(std::string_view label, KetCat::float_t deviation, KetCat::float_t tolerance)
+	{
+		const bool Passed = deviation <= tolerance;
+		std::cout << label << ": largest relative deviation from double precision " << std::scientific
+			<< std::setprecision(2) << deviation << (Passed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		return Passed;
+	}
+
+	// Apply the same gates in single and double precision; the visitor builds them for the given precision
+	template<KetCat::dimension_t Dim, typename GateBuilder>
+	KetCat::float_t runInBothPrecisions(const GateBuilder& build, KetCat::StateVector<Dim>& doubleState)
+	{
+		KetCat::StateVector<Dim, float> SingleState{};
+		SingleState[0] = KetCat::complex_t<float>(1.0f, 0.0f);
+		doubleState = {};
+		doubleState[0] = KetCat::cplx_t(1.0, 0.0);
+
+		build(std::type_identity<float>{}, [&](const auto&... gates) { ((SingleState = gates(SingleState)), ...); });
+		build(std::type_identity<double>{}, [&](const auto&... gates) { ((doubleState = gates(doubleState)), ...); });
+		return relativeDeviation(SingleState, doubleState);
+	}
+
+	bool checkSinglePrecision()
+	{
+		// Run the same gates on StateVector<N, float> and on the double default, then evolve a
+		// wave packet with the single-precision Hamiltonian and Crank-Nicolson solver, and check
+		// that both stay within single-precision rounding of the double results.
+
+		std::cout << "Single-precision gates (QuantumGate::toBits<float>)\n";
+
+		// A few ulps of float per gate; the Crank-Nicolson run accumulates rounding over its steps
+		constexpr KetCat::float_t GateTolerance = 1E-6;
+		constexpr KetCat::float_t EvolutionTolerance = 1E-4;
+
+		bool Passed = true;
+
+		KetCat::StateVector<4> Bell{};
+		Passed &= checkPrecision("Bell pair", runInBothPrecisions<4>([](auto precision, auto&& visit)
+			{
+				using Real = typename decltype(precision)::type;
+				visit(QuantumGate<1, Gates::H>().toBits<Real>(0),
+					QuantumGate<2, Gates::CX>().toBits<Real>(0, 1));
+			}, Bell), GateTolerance);
+
+		KetCat::StateVector<32> Circuit{};
+		Passed &= checkPrecision("5-qubit circuit", runInBothPrecisions<32>([](auto precision, auto&& visit)
+			{
+				using Real = typename decltype(precision)::type;
+				visit(QuantumGate<1, Gates::H>().toBits<Real>(0),
+					QuantumGate<1, RotationY07>().toBits<Real>(3),
+					QuantumGate<2, Checks::HadamardCX>().toBits<Real>(0, 4),
+					QuantumGate<3, Gates::TOFFOLI>().toBits<Real>(3, 4, 1),
+					QuantumGate<1, RotationY07>().toBits<Real>(2),
+					QuantumGate<2, Gates::SWAP>().toBits<Real>(2, 0),
+					QuantumGate<2, Checks::HadamardCX>().toBits<Real>(1, 2),
+					QuantumGate<1, Gates::Y>().toBits<Real>(4),
+					QuantumGate<2, Gates::CX>().toBits<Real>(4, 3));
+			}, Circuit), GateTolerance);
+
+		std::cout << "\nSingle-precision Crank-Nicolson evolution (94 grid points, 400 steps)\n";
+
+		constexpr KetCat::OneDimensionalParticleBoxConfig<96> Config(1.0, 1E-5);
+		constexpr KetCat::dimension_t M = 94;
+		constexpr KetCat::PotentialBarrier Barrier{ 0.45, 0.55, 3000 };
+		constexpr KetCat::float_t Mass = 1.0;
+
+		const auto Packet = KetCat::GaussianWavePacKetCat<M>()(0.2, ConstexprMath::Pi * 10, 0.1, Config.dx);
+		KetCat::StateVector<M, float> SinglePacket{};
+		for (KetCat::dimension_t i = 0; i < M; ++i)
+			SinglePacket[i] = KetCat::complex_t<float>(static_cast<float>(Packet[i].re), static_cast<float>(Packet[i].im));
+
+		const KetCat::CrankNicolsonSolver<M, float> SingleSolver(KetCat::Hamiltonian<M, float>(Mass, Config.dx, Barrier), Config.dt);
+		const KetCat::CrankNicolsonSolver<M> DoubleSolver(KetCat::Hamiltonian<M>(Mass, Config.dx, Barrier), Config.dt);
+
+		KetCat::StateVector<M> DoublePacket = Packet;
+		for (int Step = 0; Step < 400; ++Step)
+		{
+			SinglePacket = SingleSolver(SinglePacket);
+			DoublePacket = DoubleSolver(DoublePacket);
+		}
+		Passed &= checkPrecision("Wave packet", relativeDeviation(SinglePacket, DoublePacket), EvolutionTolerance);
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkSinglePrecision);
+}
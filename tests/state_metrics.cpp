@@ -0,0 +1,104 @@
+#include <complex>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	// ⟨a|b⟩ as a plain running sum in long double, for the reference
+	template<KetCat::dimension_t StateCount>
+	std::complex<long double> naiveInnerProduct(const KetCat::StateVector<StateCount>& a, const KetCat::StateVector<StateCount>& b)
+	{
+		std::complex<long double> Sum = 0.0L;
+		for (KetCat::dimension_t i = 0; i < StateCount; ++i)
+			Sum += std::conj(std::complex<long double>(a[i].re, a[i].im)) * std::complex<long double>(b[i].re, b[i].im);
+		return Sum;
+	}
+
+	template<KetCat::dimension_t StateCount>
+	bool checkMetrics(const std::string& label, const KetCat::StateVector<StateCount>& a, const KetCat::StateVector<StateCount>& b)
+	{
+		const std::complex<long double> Overlap = naiveInnerProduct(a, b);
+		const long double NormA = std::sqrt(naiveInnerProduct(a, a).real());
+		const long double NormB = std::sqrt(naiveInnerProduct(b, b).real());
+		const long double Fidelity = std::norm(Overlap) / (NormA * NormA * NormB * NormB);
+		const long double TraceDistance = std::sqrt(std::max(1.0L - Fidelity, 0.0L));
+
+		// Relative to the norms, so that unnormalised states are held to the same tolerance
+		const KetCat::cplx_t Inner = innerProduct(a, b);
+		const long double Deviation = std::max({
+			std::abs(std::complex<long double>(Inner.re, Inner.im) - Overlap) / (NormA * NormB),
+			std::abs(norm(a) - NormA) / NormA,
+			std::abs(norm(b) - NormB) / NormB,
+			std::abs(fidelity(a, b) - Fidelity),
+			std::abs(traceDistance(a, b) - TraceDistance) });
+
+		const bool Passed = Deviation <= Checks::ReferenceTolerance;
+		std::cout << label << ": F = " << std::fixed << std::setprecision(6) << fidelity(a, b)
+			<< ", D = " << traceDistance(a, b) << ", largest relative deviation from the naive loops " << std::scientific
+			<< std::setprecision(2) << static_cast<double>(Deviation) << (Passed ? " (ok)\n" : " (FAILED)\n") << std::defaultfloat;
+		return Passed;
+	}
+
+	bool checkStateMetrics()
+	{
+		// Compare innerProduct, norm, fidelity and traceDistance with naive long double loops on
+		// pairs of random 5-qubit states, then on random 20-qubit states large enough for the sums
+		// to be split over threads.
+
+		std::cout << "State metrics against naive loops (5 qubits)\n";
+
+		// Constant evaluation takes the serial path
+		constexpr auto Bell = QuantumCircuit<2>().withGates(
+			QuantumGate<1, Gates::H>().toBits(0),
+			QuantumGate<2, Gates::CX>().toBits(0, 1)).getStateVector();
+		static_assert(ConstexprMath::abs(norm(Bell) - 1.0) < 1E-12);
+		static_assert(ConstexprMath::abs(traceDistance(Bell, Bell)) < 1E-6);
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			// A random state, the same circuit followed by a small rotation, and an unrelated state
+			KetCat::StateVector<32> First{}, Near{}, Other{};
+			Checks::withRandomCircuit<5, 1>(Engine, [&](const auto&... gates)
+				{
+					First = QuantumCircuit<5>().withGates(gates...).getStateVector();
+					Near = QuantumCircuit<5>().withGates(gates..., ParametricGate<Gates::RY>(0.1).toBits(2)).getStateVector();
+				});
+			Checks::withRandomCircuit<5, 1>(Engine, [&](const auto&... gates)
+				{
+					Other = QuantumCircuit<5>().withGates(gates...).getStateVector();
+				});
+
+			const std::string Label = "Seed " + std::to_string(Seed);
+			Passed &= checkMetrics(Label + ", same state", First, First);
+			Passed &= checkMetrics(Label + ", nearby state", First, Near);
+			Passed &= checkMetrics(Label + ", random pair", First, Other);
+		}
+
+		std::cout << "\nState metrics against naive loops (20 qubits, unnormalised random amplitudes)\n";
+
+		// 16 MiB per state: kept on the heap
+		constexpr KetCat::dimension_t LargeCount = KetCat::dimension_t(1) << 20;
+		std::vector<KetCat::StateVector<LargeCount>> Large(2);
+		for (const std::uint64_t Seed : { 1, 2 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			std::normal_distribution<KetCat::float_t> Gaussian{};
+			for (KetCat::dimension_t i = 0; i < LargeCount; ++i)
+			{
+				Large[0][i] = KetCat::cplx_t(Gaussian(Engine), Gaussian(Engine));
+				Large[1][i] = Large[0][i] * 0.8 + KetCat::cplx_t(Gaussian(Engine), Gaussian(Engine)) * 0.6;
+			}
+			Passed &= checkMetrics("Seed " + std::to_string(Seed), Large[0], Large[1]);
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkStateMetrics);
+}
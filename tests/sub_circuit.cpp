@@ -0,0 +1,39 @@
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkSubCircuit()
+	{
+		// Record a random block on qubits 0..3 once as a sub-circuit, fused into one gate, and
+		// reuse it four times (once plain, then repeated three times by squaring) in a 6-qubit
+		// circuit. The result is checked against the naive reference running the block's gates
+		// four times over.
+
+		std::cout << "A fused sub-circuit reused four times (6 qubits)\n";
+
+		const auto H5 = QuantumGate<1, Gates::H>().toBits(5);
+		const auto CX35 = QuantumGate<2, Gates::CX>().toBits(3, 5);
+
+		bool Passed = true;
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<4, 1>(Engine, [&](const auto&... gates)
+				{
+					const auto Block = makeSubCircuit(gates...);
+					const auto State = QuantumCircuit<6>().withGates(H5, Block, CX35, Block.template repeat<3>()).getStateVector();
+
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed) + (Block.IsFused ? ", fused" : ", not fused"),
+						State, Checks::referenceState<64>(0, H5, gates..., CX35, gates..., gates..., gates...));
+				});
+		}
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkSubCircuit);
+}
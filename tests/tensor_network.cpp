@@ -0,0 +1,67 @@
+#include <utility>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkTensorNetwork()
+	{
+		// Contract the tensor network of every amplitude of random 6-qubit circuits with at most
+		// 4 legs per intermediate tensor (slicing edges where needed), and check the amplitudes
+		// against the naive reference.
+
+		std::cout << "Tensor-network amplitudes with intermediates of at most 4 legs (6 qubits)\n";
+
+		std::array<KetCat::dimension_t, 64> BasisIndices{};
+		for (KetCat::dimension_t i = 0; i < BasisIndices.size(); ++i)
+			BasisIndices[i] = i;
+
+		bool Passed = true;
+		KetCat::StateVector<64> State{};
+		for (const std::uint64_t Seed : { 1, 2, 3 })
+		{
+			Checks::random_engine_t Engine(Seed);
+			Checks::withRandomCircuit<6, 2>(Engine, [&](const auto&... gates)
+				{
+					const auto Network = QuantumCircuit<6>().withGatesTensorNetwork(gates...);
+
+					const ContractionPlan Plan = Network.getContractionPlan(4);
+					std::cout << "Seed " << Seed << ": " << Plan.Steps.size() << " contractions, " << Plan.SlicedEdges.size()
+						<< " sliced edges, largest intermediate " << Plan.MaxRank << " legs\n";
+
+					State.m_StateVector = Network.getAmplitudes(BasisIndices, 4);
+					Passed &= Checks::checkAgainstReference("Seed " + std::to_string(Seed), State, Checks::referenceState<64>(0, gates...));
+				});
+		}
+
+
+		// The circuit of wide_gate_circuit.cpp, a 5-qubit IQFT and 400 Hadamards: its record holds
+		// 401 gates at the width of the IQFT (megabytes), which must stay off the stack.
+		std::cout << "\nTensor-network amplitudes of a 5-qubit IQFT and 400 Hadamards (8 qubits)\n";
+
+		constexpr auto IQFT5 = Gates::make_IQFT_matrix<5>();
+		const auto IQFT = QuantumGate<5, IQFT5>().toBits(0, 1, 2, 3, 4);
+		const auto H7 = QuantumGate<1, Gates::H>().toBits(7);
+
+		std::array<KetCat::dimension_t, 256> WideIndices{};
+		for (KetCat::dimension_t i = 0; i < WideIndices.size(); ++i)
+			WideIndices[i] = i;
+
+		Passed &= [&]<std::size_t... Index>(std::index_sequence<Index...>)
+		{
+			const auto Network = QuantumCircuit<8>().withGatesTensorNetwork(IQFT, ((void)Index, H7)...);
+
+			KetCat::StateVector<256> WideState{};
+			WideState.m_StateVector = Network.getAmplitudes(WideIndices);
+			return Checks::checkAgainstReference("400 Hadamards", WideState, Checks::referenceState<256>(0, IQFT, ((void)Index, H7)...));
+		}(std::make_index_sequence<400>{});
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkTensorNetwork);
+}
@@ -0,0 +1,59 @@
+#include <utility>
+
+#include "systems/quantum_circuit.h"
+
+#include "reference_check.h"
+
+using namespace KetCat::QCC;
+
+namespace
+{
+	bool checkWideGateCircuit()
+	{
+		// A 5-qubit IQFT followed by 400 Hadamards: when withGates runs it layered, it records every
+		// gate at the width of the widest one (16 KiB each here), so this pack needs megabytes of
+		// records, which must stay off the stack. A permutation circuit then checks that the
+		// basis-state backend, which runs the gates without recording them, is chosen as
+		// inspectBackend reports. Both results are checked against the naive reference.
+
+		std::cout << "One 5-qubit IQFT and 400 Hadamards (8 qubits)\n";
+
+		constexpr auto IQFT5 = Gates::make_IQFT_matrix<5>();
+
+		const auto IQFT = QuantumGate<5, IQFT5>().toBits(0, 1, 2, 3, 4);
+		const auto H7 = QuantumGate<1, Gates::H>().toBits(7);
+
+		// The Hadamards cancel pairwise: every outcome of qubits 0..2 has probability 1/8
+		bool Passed = [&]<std::size_t... Index>(std::index_sequence<Index...>)
+		{
+			const auto Run = QuantumCircuit<8>().withGates(IQFT, ((void)Index, H7)...);
+
+			std::cout << "Backend: " << backendName(Run.getBackendDecision().Backend) << "\n";
+
+			return Checks::checkAgainstReference("withGates", Run.getStateVector(),
+				Checks::referenceState<256>(0, IQFT, ((void)Index, H7)...));
+		}(std::make_index_sequence<400>{});
+
+		std::cout << "\nX, CX, Toffoli and SWAP gates (8 qubits)\n";
+
+		const auto X0 = QuantumGate<1, Gates::X>().toBits(0);
+		const auto X5 = QuantumGate<1, Gates::X>().toBits(5);
+		const auto CX = QuantumGate<2, Gates::CX>().toBits(0, 6);
+		const auto Toffoli = QuantumGate<3, Gates::TOFFOLI>().toBits(5, 6, 2);
+		const auto SWAP = QuantumGate<2, Gates::SWAP>().toBits(2, 7);
+
+		const auto Permutation = QuantumCircuit<8>().withGates(X0, X5, CX, Toffoli, SWAP);
+		const SimulationBackend Inspected = QuantumCircuit<8>().inspectBackend(X0, X5, CX, Toffoli, SWAP).Backend;
+
+		const bool Tracked = Permutation.getBackendDecision().Backend == SimulationBackend::BasisStateTracking && Inspected == SimulationBackend::BasisStateTracking;
+		std::cout << "Backend: " << backendName(Permutation.getBackendDecision().Backend) << ", inspected: " << backendName(Inspected)
+			<< (Tracked ? " (ok)\n" : " (FAILED)\n");
+		Passed &= Tracked;
+		Passed &= Checks::checkAgainstReference("withGates", Permutation.getStateVector(),
+			Checks::referenceState<256>(0, X0, X5, CX, Toffoli, SWAP));
+
+		return Passed;
+	}
+
+	const bool Registered = Checks::registerCheck(checkWideGateCircuit);
+}